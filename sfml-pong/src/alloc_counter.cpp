@@ -0,0 +1,63 @@
+#include "alloc_counter.h"
+
+#if CUBE_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+static thread_local uint64_t allocationCount = 0;
+
+uint64_t threadAllocationCount(){ return allocationCount; }
+
+static void* countedAlloc(std::size_t size){
+    ++allocationCount;
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// MSVC's CRT and MinGW's msvcrt have no std::aligned_alloc; their aligned
+// blocks come from _aligned_malloc and must go back through _aligned_free
+static void* countedAlignedAlloc(std::size_t size, std::align_val_t align){
+    ++allocationCount;
+    std::size_t a = static_cast<std::size_t>(align);
+#ifdef _WIN32
+    if (void *p = _aligned_malloc(size ? size : 1, a)) return p;
+#else
+    std::size_t rounded = (size + a - 1) / a * a; // aligned_alloc wants a multiple of the alignment
+    if (void *p = std::aligned_alloc(a, rounded ? rounded : a)) return p;
+#endif
+    throw std::bad_alloc();
+}
+
+static void alignedFree(void *p){
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t size){ return countedAlloc(size); }
+void* operator new[](std::size_t size){ return countedAlloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new(std::size_t size, std::align_val_t align){ return countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align){ return countedAlignedAlloc(size, align); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+#else
+uint64_t threadAllocationCount(){ return 0; }
+#endif
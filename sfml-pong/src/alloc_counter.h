@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+
+// Debug builds replace the global operator new to count heap allocations per
+// thread, so the render loop can check that a steady-state frame allocates
+// nothing. Release builds (NDEBUG) leave the allocator alone and report 0.
+#ifndef NDEBUG
+#define CUBE_COUNT_ALLOCATIONS 1
+#else
+#define CUBE_COUNT_ALLOCATIONS 0
+#endif
+
+// Allocations made by the calling thread since it started.
+uint64_t threadAllocationCount();
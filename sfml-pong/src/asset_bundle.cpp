@@ -0,0 +1,145 @@
+#include "asset_bundle.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const size_t BUNDLE_HEADER = 16;
+static const size_t BUNDLE_ALIGN = 64;
+
+bool MappedFile::open(const std::string &path){
+    close();
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE){ file = nullptr; return false; }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0){ close(); return false; }
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping){ close(); return false; }
+    ptr = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!ptr){ close(); return false; }
+    len = static_cast<size_t>(size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0){ ::close(fd); return false; }
+    void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file
+    if (p == MAP_FAILED) return false;
+    ptr = static_cast<const uint8_t*>(p);
+    len = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close(){
+#ifdef _WIN32
+    if (ptr) UnmapViewOfFile(ptr);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+    mapping = file = nullptr;
+#else
+    if (ptr) munmap(const_cast<uint8_t*>(ptr), len);
+#endif
+    ptr = nullptr;
+    len = 0;
+}
+
+bool AssetBundle::open(const std::string &path){
+    entries = nullptr;
+    count = 0;
+    if (!file.open(path)) return false;
+    const uint8_t *d = file.data();
+    const size_t size = file.size();
+    uint32_t version = 0, n = 0;
+    if (size < BUNDLE_HEADER || std::memcmp(d, "CBAB", 4) != 0){
+        std::cerr << path << " is not an asset bundle\n";
+        file.close();
+        return false;
+    }
+    std::memcpy(&version, d + 4, 4);
+    std::memcpy(&n, d + 8, 4);
+    if (version != BUNDLE_VERSION || n > (size - BUNDLE_HEADER) / sizeof(BundleEntry)){
+        std::cerr << path << ": unsupported bundle version " << version << " (rebuild it with asset_pack)\n";
+        file.close();
+        return false;
+    }
+    const BundleEntry *e = reinterpret_cast<const BundleEntry*>(d + BUNDLE_HEADER);
+    for (uint32_t i = 0; i < n; ++i){
+        const bool inside = e[i].offset <= size && e[i].size <= size - e[i].offset;
+        const bool pixels = e[i].kind != BUNDLE_RGBA8 || e[i].size == static_cast<uint64_t>(e[i].width) * e[i].height * 4;
+        if (!inside || !pixels || e[i].name[sizeof(e[i].name) - 1] != '\0'){
+            std::cerr << path << ": entry " << i << " is damaged\n";
+            file.close();
+            return false;
+        }
+    }
+    entries = e;
+    count = n;
+    return true;
+}
+
+const BundleEntry *AssetBundle::find(const char *name) const{
+    for (uint32_t i = 0; i < count; ++i)
+        if (std::strcmp(entries[i].name, name) == 0) return &entries[i];
+    return nullptr;
+}
+
+void AssetBundleWriter::addTexture(const BundleEntry &info, const uint8_t *rgba){
+    BundleEntry e = info;
+    e.kind = BUNDLE_RGBA8;
+    e.size = static_cast<uint64_t>(e.width) * e.height * 4;
+    entries.push_back(e);
+    blobs.emplace_back(rgba, rgba + e.size);
+}
+
+void AssetBundleWriter::addBlob(const char *name, const void *bytes, size_t size){
+    BundleEntry e;
+    std::strncpy(e.name, name, sizeof(e.name) - 1);
+    e.kind = BUNDLE_BLOB;
+    e.size = size;
+    entries.push_back(e);
+    const uint8_t *b = static_cast<const uint8_t*>(bytes);
+    blobs.emplace_back(b, b + size);
+}
+
+bool AssetBundleWriter::write(const std::string &path) const{
+    std::vector<BundleEntry> table = entries;
+    uint64_t offset = BUNDLE_HEADER + table.size() * sizeof(BundleEntry);
+    for (BundleEntry &e : table){
+        offset = (offset + BUNDLE_ALIGN - 1) / BUNDLE_ALIGN * BUNDLE_ALIGN;
+        e.offset = offset;
+        offset += e.size;
+    }
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        const uint32_t header[3] = { BUNDLE_VERSION, static_cast<uint32_t>(table.size()), 0 };
+        f.write("CBAB", 4);
+        f.write(reinterpret_cast<const char*>(header), sizeof(header));
+        f.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(BundleEntry)));
+        uint64_t at = BUNDLE_HEADER + table.size() * sizeof(BundleEntry);
+        const char zeros[BUNDLE_ALIGN] = {};
+        for (size_t i = 0; i < table.size(); ++i){
+            f.write(zeros, static_cast<std::streamsize>(table[i].offset - at));
+            f.write(reinterpret_cast<const char*>(blobs[i].data()), static_cast<std::streamsize>(blobs[i].size()));
+            at = table[i].offset + blobs[i].size();
+        }
+        if (!f){ std::cerr << "Could not write " << tmp << "\n"; return false; }
+    }
+    std::remove(path.c_str()); // rename does not replace on Windows
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
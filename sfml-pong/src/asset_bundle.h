@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A read-only view of a whole file mapped into memory. Pages are read on
+// first touch, so opening costs the same however large the file is.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string &path);
+    void close();
+    const uint8_t *data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    const uint8_t *ptr = nullptr;
+    size_t len = 0;
+#ifdef _WIN32
+    void *file = nullptr, *mapping = nullptr;
+#endif
+};
+
+// Every asset cube starts with, in one file written by asset_pack: textures
+// already decoded to RGBA8 (top row first, as sf::Image holds them) with
+// their tile grid and detected block tiles, and other files (the HUD font)
+// as they are. Loading maps the file and hands pointers into it straight to
+// the GL upload and to sf::Font, so nothing is decoded or copied first.
+//
+// Layout (native byte order, which is little endian everywhere cube runs):
+//   header: "CBAB" u32 version, u32 entry count, u32 reserved
+//   entries: BundleEntry[count]
+//   data: each entry's bytes at its offset, 64-byte aligned
+const uint32_t BUNDLE_VERSION = 1;
+
+enum BundleKind : uint32_t { BUNDLE_RGBA8 = 1, BUNDLE_BLOB = 2 };
+
+struct BundleEntry {
+    char name[24] = {};         // NUL padded
+    uint32_t kind = BUNDLE_BLOB;
+    uint32_t width = 0, height = 0;
+    int32_t tileSize = 0, cols = 0, rows = 0;   // texture atlases only
+    int32_t tiles[6] = {};      // atlas: grass top, grass side, dirt (column, row)
+    uint64_t offset = 0, size = 0;
+};
+static_assert(sizeof(BundleEntry) == 88, "BundleEntry is stored as is");
+
+class AssetBundle {
+public:
+    // false if the file is missing or not a valid bundle of this version
+    bool open(const std::string &path);
+    bool isOpen() const { return file.data() != nullptr; }
+
+    const BundleEntry *find(const char *name) const;
+    const uint8_t *data(const BundleEntry &e) const { return file.data() + e.offset; }
+    size_t fileSize() const { return file.size(); }
+
+private:
+    MappedFile file;
+    const BundleEntry *entries = nullptr;
+    uint32_t count = 0;
+};
+
+// Collects entries and writes the bundle (through a temporary file, so a
+// running cube never maps a half-written one).
+class AssetBundleWriter {
+public:
+    void addTexture(const BundleEntry &info, const uint8_t *rgba);
+    void addBlob(const char *name, const void *bytes, size_t size);
+    bool write(const std::string &path) const;
+
+    size_t entryCount() const { return entries.size(); }
+
+private:
+    std::vector<BundleEntry> entries;
+    std::vector<std::vector<uint8_t>> blobs;
+};
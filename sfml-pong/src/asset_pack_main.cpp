@@ -0,0 +1,82 @@
+#include "asset_bundle.h"
+#include "texture_atlas.h"
+#include <SFML/Graphics.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// asset_pack: decodes cube's startup assets once, at build time, into the
+// single bundle cube maps at launch (see asset_bundle.h).
+//   --assets D    directory holding atlas.png (default assets)
+//   --font F      HUD font (default: D/arial.ttf, else the Windows Arial)
+//   --out B       bundle to write (default D/assets.bundle)
+// The atlas's tile grid and grass/dirt tiles are detected here rather than
+// on every launch. Without an atlas cube keeps loading the loose fallback
+// textures, so those are not packed.
+
+static bool readFile(const std::string &path, std::vector<char> &bytes){
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !bytes.empty();
+}
+
+static void addAtlas(AssetBundleWriter &w, const char *name, const sf::Image &img, const TextureAtlas &grid){
+    BundleEntry e;
+    std::strncpy(e.name, name, sizeof(e.name) - 1);
+    e.width = img.getSize().x;
+    e.height = img.getSize().y;
+    e.tileSize = grid.atlasTileSize;
+    e.cols = grid.atlasCols;
+    e.rows = grid.atlasRows;
+    const sf::Vector2i tiles[3] = { grid.TOP_TILE, grid.SIDE_TILE, grid.DIRT_TILE };
+    for (int i = 0; i < 3; ++i){ e.tiles[i * 2] = tiles[i].x; e.tiles[i * 2 + 1] = tiles[i].y; }
+    w.addTexture(e, img.getPixelsPtr());
+    std::printf("  %-6s %ux%u RGBA8, %d px tiles, top (%d,%d) side (%d,%d) dirt (%d,%d)\n", name, e.width, e.height,
+        e.tileSize, e.tiles[0], e.tiles[1], e.tiles[2], e.tiles[3], e.tiles[4], e.tiles[5]);
+}
+
+int main(int argc, char **argv){
+    std::string dir = "assets", font, out;
+    for (int i = 1; i < argc; ++i){
+        std::string a = argv[i];
+        if (i + 1 >= argc){ std::cerr << "Missing value for " << a << "\n"; return 2; }
+        const char *v = argv[++i];
+        if (a == "--assets") dir = v;
+        else if (a == "--font") font = v;
+        else if (a == "--out") out = v;
+        else { std::cerr << "Unknown argument: " << a << "\nUsage: asset_pack [--assets D] [--font F] [--out B]\n"; return 2; }
+    }
+    if (out.empty()) out = dir + "/assets.bundle";
+
+    AssetBundleWriter writer;
+    std::printf("Packing %s into %s\n", dir.c_str(), out.c_str());
+    sf::Image img;
+    if (img.loadFromFile(dir + "/atlas.png")){
+        TextureAtlas grid;
+        grid.setGrid(img.getSize());
+        grid.detectTiles(img);
+        addAtlas(writer, "atlas", img, grid);
+    }
+
+    std::vector<char> bytes;
+    const std::vector<std::string> fonts = font.empty()
+        ? std::vector<std::string>{ dir + "/arial.ttf", "C:/Windows/Fonts/arial.ttf" }
+        : std::vector<std::string>{ font };
+    for (const std::string &f : fonts){
+        if (!readFile(f, bytes)) continue;
+        writer.addBlob("font", bytes.data(), bytes.size());
+        std::printf("  %-6s %s, %zu bytes\n", "font", f.c_str(), bytes.size());
+        break;
+    }
+    if (!font.empty() && bytes.empty()){ std::cerr << "Could not read font " << font << "\n"; return 1; }
+
+    if (writer.entryCount() == 0){ std::cerr << "Nothing to pack in " << dir << "\n"; return 1; }
+    if (!writer.write(out)){ std::cerr << "Could not write " << out << "\n"; return 1; }
+    std::printf("Wrote %zu entries\n", writer.entryCount());
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "bench.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool loadCameraPath(const std::string &path, std::vector<CameraKey> &out){
+    std::ifstream f(path);
+    if (!f.good()) return false;
+    out.clear();
+    std::string line;
+    while (std::getline(f, line)){
+        auto hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream ss(line);
+        CameraKey k;
+        if (ss >> k.pos.x >> k.pos.y >> k.pos.z >> k.yawDeg >> k.pitchDeg) out.push_back(k);
+    }
+    return !out.empty();
+}
+
+std::vector<CameraKey> defaultCameraPath(){
+    // low pass over the terrain, a climb, then a turn looking back down
+    return {
+        { {-14.f,  8.f, -14.f},  45.f, -20.f },
+        { { -4.f,  6.f,  -4.f},  45.f, -15.f },
+        { {  6.f,  5.f,   6.f},  60.f, -10.f },
+        { { 14.f, 12.f,  10.f}, 150.f, -30.f },
+        { {  4.f, 20.f,  14.f}, 200.f, -55.f },
+        { {-12.f, 10.f,   8.f}, 250.f, -25.f },
+        { {-14.f,  8.f, -14.f}, 405.f, -20.f }
+    };
+}
+
+CameraKey sampleCameraPath(const std::vector<CameraKey> &path, float t){
+    if (path.size() == 1) return path[0];
+    t = std::clamp(t, 0.f, 1.f) * static_cast<float>(path.size() - 1);
+    size_t i = std::min(static_cast<size_t>(t), path.size() - 2);
+    float f = t - static_cast<float>(i);
+    const CameraKey &a = path[i], &b = path[i + 1];
+    CameraKey k;
+    k.pos = a.pos + (b.pos - a.pos) * f;
+    k.yawDeg = a.yawDeg + (b.yawDeg - a.yawDeg) * f;
+    k.pitchDeg = a.pitchDeg + (b.pitchDeg - a.pitchDeg) * f;
+    return k;
+}
+
+// nearest-rank percentile of an ascending-sorted sample
+static double percentile(const std::vector<double> &sorted, double p){
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size()) + 0.999999);
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+static std::string jsonEscape(const std::string &s){
+    std::string out;
+    for (char c : s){
+        if (c == '"' || c == '\\'){ out += '\\'; out += c; }
+        else if (static_cast<unsigned char>(c) >= 0x20) out += c;
+    }
+    return out;
+}
+
+// printf into a string sized by a first measuring pass, so long names are never cut short
+static std::string formatString(const char *fmt, ...){
+    va_list args, again;
+    va_start(args, fmt);
+    va_copy(again, args);
+    const int n = std::vsnprintf(nullptr, 0, fmt, args);
+    va_end(args);
+    std::string out(n > 0 ? static_cast<size_t>(n) : 0, '\0');
+    if (n > 0) std::vsnprintf(&out[0], out.size() + 1, fmt, again);
+    va_end(again);
+    return out;
+}
+
+std::string benchReportJson(const BenchOptions &opt, const std::vector<BenchFrame> &frames, size_t chunksTotal, unsigned workers,
+                            const std::string &renderer, bool multiDrawIndirect, const VertexPoolStats &pool){
+    std::vector<double> ms;
+    double total = 0.0;
+    size_t draws = 0, commands = 0, tris = 0, chunks = 0;
+    for (const auto &f : frames){
+        ms.push_back(f.millis);
+        total += f.millis;
+        draws = std::max(draws, f.drawCalls);
+        commands = std::max(commands, f.drawCommands);
+        tris = std::max(tris, f.triangles);
+        chunks = std::max(chunks, f.chunksDrawn);
+    }
+    std::sort(ms.begin(), ms.end());
+    const double n = frames.empty() ? 1.0 : static_cast<double>(frames.size());
+
+    return formatString(
+        "{\n"
+        "  \"frames\": %zu,\n"
+        "  \"seed\": %u,\n"
+        "  \"resolution\": [%u, %u],\n"
+        "  \"camera_path\": \"%s\",\n"
+        "  \"renderer\": \"%s\",\n"
+        "  \"mesh_workers\": %u,\n"
+        "  \"frame_ms\": { \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n"
+        "  \"draw_calls\": %zu,\n"
+        "  \"draw_commands\": %zu,\n"
+        "  \"multi_draw_indirect\": %s,\n"
+        "  \"triangles\": %zu,\n"
+        "  \"chunks\": { \"total\": %zu, \"drawn\": %zu },\n"
+        "  \"vertex_pool\": { \"capacity_quads\": %zu, \"allocated_quads\": %zu, \"live_quads\": %zu, \"utilisation\": %.3f,"
+        " \"free_ranges\": %zu, \"largest_free_quads\": %zu, \"fragmentation\": %.3f, \"grows\": %zu }\n"
+        "}\n",
+        frames.size(), opt.seed, opt.width, opt.height,
+        jsonEscape(opt.pathFile.empty() ? "builtin" : opt.pathFile).c_str(), jsonEscape(renderer).c_str(), workers,
+        total / n, percentile(ms, 50), percentile(ms, 90), percentile(ms, 95), percentile(ms, 99), ms.empty() ? 0.0 : ms.back(),
+        draws, commands, multiDrawIndirect ? "true" : "false", tris, chunksTotal, chunks,
+        pool.capacityQuads, pool.allocatedQuads, pool.liveQuads, pool.utilisation(),
+        pool.freeRanges, pool.largestFreeQuads, pool.fragmentation(), pool.grows);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <SFML/System.hpp>
+#include <string>
+#include <vector>
+#include "vertex_pool.h"
+
+// Options for `cube --bench`: render a fixed-seed world offscreen along a
+// scripted camera path and report frame statistics as JSON.
+struct BenchOptions {
+    bool enabled = false;
+    int frames = 600;
+    unsigned seed = 123;
+    unsigned width = 1280, height = 720;
+    std::string pathFile;   // empty = built-in flythrough
+    std::string outFile;    // empty = stdout only
+};
+
+// One waypoint: eye position plus look direction in degrees.
+struct CameraKey {
+    sf::Vector3f pos;
+    float yawDeg = 0.f;
+    float pitchDeg = 0.f;
+};
+
+// Per-frame counters sampled by the bench loop
+struct BenchFrame {
+    double millis = 0.0;
+    size_t drawCalls = 0;
+    size_t drawCommands = 0;    // sections (or section face groups) those calls drew
+    size_t triangles = 0;
+    size_t chunksDrawn = 0;
+};
+
+// Text format: one waypoint per line, "x y z yawDeg pitchDeg"; '#' starts a comment.
+bool loadCameraPath(const std::string &path, std::vector<CameraKey> &out);
+std::vector<CameraKey> defaultCameraPath();
+// Piecewise-linear sample at t in [0,1], waypoints evenly spaced.
+CameraKey sampleCameraPath(const std::vector<CameraKey> &path, float t);
+// draw_calls / draw_commands / triangles / chunks drawn are the per-frame peaks
+// over the run; the vertex pool is as it was at the end.
+std::string benchReportJson(const BenchOptions &opt, const std::vector<BenchFrame> &frames, size_t chunksTotal, unsigned workers,
+                            const std::string &renderer, bool multiDrawIndirect, const VertexPoolStats &pool);
@@ -0,0 +1,123 @@
+#include "bitmap_hud.h"
+#include <algorithm>
+#include <cstring>
+
+// 3x5 glyphs for ASCII 32..95, one row per byte, bit 2 = left column
+static const unsigned char GLYPHS[64][5] = {
+    {0,0,0,0,0},                                  // space
+    {0b010,0b010,0b010,0b000,0b010},              // !
+    {0},{0},{0},                                  // " # $
+    {0b101,0b001,0b010,0b100,0b101},              // %
+    {0},{0},{0},{0},{0},                          // & ' ( ) *
+    {0b000,0b010,0b111,0b010,0b000},              // +
+    {0b000,0b000,0b000,0b010,0b100},              // ,
+    {0b000,0b000,0b111,0b000,0b000},              // -
+    {0b000,0b000,0b000,0b000,0b010},              // .
+    {0b001,0b001,0b010,0b100,0b100},              // /
+    {0b111,0b101,0b101,0b101,0b111},              // 0
+    {0b010,0b110,0b010,0b010,0b111},              // 1
+    {0b111,0b001,0b111,0b100,0b111},              // 2
+    {0b111,0b001,0b111,0b001,0b111},              // 3
+    {0b101,0b101,0b111,0b001,0b001},              // 4
+    {0b111,0b100,0b111,0b001,0b111},              // 5
+    {0b111,0b100,0b111,0b101,0b111},              // 6
+    {0b111,0b001,0b010,0b010,0b010},              // 7
+    {0b111,0b101,0b111,0b101,0b111},              // 8
+    {0b111,0b101,0b111,0b001,0b111},              // 9
+    {0b000,0b010,0b000,0b010,0b000},              // :
+    {0},{0},                                      // ; <
+    {0b000,0b111,0b000,0b111,0b000},              // =
+    {0},{0},{0},                                  // > ? @
+    {0b010,0b101,0b111,0b101,0b101},              // A
+    {0b110,0b101,0b110,0b101,0b110},              // B
+    {0b011,0b100,0b100,0b100,0b011},              // C
+    {0b110,0b101,0b101,0b101,0b110},              // D
+    {0b111,0b100,0b110,0b100,0b111},              // E
+    {0b111,0b100,0b110,0b100,0b100},              // F
+    {0b011,0b100,0b101,0b101,0b011},              // G
+    {0b101,0b101,0b111,0b101,0b101},              // H
+    {0b111,0b010,0b010,0b010,0b111},              // I
+    {0b001,0b001,0b001,0b101,0b010},              // J
+    {0b101,0b101,0b110,0b101,0b101},              // K
+    {0b100,0b100,0b100,0b100,0b111},              // L
+    {0b101,0b111,0b111,0b101,0b101},              // M
+    {0b110,0b101,0b101,0b101,0b101},              // N
+    {0b010,0b101,0b101,0b101,0b010},              // O
+    {0b110,0b101,0b110,0b100,0b100},              // P
+    {0b010,0b101,0b101,0b110,0b011},              // Q
+    {0b110,0b101,0b110,0b101,0b101},              // R
+    {0b011,0b100,0b010,0b001,0b110},              // S
+    {0b111,0b010,0b010,0b010,0b010},              // T
+    {0b101,0b101,0b101,0b101,0b111},              // U
+    {0b101,0b101,0b101,0b101,0b010},              // V
+    {0b101,0b101,0b111,0b111,0b101},              // W
+    {0b101,0b101,0b010,0b101,0b101},              // X
+    {0b101,0b101,0b010,0b010,0b010},              // Y
+    {0b111,0b001,0b010,0b100,0b111},              // Z
+    {0},{0},{0},{0},                              // [ \ ] ^
+    {0b000,0b000,0b000,0b000,0b111}               // _
+};
+
+static const unsigned char* glyphFor(char c){
+    if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    if (c < 32 || c > 95) return GLYPHS[0];
+    return GLYPHS[c - 32];
+}
+
+static void addQuad(sf::VertexArray &va, sf::Vector2f p, sf::Vector2f size, sf::Color color){
+    const sf::Vector2f a = p, b{p.x + size.x, p.y}, c{p.x + size.x, p.y + size.y}, d{p.x, p.y + size.y};
+    va.append(sf::Vertex{a, color, {}});
+    va.append(sf::Vertex{b, color, {}});
+    va.append(sf::Vertex{c, color, {}});
+    va.append(sf::Vertex{a, color, {}});
+    va.append(sf::Vertex{c, color, {}});
+    va.append(sf::Vertex{d, color, {}});
+}
+
+void BitmapHud::setLine(int line, const char *text, sf::Vector2f pos, float scale){
+    if (line < 0 || line >= MAX_LINES) return;
+    Line &l = lines[line];
+    if (l.pos == pos && l.scale == scale && std::strncmp(l.text, text, MAX_CHARS) == 0) return;
+    std::strncpy(l.text, text, MAX_CHARS);
+    l.text[MAX_CHARS] = '\0';
+    l.pos = pos;
+    l.scale = scale;
+    dirty = true;
+}
+
+void BitmapHud::rebuild(){
+    // clear() keeps the capacity, so rebuilding reuses the same storage
+    vertices.clear();
+    sf::Vector2f lo{1e9f, 1e9f}, hi{-1e9f, -1e9f};
+    for (const Line &l : lines){
+        size_t n = std::strlen(l.text);
+        if (n == 0) continue;
+        const float advance = (GLYPH_W + 1) * l.scale;
+        lo.x = std::min(lo.x, l.pos.x);
+        lo.y = std::min(lo.y, l.pos.y);
+        hi.x = std::max(hi.x, l.pos.x + advance * static_cast<float>(n) - l.scale);
+        hi.y = std::max(hi.y, l.pos.y + GLYPH_H * l.scale);
+    }
+    if (hi.x < lo.x){ dirty = false; ++rebuildCount; return; }
+
+    const float pad = 3.f;
+    addQuad(vertices, {lo.x - pad, lo.y - pad}, {hi.x - lo.x + 2*pad, hi.y - lo.y + 2*pad}, sf::Color(0, 0, 0, 110));
+    for (const Line &l : lines){
+        float x = l.pos.x;
+        for (const char *c = l.text; *c; ++c){
+            const unsigned char *rows = glyphFor(*c);
+            for (int ry = 0; ry < GLYPH_H; ++ry)
+                for (int rx = 0; rx < GLYPH_W; ++rx)
+                    if (rows[ry] & (1u << (GLYPH_W - 1 - rx)))
+                        addQuad(vertices, {x + rx * l.scale, l.pos.y + ry * l.scale}, {l.scale, l.scale}, sf::Color::White);
+            x += (GLYPH_W + 1) * l.scale;
+        }
+    }
+    dirty = false;
+    ++rebuildCount;
+}
+
+void BitmapHud::draw(sf::RenderTarget &target){
+    if (dirty) rebuild();
+    if (vertices.getVertexCount() > 0) target.draw(vertices);
+}
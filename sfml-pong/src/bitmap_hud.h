@@ -0,0 +1,35 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+
+// HUD drawn with the built-in 3x5 pixel font when no TTF is available. Every
+// lit glyph pixel plus a backing panel goes into one vertex array that is
+// rebuilt only when a line's text or position changes, so the HUD is a single
+// draw call. Covers digits, A-Z (lower case is drawn as upper case), space
+// and : - . = / + %; anything else draws blank.
+class BitmapHud {
+public:
+    static const int MAX_LINES = 8;
+    static const int MAX_CHARS = 64;
+    static const int GLYPH_W = 3, GLYPH_H = 5;
+
+    // An empty string hides the line.
+    void setLine(int line, const char *text, sf::Vector2f pos, float scale);
+    void draw(sf::RenderTarget &target);
+
+    size_t quadCount() const { return vertices.getVertexCount() / 6; }
+    unsigned rebuilds() const { return rebuildCount; }
+
+private:
+    struct Line {
+        char text[MAX_CHARS + 1] = "";
+        sf::Vector2f pos;
+        float scale = 1.f;
+    };
+    void rebuild();
+
+    Line lines[MAX_LINES];
+    sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+    bool dirty = true;
+    unsigned rebuildCount = 0;
+};
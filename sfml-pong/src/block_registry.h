@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Every block type, known at compile time. Ids are what chunks, the mesher and
+// the network protocol store; 0 is air.
+using BlockId = uint16_t;
+enum : BlockId {
+    BLOCK_AIR = 0, BLOCK_DIRT = 1, BLOCK_GRASS = 2, BLOCK_STONE = 3,
+    BLOCK_LOG = 4, BLOCK_LEAVES = 5, BLOCK_COBBLE = 6,
+    BLOCK_WATER = 7, BLOCK_GLASS = 8,
+    BLOCK_TYPE_COUNT = 9
+};
+
+enum : uint8_t {
+    BLOCK_OPAQUE = 1, // hides the faces of neighbours behind it
+    BLOCK_SOLID = 2,  // collides with players
+    BLOCK_TRANSLUCENT = 4, // blended, drawn back to front after the opaque pass
+};
+
+// Column and row in the texture atlas
+struct AtlasTile { uint8_t col = 0, row = 0; };
+
+struct BlockType {
+    BlockId id;
+    const char *name;
+    AtlasTile top, side, bottom;
+    uint8_t flags;
+};
+
+constexpr BlockType BLOCK_TYPES[BLOCK_TYPE_COUNT] = {
+    { BLOCK_AIR,    "Air",         {0, 0},  {0, 0},  {0, 0},  0 },
+    { BLOCK_DIRT,   "Dirt",        {2, 0},  {2, 0},  {2, 0},  BLOCK_OPAQUE | BLOCK_SOLID },
+    { BLOCK_GRASS,  "Grass",       {11, 8}, {11, 8}, {11, 8}, BLOCK_OPAQUE | BLOCK_SOLID },
+    { BLOCK_STONE,  "Stone",       {1, 0},  {1, 0},  {1, 0},  BLOCK_OPAQUE | BLOCK_SOLID },
+    { BLOCK_LOG,    "Log",         {7, 13}, {6, 13}, {7, 13}, BLOCK_OPAQUE | BLOCK_SOLID },
+    { BLOCK_LEAVES, "Leaves",      {6, 2},  {6, 2},  {6, 2},  BLOCK_SOLID }, // see-through: neighbours keep their faces
+    { BLOCK_COBBLE, "Cobblestone", {2, 5},  {2, 5},  {2, 5},  BLOCK_OPAQUE | BLOCK_SOLID },
+    // translucent tiles carry their own alpha (about 0.68 and 0.48), which the blend pass uses as is
+    { BLOCK_WATER,  "Water",       {2, 14}, {2, 14}, {2, 14}, BLOCK_TRANSLUCENT },
+    { BLOCK_GLASS,  "Glass",       {11, 6}, {11, 6}, {11, 6}, BLOCK_TRANSLUCENT | BLOCK_SOLID },
+};
+
+constexpr bool blockTypesInIdOrder(){
+    for (int i = 0; i < BLOCK_TYPE_COUNT; ++i)
+        if (BLOCK_TYPES[i].id != i) return false;
+    return true;
+}
+static_assert(blockTypesInIdOrder(), "BLOCK_TYPES must be indexed by block id");
+
+// The flags alone, one byte per id, for the mesher's neighbour tests.
+constexpr std::array<uint8_t, BLOCK_TYPE_COUNT> makeBlockFlags(){
+    std::array<uint8_t, BLOCK_TYPE_COUNT> flags{};
+    for (int i = 0; i < BLOCK_TYPE_COUNT; ++i) flags[i] = BLOCK_TYPES[i].flags;
+    return flags;
+}
+constexpr std::array<uint8_t, BLOCK_TYPE_COUNT> BLOCK_FLAGS = makeBlockFlags();
+
+// Ids must come from chunk data or the enum above; neither is range-checked.
+constexpr const BlockType& blockType(BlockId id){ return BLOCK_TYPES[id]; }
+constexpr bool blockOpaque(BlockId id){ return (BLOCK_FLAGS[id] & BLOCK_OPAQUE) != 0; }
+constexpr bool blockSolid(BlockId id){ return (BLOCK_FLAGS[id] & BLOCK_SOLID) != 0; }
+constexpr bool blockTranslucent(BlockId id){ return (BLOCK_FLAGS[id] & BLOCK_TRANSLUCENT) != 0; }
+
+// Standard terrain column of height h: grass on top, three dirt, stone below.
+constexpr BlockId TERRAIN_LAYERS[5] = { BLOCK_GRASS, BLOCK_DIRT, BLOCK_DIRT, BLOCK_DIRT, BLOCK_STONE };
+constexpr BlockId terrainBlockAt(int y, int h){
+    const int depth = h - 1 - y;
+    return TERRAIN_LAYERS[depth < 4 ? depth : 4];
+}
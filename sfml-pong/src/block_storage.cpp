@@ -0,0 +1,204 @@
+#include "block_storage.h"
+#include <algorithm>
+
+// Narrowest supported width for `ids` distinct ids (0 for one id).
+static int widthFor(size_t ids){
+    if (ids <= 1) return 0;
+    int b = 1;
+    while ((size_t(1) << b) < ids) b *= 2;
+    return b;
+}
+
+static size_t wordsFor(size_t count, int bits){ return (count * bits + 63) / 64; }
+
+BlockStorage::BlockStorage(size_t count, BlockId fill) : count(count), uniformId(fill) {}
+
+void BlockStorage::fill(BlockId id){
+    bits = 0;
+    uniformId = id;
+    // swap with empties so a uniform array really holds no heap memory
+    std::vector<BlockId>().swap(palette);
+    std::vector<uint32_t>().swap(refs);
+    std::vector<uint32_t>().swap(freeSlots);
+    std::unordered_map<BlockId, uint32_t>().swap(slotOf);
+    std::vector<uint64_t>().swap(words);
+}
+
+void BlockStorage::putSlot(size_t i, uint32_t slot){
+    const size_t bit = i * bits;
+    uint64_t &w = words[bit >> 6];
+    w = (w & ~(mask() << (bit & 63))) | (static_cast<uint64_t>(slot) << (bit & 63));
+}
+
+uint32_t BlockStorage::slotFor(BlockId id){
+    if (palette.size() <= SMALL_PALETTE){
+        for (size_t s = 0; s < palette.size(); ++s)
+            if (palette[s] == id && refs[s] != 0) return static_cast<uint32_t>(s);
+    } else {
+        auto it = slotOf.find(id);
+        if (it != slotOf.end()) return it->second;
+    }
+    uint32_t slot;
+    if (!freeSlots.empty()){
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        palette[slot] = id;
+    } else {
+        slot = static_cast<uint32_t>(palette.size());
+        if (slot > mask()) repack(bits * 2, {});
+        palette.push_back(id);
+        refs.push_back(0);
+        if (palette.size() == SMALL_PALETTE + 1)
+            for (size_t s = 0; s < palette.size(); ++s) if (refs[s] != 0) slotOf[palette[s]] = static_cast<uint32_t>(s);
+    }
+    if (palette.size() > SMALL_PALETTE) slotOf[id] = slot;
+    return slot;
+}
+
+void BlockStorage::release(uint32_t slot){
+    freeSlots.push_back(slot);
+    if (palette.size() > SMALL_PALETTE) slotOf.erase(palette[slot]);
+    const size_t live = palette.size() - freeSlots.size();
+    if (live == 1 || (bits >= 4 && live <= (size_t(1) << (bits / 2)) / 2)) compact();
+}
+
+void BlockStorage::set(size_t i, BlockId id){
+    if (bits == 0){
+        if (id == uniformId) return;
+        palette = {uniformId};
+        refs = {static_cast<uint32_t>(count)};
+        bits = 1;
+        words.assign(wordsFor(count, bits), 0);
+    }
+    const uint32_t old = slotAt(i);
+    if (palette[old] == id) return;
+    const uint32_t slot = slotFor(id); // may widen; slot numbers survive that
+    putSlot(i, slot);
+    ++refs[slot];
+    if (--refs[old] == 0) release(old);
+}
+
+void BlockStorage::repack(int newBits, const std::vector<uint32_t> &remap){
+    std::vector<uint64_t> packed(wordsFor(count, newBits), 0);
+    for (size_t i = 0; i < count; ++i){
+        uint32_t s = slotAt(i);
+        if (!remap.empty()) s = remap[s];
+        const size_t bit = i * newBits;
+        packed[bit >> 6] |= static_cast<uint64_t>(s) << (bit & 63);
+    }
+    words.swap(packed);
+    bits = newBits;
+}
+
+void BlockStorage::compact(){
+    if (bits == 0) return;
+    std::vector<uint32_t> remap(palette.size(), 0);
+    std::vector<BlockId> ids;
+    std::vector<uint32_t> counts;
+    for (size_t s = 0; s < palette.size(); ++s){
+        if (refs[s] == 0) continue;
+        remap[s] = static_cast<uint32_t>(ids.size());
+        ids.push_back(palette[s]);
+        counts.push_back(refs[s]);
+    }
+    if (ids.size() == 1){ fill(ids[0]); return; }
+    repack(widthFor(ids.size()), remap);
+    palette.swap(ids);
+    refs.swap(counts);
+    freeSlots.clear();
+    slotOf.clear();
+    if (palette.size() > SMALL_PALETTE)
+        for (size_t s = 0; s < palette.size(); ++s) slotOf[palette[s]] = static_cast<uint32_t>(s);
+}
+
+void BlockStorage::assign(const BlockId *ids){
+    if (count == 0) return;
+    fill(ids[0]);
+    // Blocks come in long runs, so only look an id up when it changes; the
+    // lookup is linear until the palette outgrows SMALL_PALETTE.
+    BlockId lastId = ids[0];
+    uint32_t lastSlot = 0;
+    palette.push_back(ids[0]);
+    refs.push_back(0);
+    auto lookup = [&](BlockId id){
+        if (palette.size() > SMALL_PALETTE){
+            auto it = slotOf.find(id);
+            if (it != slotOf.end()) return it->second;
+        } else {
+            auto it = std::find(palette.begin(), palette.end(), id);
+            if (it != palette.end()) return static_cast<uint32_t>(it - palette.begin());
+        }
+        const uint32_t slot = static_cast<uint32_t>(palette.size());
+        palette.push_back(id);
+        refs.push_back(0);
+        if (palette.size() == SMALL_PALETTE + 1)
+            for (size_t p = 0; p < palette.size(); ++p) slotOf[palette[p]] = static_cast<uint32_t>(p);
+        else if (palette.size() > SMALL_PALETTE) slotOf[id] = slot;
+        return slot;
+    };
+    // palette and counts first, so the words are packed once at the final width
+    for (size_t i = 0; i < count; ++i){
+        if (ids[i] != lastId){ lastId = ids[i]; lastSlot = lookup(lastId); }
+        ++refs[lastSlot];
+    }
+    if (palette.size() == 1){ fill(ids[0]); return; }
+    bits = widthFor(palette.size());
+    words.assign(wordsFor(count, bits), 0);
+    lastId = ids[0];
+    lastSlot = 0;
+    for (size_t i = 0; i < count; ++i){
+        if (ids[i] != lastId){ lastId = ids[i]; lastSlot = lookup(lastId); }
+        const size_t bit = i * bits;
+        words[bit >> 6] |= static_cast<uint64_t>(lastSlot) << (bit & 63);
+    }
+}
+
+void BlockStorage::usePalette(const BlockId *ids, size_t n){
+    fill(ids[0]);
+    if (n == 1) return;
+    palette.assign(ids, ids + n);
+    refs.assign(n, 0);
+    refs[0] = static_cast<uint32_t>(count);
+    bits = widthFor(n);
+    words.assign(wordsFor(count, bits), 0);
+    if (n > SMALL_PALETTE)
+        for (size_t s = 0; s < n; ++s) slotOf[palette[s]] = static_cast<uint32_t>(s);
+}
+
+void BlockStorage::fillSlots(size_t begin, size_t len, uint32_t slot){
+    if (bits == 0) return;
+    const size_t end = begin + len;
+    const size_t perWord = 64 / bits;
+    size_t i = begin;
+    for (; i < end && i % perWord != 0; ++i) putSlot(i, slot);
+    // whole words at once: the slot repeated across all 64 bits
+    const uint64_t pattern = ~uint64_t(0) / mask() * slot;
+    for (; i + perWord <= end; i += perWord) words[i / perWord] = pattern;
+    for (; i < end; ++i) putSlot(i, slot);
+    refs[0] -= static_cast<uint32_t>(len); // usePalette() counted everything as slot 0
+    refs[slot] += static_cast<uint32_t>(len);
+}
+
+void BlockStorage::endFill(){
+    if (bits != 0 && std::find(refs.begin(), refs.end(), 0u) != refs.end()) compact();
+}
+
+void BlockStorage::copyTo(BlockId *out) const{
+    if (bits == 0){ std::fill_n(out, count, uniformId); return; }
+    for (size_t i = 0; i < count; ++i) out[i] = palette[slotAt(i)];
+}
+
+size_t BlockStorage::memoryBytes() const{
+    return words.capacity() * sizeof(uint64_t) + palette.capacity() * sizeof(BlockId)
+         + refs.capacity() * sizeof(uint32_t) + freeSlots.capacity() * sizeof(uint32_t)
+         // rough node + bucket cost of the large-palette index
+         + slotOf.size() * 32 + (slotOf.empty() ? 0 : slotOf.bucket_count() * sizeof(void*));
+}
+
+bool BlockStorage::operator==(const BlockStorage &o) const{
+    if (count != o.count) return false;
+    if (bits == 0 && o.bits == 0) return uniformId == o.uniformId;
+    for (size_t i = 0; i < count; ++i)
+        if (get(i) != o.get(i)) return false;
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "block_registry.h"
+
+// Fixed-size array of block ids stored as indices into a palette of the ids in
+// use, bit-packed at 1, 2, 4, 8 or 16 bits per block (a power of two, so no
+// index straddles a 64-bit word). A single-id array keeps the id inline and
+// allocates nothing. set() widens when a new id does not fit; when ids drop
+// out it reuses their palette slots, and narrows once the live ids fit in half
+// of a smaller width (the gap keeps one edit from toggling the width).
+class BlockStorage {
+public:
+    explicit BlockStorage(size_t count, BlockId fill = BLOCK_AIR);
+
+    size_t size() const { return count; }
+    BlockId get(size_t i) const {
+        if (bits == 0) return uniformId;
+        const size_t bit = i * bits;
+        return palette[(words[bit >> 6] >> (bit & 63)) & mask()];
+    }
+    void set(size_t i, BlockId id);
+    void fill(BlockId id);
+    // Replaces the contents with ids[0..size()), packed at the narrowest width.
+    void assign(const BlockId *ids);
+    void copyTo(BlockId *out) const;
+    // Bulk load straight from palette indices (the chunk decoder's runs):
+    // usePalette() takes distinct ids and sets every block to the first,
+    // fillSlots() then writes each other range once, endFill() drops unused ids.
+    void usePalette(const BlockId *ids, size_t n);
+    void fillSlots(size_t begin, size_t len, uint32_t slot);
+    void endFill();
+    // Drops unused palette slots and narrows to the smallest width that fits.
+    void compact();
+
+    bool uniform() const { return bits == 0; }
+    int bitsPerBlock() const { return bits; }
+    size_t paletteSize() const { return bits == 0 ? 1 : palette.size() - freeSlots.size(); }
+    // Heap bytes held (packed words, palette, reference counts)
+    size_t memoryBytes() const;
+
+    bool operator==(const BlockStorage &o) const;
+    bool operator!=(const BlockStorage &o) const { return !(*this == o); }
+
+private:
+    static const size_t SMALL_PALETTE = 16; // searched linearly below this
+    uint64_t mask() const { return (uint64_t(1) << bits) - 1; }
+    uint32_t slotAt(size_t i) const { return static_cast<uint32_t>((words[(i * bits) >> 6] >> ((i * bits) & 63)) & mask()); }
+    void putSlot(size_t i, uint32_t slot);
+    uint32_t slotFor(BlockId id);
+    void release(uint32_t slot);
+    void repack(int newBits, const std::vector<uint32_t> &remap);
+
+    size_t count;
+    int bits = 0;                   // 0: every block is uniformId
+    BlockId uniformId = BLOCK_AIR;
+    std::vector<BlockId> palette;   // slot -> id
+    std::vector<uint32_t> refs;     // blocks using each slot
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<BlockId, uint32_t> slotOf; // id -> slot, only for palettes over SMALL_PALETTE
+    std::vector<uint64_t> words;
+};
@@ -0,0 +1,104 @@
+#include "bot_client.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+BotSwarm::BotSwarm(int count, unsigned short port, unsigned seed) : count(count), port(port), rng(seed) {}
+
+BotSwarm::~BotSwarm(){ stop(); }
+
+void BotSwarm::start(){
+    running.store(true);
+    thread = std::thread([this]{ run(); });
+}
+
+void BotSwarm::stop(){
+    running.store(false);
+    if (thread.joinable()) thread.join();
+}
+
+void BotSwarm::connectAll(){
+    int ok = 0;
+    for (int i = 0; i < count; ++i){
+        auto b = std::make_unique<Bot>();
+        if (b->socket.connect(sf::IpAddress::LocalHost, port, sf::seconds(2.f)) == sf::Socket::Status::Done){
+            b->connected = true;
+            sf::Packet hello = makeHello("bot" + std::to_string(i));
+            if (b->socket.send(hello) != sf::Socket::Status::Done) b->connected = false;
+            b->socket.setBlocking(false);
+            ++ok;
+        }
+        bots.push_back(std::move(b));
+    }
+    std::cout << "Bots connected: " << ok << "/" << count << "\n";
+}
+
+bool BotSwarm::send(Bot &b, sf::Packet p){
+    if (b.pending){
+        sf::Socket::Status st = b.socket.send(*b.pending);
+        if (st == sf::Socket::Status::Partial || st == sf::Socket::Status::NotReady) return false;
+        b.pending.reset();
+        if (st != sf::Socket::Status::Done){ b.connected = false; return false; }
+    }
+    sf::Socket::Status st = b.socket.send(p);
+    if (st == sf::Socket::Status::Partial) b.pending = std::move(p);
+    else if (st == sf::Socket::Status::Disconnected || st == sf::Socket::Status::Error) b.connected = false;
+    return st == sf::Socket::Status::Done;
+}
+
+void BotSwarm::pump(Bot &b){
+    sf::Packet p;
+    for (;;){
+        sf::Socket::Status st = b.socket.receive(p);
+        if (st != sf::Socket::Status::Done){
+            if (st == sf::Socket::Status::Disconnected || st == sf::Socket::Status::Error) b.connected = false;
+            break;
+        }
+        received.fetch_add(wireSize(p), std::memory_order_relaxed);
+        uint8_t type = 0;
+        if ((p >> type) && static_cast<MsgType>(type) == MsgType::Welcome){
+            WelcomeMsg w;
+            if (readWelcome(p, w)) b.id = w.playerId;
+        }
+    }
+}
+
+void BotSwarm::run(){
+    connectAll();
+    std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+    std::uniform_int_distribution<int> chance(0, 999);
+    std::uniform_int_distribution<int> coord(-24, 24);
+    std::uniform_int_distribution<int> height(2, 12);
+    std::uniform_int_distribution<int> block(0, BLOCK_TYPE_COUNT - 1);
+    const auto tickDuration = std::chrono::milliseconds(50);
+    auto next = std::chrono::steady_clock::now();
+    uint32_t tick = 0;
+
+    while (running.load()){
+        ++tick;
+        for (auto &bp : bots){
+            Bot &b = *bp;
+            if (!b.connected) continue;
+            pump(b);
+            if (b.id == 0) continue;
+
+            if (--b.retargetIn <= 0){
+                float a = angle(rng);
+                b.input.moveX = std::sin(a);
+                b.input.moveZ = std::cos(a);
+                b.input.yawDeg = a * 57.29578f;
+                b.retargetIn = 20 + chance(rng) % 60;
+            }
+            b.input.jump = chance(rng) < 20;
+            b.input.tick = tick;
+            send(b, makeInput(b.input));
+            if (chance(rng) < 10){
+                EditMsg e{coord(rng), height(rng), coord(rng), static_cast<uint16_t>(block(rng))};
+                send(b, makeEdit(MsgType::Edit, e));
+            }
+        }
+        next += tickDuration;
+        std::this_thread::sleep_until(next);
+    }
+    for (auto &b : bots) b->socket.disconnect();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+#include "net_protocol.h"
+
+// Simulated players for load testing: real TCP clients on one thread that
+// random-walk, jump and edit blocks, and drain everything the server sends.
+class BotSwarm {
+public:
+    BotSwarm(int count, unsigned short port, unsigned seed = 1);
+    ~BotSwarm();
+    BotSwarm(const BotSwarm&) = delete;
+    BotSwarm& operator=(const BotSwarm&) = delete;
+
+    void start();
+    void stop();
+    uint64_t bytesReceived() const { return received.load(std::memory_order_relaxed); }
+
+private:
+    struct Bot {
+        sf::TcpSocket socket;
+        bool connected = false;
+        uint32_t id = 0;
+        InputMsg input;
+        int retargetIn = 0;
+        std::optional<sf::Packet> pending; // partially sent packet to resume
+    };
+
+    void run();
+    void connectAll();
+    void pump(Bot &b);
+    bool send(Bot &b, sf::Packet p);
+
+    int count;
+    unsigned short port;
+    std::mt19937 rng;
+    std::vector<std::unique_ptr<Bot>> bots;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> received{0};
+    std::thread thread;
+};
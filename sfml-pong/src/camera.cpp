@@ -0,0 +1,44 @@
+#include "camera.h"
+
+void Camera::setPerspective(float fov, float aspectRatio, float n, float f){
+    if (fov == fovYDeg && aspectRatio == aspect && n == znear && f == zfar) return;
+    fovYDeg = fov;
+    aspect = aspectRatio;
+    znear = n;
+    zfar = f;
+    dirty |= PROJ_DIRTY | COMBINED_DIRTY;
+    ++revision_;
+}
+
+void Camera::lookAt(const sf::Vector3f &e, const sf::Vector3f &c, const sf::Vector3f &u){
+    if (e == eye_ && c == center && u == up) return;
+    eye_ = e;
+    center = c;
+    up = u;
+    dirty |= VIEW_DIRTY | COMBINED_DIRTY;
+    ++revision_;
+}
+
+void Camera::orbit(const sf::Vector3f &c, float distance, float yawDeg, float pitchDeg){
+    lookAt(c + forwardFromYawPitch(yawDeg, pitchDeg) * distance, c);
+}
+
+void Camera::firstPerson(const sf::Vector3f &e, float yawDeg, float pitchDeg){
+    lookAt(e, e + forwardFromYawPitch(yawDeg, pitchDeg));
+}
+
+void Camera::refresh() const{
+    if (!dirty) return;
+    if (dirty & VIEW_DIRTY) view_ = ::lookAt(eye_, center, up);
+    if (dirty & PROJ_DIRTY) proj_ = perspective(fovYDeg, aspect, znear, zfar);
+    if (dirty & COMBINED_DIRTY){
+        viewProj_ = proj_ * view_;
+        frustum_ = extractFrustum(viewProj_);
+    }
+    dirty = 0;
+}
+
+const Mat4& Camera::view() const { refresh(); return view_; }
+const Mat4& Camera::projection() const { refresh(); return proj_; }
+const Mat4& Camera::viewProjection() const { refresh(); return viewProj_; }
+const Frustum& Camera::frustum() const { refresh(); return frustum_; }
@@ -0,0 +1,36 @@
+#pragma once
+#include <SFML/System.hpp>
+#include <cstdint>
+#include "math3d.h"
+
+// Perspective camera that caches its matrices. Setters only mark what changed
+// when the inputs actually differ; view(), projection(), viewProjection() and
+// frustum() rebuild lazily. revision() moves whenever any of them would, so
+// consumers (the camera uniform buffer) can skip re-uploading a still camera.
+class Camera {
+public:
+    void setPerspective(float fovYDeg, float aspect, float znear, float zfar);
+    void lookAt(const sf::Vector3f &eye, const sf::Vector3f &center, const sf::Vector3f &up = {0.f, 1.f, 0.f});
+    // Eye on a sphere of `distance` around `center`, looking at it.
+    void orbit(const sf::Vector3f &center, float distance, float yawDeg, float pitchDeg);
+    void firstPerson(const sf::Vector3f &eye, float yawDeg, float pitchDeg);
+
+    const Mat4& view() const;
+    const Mat4& projection() const;
+    const Mat4& viewProjection() const;
+    const Frustum& frustum() const;
+    const sf::Vector3f& eye() const { return eye_; }
+    uint32_t revision() const { return revision_; }
+
+private:
+    enum : uint8_t { VIEW_DIRTY = 1, PROJ_DIRTY = 2, COMBINED_DIRTY = 4 };
+    void refresh() const;
+
+    float fovYDeg = 60.f, aspect = 1.f, znear = 0.1f, zfar = 100.f;
+    sf::Vector3f eye_{0.f, 0.f, 1.f}, center{0.f, 0.f, 0.f}, up{0.f, 1.f, 0.f};
+    uint32_t revision_ = 1;
+
+    mutable uint8_t dirty = VIEW_DIRTY | PROJ_DIRTY | COMBINED_DIRTY;
+    mutable Mat4 view_, proj_, viewProj_;
+    mutable Frustum frustum_;
+};
@@ -0,0 +1,178 @@
+#include "chunk_codec.h"
+#include <algorithm>
+
+static void putVarint(std::vector<uint8_t> &b, uint32_t v){
+    while (v >= 0x80){ b.push_back(static_cast<uint8_t>(v | 0x80)); v >>= 7; }
+    b.push_back(static_cast<uint8_t>(v));
+}
+
+static bool getVarint(const uint8_t *d, size_t size, size_t &pos, uint32_t &v){
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7){
+        if (pos >= size) return false;
+        uint8_t byte = d[pos++];
+        v |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static int bitsFor(size_t paletteSize){
+    int bits = 0;
+    while ((size_t(1) << bits) < paletteSize) ++bits;
+    return bits;
+}
+
+void encodeChunk(const Chunk &c, std::vector<uint8_t> &out){
+    out.clear();
+    // palette in order of first use. Chunks usually hold a handful of ids in long
+    // runs, so search linearly behind a last-id check and only switch to a full
+    // lookup table when the palette gets large.
+    std::vector<uint16_t> palette;
+    std::vector<int32_t> table;
+    std::vector<uint16_t> idx(c.blocks.size());
+    uint16_t lastId = 0, lastSlot = 0;
+    for (size_t i = 0; i < c.blocks.size(); ++i){
+        uint16_t id = c.blocks.get(i);
+        if (palette.empty() || id != lastId){
+            int32_t slot = -1;
+            if (!table.empty()) slot = table[id];
+            else {
+                auto it = std::find(palette.begin(), palette.end(), id);
+                if (it != palette.end()) slot = static_cast<int32_t>(it - palette.begin());
+            }
+            if (slot < 0){
+                slot = static_cast<int32_t>(palette.size());
+                palette.push_back(id);
+                if (!table.empty()) table[id] = slot;
+                else if (palette.size() == 32){
+                    table.assign(65536, -1);
+                    for (size_t p = 0; p < palette.size(); ++p) table[palette[p]] = static_cast<int32_t>(p);
+                }
+            }
+            lastId = id;
+            lastSlot = static_cast<uint16_t>(slot);
+        }
+        idx[i] = lastSlot;
+    }
+    const int bits = bitsFor(palette.size());
+
+    // runs: one varint per run holding (length-1) above the palette index
+    std::vector<uint8_t> runs;
+    for (size_t i = 0; i < idx.size();){
+        size_t j = i + 1;
+        while (j < idx.size() && idx[j] == idx[i]) ++j;
+        putVarint(runs, static_cast<uint32_t>(((j - i - 1) << bits) | idx[i]));
+        i = j;
+    }
+    const size_t packedBytes = (idx.size() * bits + 7) / 8;
+    const bool useRuns = runs.size() <= packedBytes;
+
+    out.push_back(static_cast<uint8_t>(useRuns ? ChunkEncoding::Runs : ChunkEncoding::Packed));
+    putVarint(out, static_cast<uint32_t>(palette.size()));
+    for (uint16_t id : palette) putVarint(out, id);
+    if (useRuns){
+        out.insert(out.end(), runs.begin(), runs.end());
+        return;
+    }
+    size_t base = out.size();
+    out.resize(base + packedBytes, 0);
+    size_t bit = 0;
+    for (uint16_t v : idx){
+        for (int b = 0; b < bits; ++b, ++bit)
+            if (v & (1u << b)) out[base + bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+    }
+}
+
+bool decodeChunk(const uint8_t *data, size_t size, Chunk &c){
+    size_t pos = 0;
+    if (size < 1) return false;
+    uint8_t mode = data[pos++];
+    uint32_t n = 0;
+    if (!getVarint(data, size, pos, n) || n == 0 || n > c.blocks.size()) return false;
+    std::vector<uint16_t> palette(n);
+    for (auto &id : palette){
+        uint32_t v = 0;
+        // ids index the block registry unchecked from here on
+        if (!getVarint(data, size, pos, v) || v >= BLOCK_TYPE_COUNT) return false;
+        id = static_cast<uint16_t>(v);
+    }
+    const int bits = bitsFor(palette.size());
+    const uint32_t mask = (1u << bits) - 1;
+    // the wire palette becomes the chunk's storage palette; indices go straight in
+    const size_t count = c.blocks.size();
+    c.blocks.usePalette(palette.data(), palette.size());
+
+    if (mode == static_cast<uint8_t>(ChunkEncoding::Runs)){
+        size_t i = 0;
+        while (i < count){
+            uint32_t v = 0;
+            if (!getVarint(data, size, pos, v)) return false;
+            uint32_t p = v & mask;
+            size_t len = (v >> bits) + 1;
+            if (p >= n || len > count - i) return false;
+            if (p != 0) c.blocks.fillSlots(i, len, p);
+            i += len;
+        }
+        c.blocks.endFill();
+        return pos == size;
+    }
+    if (mode != static_cast<uint8_t>(ChunkEncoding::Packed)) return false;
+    if (size - pos != (count * bits + 7) / 8) return false;
+    const uint8_t *packed = data + pos;
+    size_t bit = 0;
+    for (size_t i = 0; i < count; ++i){
+        uint32_t v = 0;
+        for (int b = 0; b < bits; ++b, ++bit)
+            v |= static_cast<uint32_t>((packed[bit / 8] >> (bit % 8)) & 1) << b;
+        if (v >= n) return false;
+        if (v != 0) c.blocks.fillSlots(i, 1, v);
+    }
+    c.blocks.endFill();
+    return true;
+}
+
+void encodeDeltas(std::vector<BlockDelta> &deltas, std::vector<uint8_t> &out){
+    out.clear();
+    std::stable_sort(deltas.begin(), deltas.end(), [](const BlockDelta &a, const BlockDelta &b){ return a.index < b.index; });
+    // keep the last write to each block
+    size_t w = 0;
+    for (size_t r = 0; r < deltas.size(); ++r){
+        if (w > 0 && deltas[w-1].index == deltas[r].index) deltas[w-1] = deltas[r];
+        else deltas[w++] = deltas[r];
+    }
+    deltas.resize(w);
+
+    putVarint(out, static_cast<uint32_t>(deltas.size()));
+    uint32_t prev = 0;
+    for (const auto &d : deltas){
+        putVarint(out, d.index - prev);
+        putVarint(out, d.id);
+        prev = d.index;
+    }
+}
+
+bool decodeDeltas(const uint8_t *data, size_t size, std::vector<BlockDelta> &out){
+    size_t pos = 0;
+    uint32_t n = 0;
+    if (!getVarint(data, size, pos, n) || n > static_cast<uint32_t>(CHUNK_VOLUME)) return false;
+    out.resize(n);
+    uint32_t index = 0;
+    for (auto &d : out){
+        uint32_t gap = 0, id = 0;
+        if (!getVarint(data, size, pos, gap) || !getVarint(data, size, pos, id)) return false;
+        index += gap;
+        if (index >= static_cast<uint32_t>(CHUNK_VOLUME) || id > 0xffff) return false;
+        d.index = static_cast<uint16_t>(index);
+        d.id = static_cast<uint16_t>(id);
+    }
+    return pos == size;
+}
+
+bool applyDeltas(Chunk &c, const std::vector<BlockDelta> &deltas){
+    for (const auto &d : deltas){
+        if (d.index >= c.blocks.size()) return false;
+        c.blocks.set(d.index, d.id);
+    }
+    return true;
+}
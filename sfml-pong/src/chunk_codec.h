@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "voxel_world.h"
+
+// Wire encoding for chunk contents. A full chunk is a palette of the ids it
+// uses followed by either run-length coded palette indices or, when that would
+// be larger (noisy chunks), the indices bit-packed. Edits go out as delta
+// batches: sorted block indices (gap coded) plus new ids. All integers are
+// LEB128 varints.
+enum class ChunkEncoding : uint8_t { Runs = 0, Packed = 1 };
+
+struct BlockDelta {
+    uint16_t index = 0;   // Chunk::index()
+    uint16_t id = 0;
+};
+
+void encodeChunk(const Chunk &c, std::vector<uint8_t> &out);
+// false on malformed data, including block ids the registry does not know
+bool decodeChunk(const uint8_t *data, size_t size, Chunk &c);
+
+// Sorts and de-duplicates `deltas` (last write per index wins) before encoding.
+void encodeDeltas(std::vector<BlockDelta> &deltas, std::vector<uint8_t> &out);
+bool decodeDeltas(const uint8_t *data, size_t size, std::vector<BlockDelta> &out);
+bool applyDeltas(Chunk &c, const std::vector<BlockDelta> &deltas);
@@ -0,0 +1,95 @@
+#include "chunk_mesher.h"
+#include "trace.h"
+#include "translucent_sort.h"
+
+MeshBuffers buildSectionMesh(const MeshJob &job){
+    MeshBuffers out, blended;
+    const auto &uvs = *job.uvs;
+    // a face is visible unless an opaque block covers it, or it is between
+    // two translucent blocks of the same kind (water against water)
+    auto open = [&](BlockId self, int px, int pz, int y){
+        if (y < 0 || y >= job.height) return true;
+        const BlockId n = job.at(px, pz, y);
+        return !blockOpaque(n) && !(n == self && blockTranslucent(n));
+    };
+
+    for(int lx=0; lx<SECTION; ++lx){
+        for(int lz=0; lz<SECTION; ++lz){
+            const int px = lx + 1, pz = lz + 1;
+            for(int yi=0; yi<job.height; ++yi){
+                const BlockId cell = job.at(px, pz, yi);
+                if (cell == BLOCK_AIR) continue;
+
+                const int mask = FACE_TOP    * open(cell, px, pz, yi+1)
+                               | FACE_BOTTOM * open(cell, px, pz, yi-1)
+                               | FACE_FRONT  * open(cell, px, pz+1, yi)
+                               | FACE_BACK   * open(cell, px, pz-1, yi)
+                               | FACE_RIGHT  * open(cell, px+1, pz, yi)
+                               | FACE_LEFT   * open(cell, px-1, pz, yi);
+                if (mask == 0) continue; // block fully surrounded
+
+                emitBlockFaces(blockTranslucent(cell) ? blended : out, static_cast<float>(lx), static_cast<float>(yi), static_cast<float>(lz), uvs[cell], mask);
+            }
+        }
+    }
+    // the blended pass binds the atlas once, so face groups don't matter there
+    for (const auto &g : blended.groups) out.translucent.insert(out.translucent.end(), g.begin(), g.end());
+    return out;
+}
+
+MeshWorkers::MeshWorkers(unsigned threadCount){
+    if (threadCount == 0){
+        unsigned hw = std::thread::hardware_concurrency();
+        threadCount = hw > 1 ? hw - 1 : 1;
+    }
+    for (unsigned i = 0; i < threadCount; ++i) threads.emplace_back([this]{ run(); });
+}
+
+MeshWorkers::~MeshWorkers(){
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobCv.notify_all();
+    for (auto &t : threads) t.join();
+}
+
+void MeshWorkers::submit(MeshJob job){
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobs.push_back(std::move(job));
+    }
+    jobCv.notify_one();
+}
+
+void MeshWorkers::run(){
+    traceSetThreadName("mesh worker");
+    for (;;){
+        MeshJob job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobCv.wait(lock, [this]{ return stopping || !jobs.empty(); });
+            if (stopping) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        TraceZone meshZone("mesh section");
+        auto result = std::make_unique<MeshResult>();
+        result->cx = job.cx;
+        result->cz = job.cz;
+        result->version = job.version;
+        result->height = job.height;
+        result->mesh = buildSectionMesh(job);
+        if (!result->mesh.translucent.empty())
+            result->translucentCentres = std::make_shared<const std::vector<float>>(quadCentres(result->mesh.translucent, MESH_VERTEX_FLOATS));
+        meshZone.end();
+        // the main thread drains every frame, so a full queue only means a short wait
+        while (!completed.tryPush(result)){
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                if (stopping) return;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
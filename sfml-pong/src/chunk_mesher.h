@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "lockfree_queue.h"
+#include "rendering.h"
+#include "world.h"
+
+// Terrain is meshed in SECTION x SECTION column sections
+const int SECTION = 16;
+const int SECTIONS = CHUNK / SECTION;
+
+// Everything a worker needs to mesh one section, copied on the main thread so
+// meshing never touches live world state. cells holds a one-block border on X/Z
+// (padded width SECTION+2) and stores block ids.
+struct MeshJob {
+    int cx = 0, cz = 0;
+    uint32_t version = 0;
+    int height = 0;
+    std::vector<BlockId> cells;
+    std::shared_ptr<const BlockUVTable> uvs;
+
+    static const int PAD = SECTION + 2;
+    BlockId at(int px, int pz, int y) const { return cells[(static_cast<size_t>(y) * PAD + pz) * PAD + px]; }
+};
+
+struct MeshResult {
+    int cx = 0, cz = 0;
+    uint32_t version = 0;
+    int height = 0;       // tallest column, bounds the section for culling
+    MeshBuffers mesh;
+    std::shared_ptr<const std::vector<float>> translucentCentres; // for back-to-front sorting
+};
+
+// Vertices are relative to sectionOrigin(); the renderer adds it per draw.
+MeshBuffers buildSectionMesh(const MeshJob &job);
+inline float sectionOriginX(int cx){ return static_cast<float>(cx * SECTION - CHUNK/2); }
+inline float sectionOriginZ(int cz){ return static_cast<float>(cz * SECTION - CHUNK/2); }
+
+// Worker pool: jobs go in through a mutex-guarded deque (workers sleep on it),
+// finished meshes come back through a lock-free queue drained by the GL thread.
+class MeshWorkers {
+public:
+    explicit MeshWorkers(unsigned threadCount = 0);
+    ~MeshWorkers();
+    MeshWorkers(const MeshWorkers&) = delete;
+    MeshWorkers& operator=(const MeshWorkers&) = delete;
+
+    void submit(MeshJob job);
+    bool pollResult(std::unique_ptr<MeshResult> &out) { return completed.tryPop(out); }
+    unsigned threadCount() const { return static_cast<unsigned>(threads.size()); }
+
+private:
+    void run();
+
+    std::vector<std::thread> threads;
+    std::mutex jobMutex;
+    std::condition_variable jobCv;
+    std::deque<MeshJob> jobs;
+    bool stopping = false;
+    LockFreeQueue<std::unique_ptr<MeshResult>> completed{256};
+};
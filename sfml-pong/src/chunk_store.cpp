@@ -0,0 +1,83 @@
+#include "chunk_store.h"
+#include "chunk_codec.h"
+#include "trace.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+static const char MAGIC[4] = {'C', 'B', 'C', 'K'};
+static const uint8_t VERSION = 1;
+static const size_t HEADER_SIZE = 9;
+
+bool ChunkStore::open(const std::string &path){
+    std::error_code ec;
+    std::filesystem::create_directories(path, ec);
+    if (ec || !std::filesystem::is_directory(path, ec)){
+        std::cerr << "Could not create chunk directory " << path << ": " << ec.message() << "\n";
+        dir.clear();
+        return false;
+    }
+    dir = path;
+    return true;
+}
+
+std::string ChunkStore::pathFor(ChunkPos p) const{
+    return dir + "/" + std::to_string(p.x) + "_" + std::to_string(p.z) + ".chunk";
+}
+
+bool ChunkStore::contains(ChunkPos p) const{
+    std::error_code ec;
+    return isOpen() && std::filesystem::is_regular_file(pathFor(p), ec);
+}
+
+bool ChunkStore::save(const Chunk &c){
+    if (!isOpen()) return false;
+    TRACE_ZONE("save chunk");
+    buf.assign(MAGIC, MAGIC + 4);
+    buf.push_back(VERSION);
+    for (int i = 0; i < 4; ++i) buf.push_back(static_cast<uint8_t>(c.version >> (8 * i)));
+    std::vector<uint8_t> body;
+    encodeChunk(c, body);
+    buf.insert(buf.end(), body.begin(), body.end());
+
+    const std::string path = pathFor(c.pos), tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f.write(reinterpret_cast<const char*>(buf.data()), static_cast<std::streamsize>(buf.size()))){
+            std::cerr << "Could not write " << tmp << "\n";
+            return false;
+        }
+    }
+    // std::rename does not replace an existing file on Windows; this does, everywhere
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec){
+        std::cerr << "Could not replace " << path << ": " << ec.message() << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool ChunkStore::load(ChunkPos p, Chunk &c){
+    if (!isOpen()) return false;
+    TRACE_ZONE("load chunk");
+    const std::string path = pathFor(p);
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    buf.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    if (buf.size() < HEADER_SIZE || std::memcmp(buf.data(), MAGIC, 4) != 0 || buf[4] != VERSION){
+        std::cerr << "Not a chunk file (or unsupported version): " << path << "\n";
+        return false;
+    }
+    uint32_t version = 0;
+    for (int i = 0; i < 4; ++i) version |= static_cast<uint32_t>(buf[5 + i]) << (8 * i);
+    if (!decodeChunk(buf.data() + HEADER_SIZE, buf.size() - HEADER_SIZE, c)){
+        std::cerr << "Corrupt chunk file: " << path << "\n";
+        return false;
+    }
+    c.pos = p;
+    c.version = version;
+    return true;
+}
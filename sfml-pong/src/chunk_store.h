@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "voxel_world.h"
+
+// Directory of saved chunks, one file per chunk named "<x>_<z>.chunk".
+//
+// Layout (little endian): "CBCK" u8 version, u32 chunk version, then the
+// encodeChunk() bytes. A save is written to a temporary file and renamed over
+// the old one, so an interrupted write leaves the previous save intact.
+class ChunkStore {
+public:
+    bool open(const std::string &dir); // creates the directory if needed
+    bool isOpen() const { return !dir.empty(); }
+    const std::string& directory() const { return dir; }
+
+    bool contains(ChunkPos p) const;   // a complete save exists
+    bool save(const Chunk &c);
+    // false if the chunk was never saved or its file is unreadable
+    bool load(ChunkPos p, Chunk &c);
+
+private:
+    std::string pathFor(ChunkPos p) const;
+
+    std::string dir;
+    std::vector<uint8_t> buf;
+};
@@ -0,0 +1,90 @@
+#include "codec_bench.h"
+#include "chunk_codec.h"
+#include "voxel_world.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using BenchClock = std::chrono::steady_clock;
+
+static double secondsSince(BenchClock::time_point t0){
+    return std::chrono::duration<double>(BenchClock::now() - t0).count();
+}
+
+int runCodecBench(unsigned seed, int radius){
+    VoxelWorld world(seed);
+    std::vector<const Chunk*> chunks;
+    for (int z = -radius; z <= radius; ++z)
+        for (int x = -radius; x <= radius; ++x) chunks.push_back(&world.chunk({x, z}));
+
+    std::vector<std::vector<uint8_t>> encoded(chunks.size());
+    size_t total = 0, smallest = SIZE_MAX, largest = 0, packed = 0;
+    for (size_t i = 0; i < chunks.size(); ++i){
+        encodeChunk(*chunks[i], encoded[i]);
+        total += encoded[i].size();
+        smallest = std::min(smallest, encoded[i].size());
+        largest = std::max(largest, encoded[i].size());
+        if (encoded[i][0] == static_cast<uint8_t>(ChunkEncoding::Packed)) ++packed;
+        Chunk check;
+        if (!decodeChunk(encoded[i].data(), encoded[i].size(), check) || check.blocks != chunks[i]->blocks){
+            std::fprintf(stderr, "Round trip failed for chunk %d,%d\n", chunks[i]->pos.x, chunks[i]->pos.z);
+            return 1;
+        }
+    }
+
+    // repeat whole passes until each measurement runs for at least half a second
+    const double rawChunkBytes = CHUNK_VOLUME * sizeof(uint16_t);
+    std::vector<uint8_t> out;
+    size_t encodes = 0;
+    auto t0 = BenchClock::now();
+    do {
+        for (const Chunk *c : chunks) encodeChunk(*c, out);
+        encodes += chunks.size();
+    } while (secondsSince(t0) < 0.5);
+    const double encodeSeconds = secondsSince(t0);
+
+    Chunk scratch;
+    size_t decodes = 0;
+    t0 = BenchClock::now();
+    do {
+        for (const auto &e : encoded) decodeChunk(e.data(), e.size(), scratch);
+        decodes += encoded.size();
+    } while (secondsSince(t0) < 0.5);
+    const double decodeSeconds = secondsSince(t0);
+
+    const double n = static_cast<double>(chunks.size());
+    std::printf("codec bench: seed %u, %zu chunks (%dx%dx%d)\n", seed, chunks.size(), CHUNK_SIZE, CHUNK_HEIGHT, CHUNK_SIZE);
+    std::printf("  raw         %.0f B/chunk\n", rawChunkBytes);
+    const ChunkMemoryStats mem = world.memoryStats();
+    std::printf("  in memory   %.0f B/chunk paletted (%zu uniform, %zu at 1 bit, %zu at 2, %zu at 4, %zu at 8, %zu at 16)\n",
+        static_cast<double>(mem.bytes) / static_cast<double>(mem.chunks), mem.uniform,
+        mem.byWidth[1], mem.byWidth[2], mem.byWidth[4], mem.byWidth[8], mem.byWidth[16]);
+    std::printf("  encoded     %.1f B/chunk avg, %zu min, %zu max (%.0fx smaller), %zu packed / %zu run-length\n",
+        static_cast<double>(total) / n, smallest, largest, rawChunkBytes * n / static_cast<double>(total), packed, chunks.size() - packed);
+    std::printf("  encode      %.0f chunks/s, %.1f MB/s raw\n",
+        static_cast<double>(encodes) / encodeSeconds, static_cast<double>(encodes) * rawChunkBytes / encodeSeconds / 1e6);
+    std::printf("  decode      %.0f chunks/s, %.1f MB/s raw\n",
+        static_cast<double>(decodes) / decodeSeconds, static_cast<double>(decodes) * rawChunkBytes / decodeSeconds / 1e6);
+
+    // random edits in the middle chunk: delta batch vs full chunk after the edits
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> cell(0, CHUNK_VOLUME - 1);
+    std::uniform_int_distribution<int> block(0, BLOCK_TYPE_COUNT - 1);
+    std::vector<BlockDelta> deltas;
+    std::vector<uint8_t> delta, full;
+    for (int edits : {1, 8, 64, 512, 4096}){
+        Chunk edited = *chunks[chunks.size() / 2];
+        deltas.clear();
+        for (int i = 0; i < edits; ++i){
+            BlockDelta d{static_cast<uint16_t>(cell(rng)), static_cast<uint16_t>(block(rng))};
+            edited.blocks.set(d.index, d.id);
+            deltas.push_back(d);
+        }
+        encodeDeltas(deltas, delta);
+        encodeChunk(edited, full);
+        std::printf("  %4d edits  delta %6zu B, full %6zu B -> %s\n", edits, delta.size(), full.size(), delta.size() < full.size() ? "delta" : "full");
+    }
+    return 0;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// `cube_server --codec-bench R`: encodes the generated chunks within R chunks
+// of the origin and prints bytes per chunk, encode/decode throughput and how
+// delta batches of various sizes compare with resending the chunk.
+int runCodecBench(unsigned seed, int radius);
@@ -5,13 +5,30 @@
 #include <iostream>
 #include <random>
 #include <cstdio>
+#include <cstring>
+#include <cmath>
 #include <algorithm>
 #include <vector>
 #include <string>
 #include "texture_atlas.h"
 #include "world.h"
 #include "rendering.h"
+#include "terrain_renderer.h"
+#include "simulation.h"
+#include "launch_options.h"
+#include "input_log.h"
+#include "frame_arena.h"
+#include "alloc_counter.h"
+#include "bitmap_hud.h"
+#include "render_pipeline.h"
+#include "camera.h"
+#include "frame_pacer.h"
+#include "input_latency.h"
+#include "asset_bundle.h"
+#include "trace.h"
 #include <fstream>
+#include <chrono>
+#include <thread>
 
 // Helper to find assets directory
 static std::string findAssetsDirectory() {
@@ -86,26 +103,48 @@ static sf::Image makeDirtImage(unsigned size){
     return img;
 }
 
-int main() {
-    const unsigned WINDOW_W = 800, WINDOW_H = 600;
-    sf::RenderWindow window(sf::VideoMode(sf::Vector2u{WINDOW_W, WINDOW_H}), "Cube - Textured (Minecraft-like)");
-    window.setFramerateLimit(60);
+// GL 3.3 for the shader pipeline. Compatibility profile, because SFML's own 2D
+// drawing (HUD text) still uses the legacy API on the same context.
+static sf::ContextSettings sceneContextSettings(){
+    sf::ContextSettings settings;
+    settings.depthBits = 24;
+    settings.majorVersion = 3;
+    settings.minorVersion = 3;
+    return settings;
+}
 
+static void initGLState(){
     // Basic GL setup
     glEnable(GL_DEPTH_TEST);
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_TEXTURE_2D);
     // Sky Blue background
     glClearColor(0.529f, 0.808f, 0.922f, 1.0f);
+}
+
+// Opens the asset bundle unless told to use loose files; false leaves it closed
+static bool openBundle(const LaunchOptions &opt, AssetBundle &bundle){
+    if (opt.looseAssets || !bundle.open(opt.bundleFile)) return false;
+    std::cout << "Using asset bundle " << opt.bundleFile << "\n";
+    return true;
+}
+
+static void printTiles(const TextureAtlas &atlas, const char *how){
+    std::cout << how << " tiles: TOP(" << atlas.TOP_TILE.x << "," << atlas.TOP_TILE.y << ") SIDE(" << atlas.SIDE_TILE.x << "," << atlas.SIDE_TILE.y << ") DIRT(" << atlas.DIRT_TILE.x << "," << atlas.DIRT_TILE.y << ")\n";
+}
+
+// From the bundle when it is open and has the atlas, else from loose files
+static void setupAtlas(TextureAtlas &atlas, const AssetBundle &bundle, bool verbose = true){
+    if (bundle.isOpen() && atlas.loadFromBundle(bundle)){
+        if (verbose) printTiles(atlas, "Bundled");
+        return;
+    }
 
     // Texture & atlas initialization
-    TextureAtlas atlas;
     std::string assetsDir = findAssetsDirectory();
-    std::cout << "Found assets directory: " << assetsDir << "\n";
+    if (verbose) std::cout << "Found assets directory: " << assetsDir << "\n";
     
     // Load atlas using the found directory
     std::string atlasPath = assetsDir + "/atlas.png";
-    if (atlas.loadAtlas(atlasPath)) {
+    if (atlas.loadAtlas(atlasPath) && verbose) {
         std::cout << "Loaded atlas: " << atlasPath << "\n";
     }
 
@@ -117,52 +156,8 @@ int main() {
     // Auto-detect likely tiles for grass-top, grass-side and dirt if atlas loaded
     if (atlas.atlasLoaded){
         try{
-            sf::Image atlasImg = atlas.atlasTex.copyToImage();
-            struct Scores { float green=0.f; float brown=0.f; float topGreenFrac=0.f; float bottomBrownFrac=0.f; };
-            std::vector<Scores> scores(atlas.atlasCols * atlas.atlasRows);
-            for(int ty=0; ty<atlas.atlasRows; ++ty){
-                for(int tx=0; tx<atlas.atlasCols; ++tx){
-                    Scores s;
-                    int baseX = tx * atlas.atlasTileSize;
-                    int baseY = ty * atlas.atlasTileSize;
-                    int total = atlas.atlasTileSize * atlas.atlasTileSize;
-                    int topCount=0, topGreen=0;
-                    int bottomCount=0, bottomBrown=0;
-                    for(int y=0;y<atlas.atlasTileSize;++y){
-                        for(int x=0;x<atlas.atlasTileSize;++x){
-                            auto c = atlasImg.getPixel(sf::Vector2u{static_cast<unsigned>(baseX + x), static_cast<unsigned>(baseY + y)});
-                            float r = static_cast<float>(c.r);
-                            float g = static_cast<float>(c.g);
-                            float b = static_cast<float>(c.b);
-                            s.green += std::max(0.f, g - (r + b) * 0.5f);
-                            s.brown += std::max(0.f, r - (g + b) * 0.5f);
-                            if (y < atlas.atlasTileSize/4){ ++topCount; if (g > r + 8 && g > b + 8) ++topGreen; }
-                            if (y >= atlas.atlasTileSize/2){ ++bottomCount; if (r > g + 6 && r > b) ++bottomBrown; }
-                        }
-                    }
-                    s.topGreenFrac = topCount ? (float)topGreen / (float)topCount : 0.f;
-                    s.bottomBrownFrac = bottomCount ? (float)bottomBrown / (float)bottomCount : 0.f;
-                    s.green /= static_cast<float>(total);
-                    s.brown /= static_cast<float>(total);
-                    scores[ty * atlas.atlasCols + tx] = s;
-                }
-            }
-
-            float bestTopScore = -1.f; sf::Vector2i bestTop{0,0};
-            float bestDirtScore = -1.f; sf::Vector2i bestDirt{0,0};
-            float bestSideScore = -1.f; sf::Vector2i bestSide{0,0};
-            for(int ty=0; ty<atlas.atlasRows; ++ty){
-                for(int tx=0; tx<atlas.atlasCols; ++tx){
-                    auto &s = scores[ty*atlas.atlasCols + tx];
-                    float topScore = s.green * (0.7f + 0.6f * s.topGreenFrac);
-                    float dirtScore = s.brown;
-                    float sideScore = s.topGreenFrac * (0.5f + s.bottomBrownFrac);
-                    if (topScore > bestTopScore){ bestTopScore = topScore; atlas.TOP_TILE = {tx,ty}; }
-                    if (dirtScore > bestDirtScore){ bestDirtScore = dirtScore; atlas.DIRT_TILE = {tx,ty}; }
-                    if (sideScore > bestSideScore){ bestSideScore = sideScore; atlas.SIDE_TILE = {tx,ty}; }
-                }
-            }
-            std::cout << "Auto-detected tiles: TOP(" << atlas.TOP_TILE.x << "," << atlas.TOP_TILE.y << ") SIDE(" << atlas.SIDE_TILE.x << "," << atlas.SIDE_TILE.y << ") DIRT(" << atlas.DIRT_TILE.x << "," << atlas.DIRT_TILE.y << ")\n";
+            atlas.detectTiles(atlas.atlasTex.copyToImage());
+            if (verbose) printTiles(atlas, "Auto-detected");
         } catch(...){ std::cout << "Atlas auto-detection failed, keep defaults.\n"; }
     }
 
@@ -174,26 +169,232 @@ int main() {
         img = makeSideImage(texSize); atlas.sideTex.loadFromImage(img);
         img = makeDirtImage(texSize); atlas.dirtTex.loadFromImage(img);
     }
+}
+
+// The font reads from the bundle's mapping for as long as it is used
+static bool loadHudFont(sf::Font &font, const AssetBundle &bundle){
+    if (const BundleEntry *e = bundle.isOpen() ? bundle.find("font") : nullptr)
+        if (font.openFromMemory(bundle.data(*e), static_cast<size_t>(e->size))) return true;
+    // try project font first (assets), else try system Arial
+    return font.openFromFile("assets/arial.ttf") || font.openFromFile("C:/Windows/Fonts/arial.ttf");
+}
+
+// Times loading the atlas and font from loose files against the bundle, N
+// times each. The first round of each reads files the OS may not have
+// cached yet; for a truly cold start drop the page cache and compare the
+// "first frame" line of two real launches.
+static int runAssetBench(const LaunchOptions &opt){
+    sf::Context context; // texture uploads need a GL context, not a window
+    std::vector<double> loose, bundled;
+    for (int i = 0; i < opt.assetBench; ++i){
+        for (int useBundle = 0; useBundle < 2; ++useBundle){
+            const auto t0 = std::chrono::steady_clock::now();
+            AssetBundle bundle;
+            if (useBundle && !bundle.open(opt.bundleFile)){
+                std::cerr << "Could not open " << opt.bundleFile << " (run asset_pack first)\n";
+                return 1;
+            }
+            TextureAtlas atlas;
+            sf::Font font;
+            setupAtlas(atlas, bundle, false);
+            loadHudFont(font, bundle);
+            glFinish();
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            (useBundle ? bundled : loose).push_back(ms);
+        }
+    }
+    auto report = [](const char *name, std::vector<double> v){
+        const double first = v.front();
+        std::sort(v.begin(), v.end());
+        std::printf("  %-12s first %7.2f ms, median %7.2f ms, min %7.2f ms\n", name, first, v[v.size() / 2], v.front());
+    };
+    std::printf("Startup assets, %d rounds:\n", opt.assetBench);
+    report("loose files", loose);
+    report("bundle", bundled);
+    return 0;
+}
+
+// Projection, camera, sun and terrain for one frame; HUD is drawn by the caller.
+static void renderScene(const SimState &st, int w, int h, Camera &camera, RenderPipeline &pipeline, TerrainRenderer &terrain, const TextureAtlas &atlas, const MeshUploadBudget &budget){
+    TRACE_ZONE("render scene");
+    glViewport(0, 0, w, h);
+    camera.setPerspective(60.f, static_cast<float>(w) / static_cast<float>(h), 0.1f, 100.f);
+    // orbit around camCenter, or look out from the player's eye
+    if (st.fpsMode) camera.firstPerson(st.playerPos, st.camYawDeg, st.camPitchDeg);
+    else camera.orbit(st.camCenter, st.camDistance, st.camYawDeg, st.camPitchDeg);
+    pipeline.setCamera(camera);
+
+    // Clear
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Sun: fixed direction (late afternoon), drawn at infinity
+    pipeline.drawSun(sf::Vector3f{0.3f, 0.8f, -0.2f}, 80.f, 12.f);
+
+    // Render terrain grid of blocks
+    {
+        TRACE_ZONE("terrain upload");
+        terrain.update(budget);
+    }
+    {
+        TRACE_ZONE("terrain draw");
+        terrain.draw(pipeline, atlas, camera.frustum());
+    }
+    {
+        TRACE_ZONE("translucent draw");
+        terrain.drawTranslucent(pipeline, atlas, camera.frustum(), camera.eye());
+    }
+    pipeline.end();
+}
+
+// Headless flythrough: fixed seed, scripted camera, offscreen target, JSON report.
+static void printPoolStats(const TerrainRenderer &terrain){
+    const VertexPoolStats p = terrain.poolStats();
+    std::printf("[pool] %zu/%zu quads live (%.0f%%), %zu allocated, %zu free ranges, largest %zu, fragmentation %.2f, %s\n",
+        p.liveQuads, p.capacityQuads, 100.0 * p.utilisation(), p.allocatedQuads, p.freeRanges, p.largestFreeQuads, p.fragmentation(),
+        terrain.usesIndirect() ? "multi-draw indirect" : "one draw per section");
+}
+
+// traceFile non-empty: the first traceFrames timed frames are captured to it
+static int runBench(const BenchOptions &opt, const AssetBundle &bundle, bool multiDrawIndirect, const std::string &traceFile, int traceFrames){
+    std::vector<CameraKey> path = defaultCameraPath();
+    if (!opt.pathFile.empty() && !loadCameraPath(opt.pathFile, path)){
+        std::cerr << "Could not read camera path: " << opt.pathFile << "\n";
+        return 1;
+    }
+
+    // SFML backs a RenderTexture with an FBO where available (Mesa llvmpipe included)
+    sf::RenderTexture target;
+    if (!target.resize(sf::Vector2u{opt.width, opt.height}, sceneContextSettings()) || !target.setActive(true)){
+        std::cerr << "Could not create offscreen render target\n";
+        return 1;
+    }
+    initGLState();
+    RenderPipeline pipeline;
+    if (!pipeline.init()) return 1;
+    Camera camera;
 
-    // --- Block definition and terrain ----------------------------------
-    std::vector<Block> blocks;
-    // user-specified dirt block (all faces same tile)
-    blocks.push_back({"Dirt", sf::Vector2i{2,0}, sf::Vector2i{2,0}, sf::Vector2i{2,0}});
-    // grass block: top/side/bottom
-    if (atlas.atlasLoaded) {
-        blocks.push_back({"Grass", sf::Vector2i{11,8}, sf::Vector2i{11,8}, sf::Vector2i{11,8}});
-        blocks.push_back({"Stone", sf::Vector2i{1,0}, sf::Vector2i{1,0}, sf::Vector2i{1,0}});
-    } else {
-        blocks.push_back({"Grass", sf::Vector2i{0,0}, sf::Vector2i{0,0}, sf::Vector2i{2,0}}); // Fallback
-        blocks.push_back({"Stone", sf::Vector2i{2,0}, sf::Vector2i{2,0}, sf::Vector2i{2,0}}); // Fallback to Dirt
+    TextureAtlas atlas;
+    setupAtlas(atlas, bundle);
+    generateTerrain(opt.seed);
+    (void)target.setActive(true);
+
+    TerrainRenderer terrain;
+    terrain.allowIndirect(multiDrawIndirect);
+    terrain.setAtlas(atlas);
+    terrain.markAllDirty();
+    // Mesh and upload everything up front so the timed frames measure rendering only
+    const MeshUploadBudget unlimited{1e9, static_cast<size_t>(-1)};
+    while (!terrain.idle()){
+        terrain.update(unlimited);
+        std::this_thread::yield();
     }
 
-    int currentBlockIndex = 1; // Grass by default
+    const MeshUploadBudget budget;
+    const int w = static_cast<int>(opt.width), h = static_cast<int>(opt.height);
+    TraceCapture trace;
+    if (!traceFile.empty()) trace.start(traceFile, std::min(traceFrames, opt.frames));
+    std::vector<BenchFrame> frames;
+    frames.reserve(static_cast<size_t>(opt.frames));
+    SimState st;
+    st.fpsMode = true;
+    st.terrainSeed = opt.seed;
+    for (int i = 0; i < opt.frames; ++i){
+        float t = opt.frames > 1 ? static_cast<float>(i) / static_cast<float>(opt.frames - 1) : 0.f;
+        CameraKey k = sampleCameraPath(path, t);
+        st.playerPos = k.pos;
+        st.camYawDeg = k.yawDeg;
+        st.camPitchDeg = k.pitchDeg;
+
+        TraceZone frameZone("frame");
+        auto t0 = std::chrono::steady_clock::now();
+        renderScene(st, w, h, camera, pipeline, terrain, atlas, budget);
+        {
+            TRACE_ZONE("display");
+            target.display();
+            glFinish(); // count the GPU (or llvmpipe) work in the frame time
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        frameZone.end();
+        trace.frameEnd();
+
+        BenchFrame f;
+        f.millis = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        const TerrainStats &ts = terrain.stats();
+        f.drawCalls = ts.drawCalls + ts.translucentSectionsDrawn + 1; // + sun
+        f.drawCommands = ts.drawCommands;
+        f.triangles = ts.trianglesDrawn + ts.translucentTrianglesDrawn + 2; // + sun
+        f.chunksDrawn = ts.sectionsDrawn;
+        frames.push_back(f);
+    }
+
+    const char *renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    std::string report = benchReportJson(opt, frames, static_cast<size_t>(SECTIONS * SECTIONS), terrain.workerCount(), renderer ? renderer : "unknown",
+                                         terrain.usesIndirect(), terrain.poolStats());
+    std::cout << report;
+    if (!opt.outFile.empty()){
+        std::ofstream out(opt.outFile);
+        out << report;
+        if (!out){ std::cerr << "Could not write " << opt.outFile << "\n"; return 1; }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const auto launched = std::chrono::steady_clock::now();
+    LaunchOptions options;
+    if (!parseLaunchArgs(argc, argv, options)) return 2;
+    if (options.assetBench > 0) return runAssetBench(options);
+    // Lives as long as main: textures are uploaded from it and the font reads from it
+    AssetBundle bundle;
+    openBundle(options, bundle);
+    traceSetThreadName("main / render");
+    if (options.bench.enabled) return runBench(options.bench, bundle, options.multiDrawIndirect, options.traceFile, options.traceFrames);
+
+    // Replays carry their own terrain seed so the world matches the recording
+    InputPlayer replay;
+    const bool replaying = !options.replayFile.empty();
+    if (replaying && !replay.load(options.replayFile)){
+        std::cerr << "Could not load input log: " << options.replayFile << "\n";
+        return 1;
+    }
+
+    const unsigned WINDOW_W = 800, WINDOW_H = 600;
+    sf::RenderWindow window(sf::VideoMode(sf::Vector2u{WINDOW_W, WINDOW_H}), "Cube - Textured (Minecraft-like)",
+                            sf::Style::Default, sf::State::Windowed, sceneContextSettings());
+    window.setVerticalSyncEnabled(options.vsync);
+    FramePacer pacer;
+    pacer.configure(options.fps, options.lateInput, options.vsync);
+    InputLatencyMeter latency;
+
+    initGLState();
+    RenderPipeline pipeline;
+    if (!pipeline.init()) return 1;
+    Camera camera;
+
+    const auto assetsStart = std::chrono::steady_clock::now();
+    TextureAtlas atlas;
+    setupAtlas(atlas, bundle);
+    sf::Font hudFont;
+    bool haveFont = loadHudFont(hudFont, bundle);
+    const double assetMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - assetsStart).count();
+    std::printf("Assets loaded in %.1f ms from %s\n", assetMillis, bundle.isOpen() ? "the bundle" : "loose files");
+
+    // --- Block selection and terrain -----------------------------------
+    BlockId currentBlock = BLOCK_GRASS;
 
     // Terrain seed and generation (uses world module)
-    int terrainSeed = 123;
+    int terrainSeed = replaying ? static_cast<int>(replay.header().seed) : 123;
     generateTerrain(terrainSeed);
 
+    // Terrain sections are meshed on worker threads and uploaded within a per-frame budget
+    TerrainRenderer terrain;
+    terrain.allowIndirect(options.multiDrawIndirect);
+    terrain.setAtlas(atlas);
+    terrain.markAllDirty();
+    MeshUploadBudget uploadBudget;
+    bool terrainWasIdle = false; // pool stats are printed whenever a remesh finishes
+    std::cout << "Meshing on " << terrain.workerCount() << " worker thread(s)\n";
+
 
 
 
@@ -201,22 +402,13 @@ int main() {
     
 
     std::cout << "Controls: Arrow keys = rotate camera, W/S = zoom (or fly forward/back when Fly is ON), A/D/Q/E = pan (or strafe when Fly is ON), R = regenerate terrain (seed+1), M = random seed, 1/2 = select blocks, F = toggle Fly, C = toggle FPS, V = invert mouse\n"
-              << "T/Y = cycle top tile, G/H = cycle side tile, B/N = cycle dirt tile, +/- or PgUp/PgDn = adjust fly speed. ESC = exit.\n";
-
+              << "T/Y = cycle top tile, G/H = cycle side tile, B/N = cycle dirt tile, +/- or PgUp/PgDn = adjust fly speed, F9 = capture a trace. ESC = exit.\n";
 
-    // Camera (orbit) parameters
-    float camDistance = 5.0f;
-    float camYawDeg = 45.0f;
-    float camPitchDeg = -10.0f;
-    sf::Vector3f camCenter{0.f, 0.f, 0.f};
 
     // Mouse control state
     bool rotating = false;
     bool panning = false;
     sf::Vector2i lastMouse{0,0};
-    float mouseRotateSpeed = 0.25f; // degrees per pixel
-    float mousePanFactor = 0.01f;   // world units per pixel
-    float scrollZoomSpeed = 0.8f;   // units per scroll step
 
     std::cout << "Controls: Arrow keys = rotate camera, W/S = zoom, A/D/Q/E = pan, R = regenerate terrain, Space = random seed,\n"
                  "Mouse: Left-drag = rotate, Right-drag = pan, Scroll = zoom.\n"
@@ -229,12 +421,6 @@ int main() {
     int frameCount = 0;
     float fps = 0.f;
     float fpsAccum = 0.f;
-    sf::Font hudFont;
-    bool haveFont = false;
-    // try project font first (assets), else try system Arial
-if (hudFont.openFromFile("assets/arial.ttf") || hudFont.openFromFile("C:/Windows/Fonts/arial.ttf")){
-        haveFont = true;
-    }
     // Construct Text with font and character size (SFML3 requires arguments)
     sf::Text fpsText(hudFont, "", 16);
     if (haveFont){
@@ -242,75 +428,70 @@ if (hudFont.openFromFile("assets/arial.ttf") || hudFont.openFromFile("C:/Windows
         fpsText.setPosition(sf::Vector2f{6.f, 6.f});
     }
 
-    // Built-in 3x5 pixel digit font used when no TTF is available
-    static const unsigned char DIGITS[10][5] = {
-        {0b111,0b101,0b101,0b101,0b111}, //0
-        {0b010,0b110,0b010,0b010,0b111}, //1
-        {0b111,0b001,0b111,0b100,0b111}, //2
-        {0b111,0b001,0b111,0b001,0b111}, //3
-        {0b101,0b101,0b111,0b001,0b001}, //4
-        {0b111,0b100,0b111,0b001,0b111}, //5
-        {0b111,0b100,0b111,0b101,0b111}, //6
-        {0b111,0b001,0b010,0b010,0b010}, //7
-        {0b111,0b101,0b111,0b101,0b111}, //8
-        {0b111,0b101,0b111,0b001,0b111}  //9
-    };
-    auto drawBitmapText = [&](const std::string &s, int px, int py, int scale){
-        // draw using small rectangles via SFML shapes (push GL states first)
-        sf::RectangleShape rect(sf::Vector2f((float)scale, (float)scale));
-        int x = px;
-        for(char c : s){
-            if (c >= '0' && c <= '9'){
-                int d = c - '0';
-                for(int ry=0; ry<5; ++ry){
-                    unsigned row = DIGITS[d][ry];
-                    for(int rx=0; rx<3; ++rx){
-                        if (row & (1u << (2-rx))){
-                            rect.setPosition(sf::Vector2f{(float)(x + rx*scale), (float)(py + ry*scale)});
-                            rect.setFillColor(sf::Color::White);
-                            window.draw(rect);
-                        }
-                    }
-                }
-                x += (3 + 1) * scale;
-            } else {
-                // simple spacer for other chars
-                x += (3 + 1) * scale;
-            }
-        }
-    };
+    // Built-in pixel font HUD used when no TTF is available
+    BitmapHud bitmapHud;
 
-    // Fly / creative mode
-    bool flyMode = false;
-    float flySpeed = 6.0f; // units/sec
-    float flySpeedBoost = 2.5f; // multiplier for LCtrl
     bool showSpeed = true; // show speed on HUD
 
-    // FPS (first-person) mode
-    bool fpsMode = false;
-    sf::Vector3f playerPos{0.f, 2.f, 0.f};
-    float playerVy = 0.f;
-    bool canJump = false;
-    float gravity = 20.0f;
-    const float eyeHeight = 1.62f;
-    const float walkSpeed = 4.0f;
-    const float sprintMultiplier = 1.9f;
-    float mouseLookSpeed = 0.15f; // degrees per pixel-ish
-    float jumpSpeed = 6.5f; // upward impulse
-    bool invertMouse = false; // invert Y axis for mouse look (toggle V)
-    
+    // Camera, player and physics run on their own thread; this one handles
+    // window events and rendering from published snapshots.
+    SimState initialState;
+    initialState.terrainSeed = terrainSeed;
+    InputRecorder recorder;
+    const bool recording = !options.recordFile.empty();
+    if (recording){
+        InputLogHeader header;
+        header.seed = static_cast<uint32_t>(terrainSeed);
+        if (!recorder.open(options.recordFile, header)){
+            std::cerr << "Could not open input log for writing: " << options.recordFile << "\n";
+            return 1;
+        }
+        std::cout << "Recording input to " << options.recordFile << "\n";
+    }
+    if (replaying) std::cout << "Replaying " << options.replayFile << " (seed " << terrainSeed << ")\n";
+    SimulationThread sim(initialState, recording ? &recorder : nullptr, replaying ? &replay : nullptr);
+    uint32_t seenTerrainVersion = initialState.terrainVersion;
+    bool cursorCaptured = false;
+
     // Keep last mouse so we can re-center for FPS look
     sf::Vector2i fpsCenterMouse{0,0};
-
+    // FPS look prefers raw relative motion; platforms without it (macOS)
+    // fall back to re-centring the cursor every frame
+    bool rawMouseSeen = false;
+    sf::Vector2i lookDelta{0,0};
+
+    // HUD strings are formatted into the frame arena; the TTF text is only
+    // re-laid out when its contents change.
+    FrameArena frameArena;
+    char shownHudText[256] = "";
+    uint64_t allocsThisSecond = 0;
+    int allocFramesThisSecond = 0;
+    bool firstFrameShown = false;
+
+    // --trace captures the first frames; F9 captures the next ones at any time
+    TraceCapture trace;
+    if (!options.traceFile.empty()) trace.start(options.traceFile, options.traceFrames);
 
     while (window.isOpen()) {
-        // Events
+        TraceZone frameZone("frame");
+        {
+            TRACE_ZONE("wait for frame");
+            pacer.waitForFrameStart();
+        }
+        const auto frameStart = std::chrono::steady_clock::now();
+        frameArena.reset();
+        const uint64_t allocsAtFrameStart = threadAllocationCount();
+        const uint64_t postedAtFrameStart = sim.commandsPosted();
+        // Events: window-side effects happen here, game state changes go to the sim thread
+        TraceZone eventsZone("events");
         while (const auto eventOpt = window.pollEvent()){
             const auto &event = *eventOpt;
             if (event.is<sf::Event::Closed>()) window.close();
             if (event.is<sf::Event::KeyPressed>()){
                 auto kp = event.getIf<sf::Event::KeyPressed>();
                 if (kp->code == sf::Keyboard::Key::Escape) window.close();
+                if (kp->code == sf::Keyboard::Key::F9 && !trace.active())
+                    trace.start(options.traceFile.empty() ? "cube_trace.json" : options.traceFile, options.traceFrames);
                 // atlas tile cycling keys (only meaningful when atlas is loaded)
                 if (atlas.atlasLoaded){
                     if (kp->code == sf::Keyboard::Key::T){ atlas.TOP_TILE.x = (atlas.TOP_TILE.x + 1) % std::max(1, atlas.atlasCols); std::cout << "TOP tile = (" << atlas.TOP_TILE.x << "," << atlas.TOP_TILE.y << ")\n"; }
@@ -321,46 +502,36 @@ if (hudFont.openFromFile("assets/arial.ttf") || hudFont.openFromFile("C:/Windows
                     if (kp->code == sf::Keyboard::Key::N){ atlas.DIRT_TILE.y = (atlas.DIRT_TILE.y + 1) % std::max(1, atlas.atlasRows); std::cout << "DIRT tile = (" << atlas.DIRT_TILE.x << "," << atlas.DIRT_TILE.y << ")\n"; }
                 }
 
+                auto post = [&](SimAction a){ SimCommand c; c.action = a; sim.post(c); };
                 // Terrain and block controls
-                if (kp->code == sf::Keyboard::Key::R){ generateTerrain(terrainSeed + 1); }
-                if (kp->code == sf::Keyboard::Key::M){ std::random_device rd; generateTerrain(rd()); }
+                if (kp->code == sf::Keyboard::Key::R) post(SimAction::RegenerateNext);
+                if (kp->code == sf::Keyboard::Key::M){ std::random_device rd; SimCommand c; c.action = SimAction::Regenerate; c.seed = rd(); sim.post(c); }
                 // Jump when in FPS walking mode; otherwise Space was moved to M earlier
-                if (kp->code == sf::Keyboard::Key::Space){ if (fpsMode && !flyMode && canJump){ playerVy = jumpSpeed; canJump = false; } }
-                if (kp->code == sf::Keyboard::Key::F){ flyMode = !flyMode; std::cout << "Fly mode " << (flyMode ? "ON" : "OFF") << "\n"; }
+                if (kp->code == sf::Keyboard::Key::Space) post(SimAction::Jump);
+                if (kp->code == sf::Keyboard::Key::F) post(SimAction::ToggleFly);
                 // Mouse sensitivity +/-, jump speed U/J, gravity I/K, reset 0
-                if (kp->code == sf::Keyboard::Key::LBracket){ mouseLookSpeed = std::max(0.01f, mouseLookSpeed - 0.01f); std::cout << "Mouse sens = " << mouseLookSpeed << "\n"; }
-                if (kp->code == sf::Keyboard::Key::RBracket){ mouseLookSpeed = std::min(5.0f, mouseLookSpeed + 0.01f); std::cout << "Mouse sens = " << mouseLookSpeed << "\n"; }
-                if (kp->code == sf::Keyboard::Key::U){ jumpSpeed += 0.5f; std::cout << "Jump = " << jumpSpeed << "\n"; }
-                if (kp->code == sf::Keyboard::Key::J){ jumpSpeed = std::max(0.5f, jumpSpeed - 0.5f); std::cout << "Jump = " << jumpSpeed << "\n"; }
-                if (kp->code == sf::Keyboard::Key::I){ /* increase gravity */ const_cast<float&>(gravity) += 1.0f; std::cout << "Gravity = " << gravity << "\n"; }
-                if (kp->code == sf::Keyboard::Key::K){ const_cast<float&>(gravity) = std::max(0.1f, gravity - 1.0f); std::cout << "Gravity = " << gravity << "\n"; }
-                if (kp->code == sf::Keyboard::Key::Num0){ mouseLookSpeed = 0.15f; jumpSpeed = 6.5f; gravity = 20.0f; std::cout << "Tunables reset\n"; }
-                if (kp->code == sf::Keyboard::Key::V){ invertMouse = !invertMouse; std::cout << "Invert mouse " << (invertMouse ? "ON" : "OFF") << "\n"; }
-                if (kp->code == sf::Keyboard::Key::Equal || kp->code == sf::Keyboard::Key::Add || kp->code == sf::Keyboard::Key::PageUp){ flySpeed *= 1.1f; if (flySpeed > 100.f) flySpeed = 100.f; std::cout << "Fly speed = " << flySpeed << "\n"; }
-                if (kp->code == sf::Keyboard::Key::Hyphen || kp->code == sf::Keyboard::Key::Subtract || kp->code == sf::Keyboard::Key::PageDown){ flySpeed /= 1.1f; if (flySpeed < 0.01f) flySpeed = 0.01f; std::cout << "Fly speed = " << flySpeed << "\n"; }
+                if (kp->code == sf::Keyboard::Key::LBracket) post(SimAction::SensDown);
+                if (kp->code == sf::Keyboard::Key::RBracket) post(SimAction::SensUp);
+                if (kp->code == sf::Keyboard::Key::U) post(SimAction::JumpUp);
+                if (kp->code == sf::Keyboard::Key::J) post(SimAction::JumpDown);
+                if (kp->code == sf::Keyboard::Key::I) post(SimAction::GravityUp);
+                if (kp->code == sf::Keyboard::Key::K) post(SimAction::GravityDown);
+                if (kp->code == sf::Keyboard::Key::Num0) post(SimAction::ResetTunables);
+                if (kp->code == sf::Keyboard::Key::V) post(SimAction::ToggleInvert);
+                if (kp->code == sf::Keyboard::Key::Equal || kp->code == sf::Keyboard::Key::Add || kp->code == sf::Keyboard::Key::PageUp) post(SimAction::FlySpeedUp);
+                if (kp->code == sf::Keyboard::Key::Hyphen || kp->code == sf::Keyboard::Key::Subtract || kp->code == sf::Keyboard::Key::PageDown) post(SimAction::FlySpeedDown);
                 if (kp->code == sf::Keyboard::Key::C){
-                    fpsMode = !fpsMode;
+                    cursorCaptured = !cursorCaptured;
                     auto s = window.getSize();
                     fpsCenterMouse = sf::Vector2i{static_cast<int>(s.x/2), static_cast<int>(s.y/2)};
                     sf::Mouse::setPosition(fpsCenterMouse, window);
-                    window.setMouseCursorVisible(!fpsMode);
-                    window.setMouseCursorGrabbed(fpsMode);
-                    // set initial player position from camera center
-                    playerPos.x = camCenter.x;
-                    playerPos.z = camCenter.z;
-                    // place player above terrain
-                    int half = CHUNK/2;
-                    int xi = std::clamp(int(round(playerPos.x + half)), 0, CHUNK-1);
-                    int zi = std::clamp(int(round(playerPos.z + half)), 0, CHUNK-1);
-                    float groundY = static_cast<float>(getHeightAt(xi, zi)) + eyeHeight;
-                    // Ensure we spawn slightly above ground to avoid sticking
-                    if (playerPos.y < groundY + 0.5f) playerPos.y = groundY + 0.5f;
-                    playerVy = 0.f;
-                    canJump = true;
-                    std::cout << "FPS mode " << (fpsMode ? "ON" : "OFF") << "\n";
+                    window.setMouseCursorVisible(!cursorCaptured);
+                    window.setMouseCursorGrabbed(cursorCaptured);
+                    lookDelta = sf::Vector2i{0,0};
+                    post(SimAction::ToggleFps);
                 }
-                if (kp->code == sf::Keyboard::Key::Num1){ currentBlockIndex = 0; std::cout << "Selected block: " << blocks[currentBlockIndex].name << "\n"; }
-                if (kp->code == sf::Keyboard::Key::Num2){ if (blocks.size() > 1) { currentBlockIndex = 1; std::cout << "Selected block: " << blocks[currentBlockIndex].name << "\n"; } }
+                if (kp->code == sf::Keyboard::Key::Num1){ currentBlock = BLOCK_DIRT; std::cout << "Selected block: " << blockType(currentBlock).name << "\n"; }
+                if (kp->code == sf::Keyboard::Key::Num2){ currentBlock = BLOCK_GRASS; std::cout << "Selected block: " << blockType(currentBlock).name << "\n"; }
             } else if (event.is<sf::Event::MouseButtonPressed>()){
                 auto mb = event.getIf<sf::Event::MouseButtonPressed>();
                 if (mb->button == sf::Mouse::Button::Left){ rotating = true; lastMouse = sf::Mouse::getPosition(window); }
@@ -370,34 +541,72 @@ if (hudFont.openFromFile("assets/arial.ttf") || hudFont.openFromFile("C:/Windows
                 if (mb->button == sf::Mouse::Button::Left) rotating = false;
                 if (mb->button == sf::Mouse::Button::Right) panning = false;
             } else if (event.is<sf::Event::MouseMoved>()){
-                // In FPS mode we don't use event-driven mouse moves; we poll relative to center each frame.
-                if (fpsMode) {
-                    // ignore
-                } else {
+                // In FPS mode look comes from raw motion (or re-centring) instead.
+                if (!cursorCaptured) {
                     // Use global mouse position (safer API across SFML versions)
                     sf::Vector2i cur = sf::Mouse::getPosition(window);
                     sf::Vector2i d = cur - lastMouse;
                     lastMouse = cur;
-                    if (rotating){
-                        float sign = invertMouse ? -1.f : 1.f;
-                        camYawDeg += static_cast<float>(d.x) * mouseRotateSpeed * sign;
-                        camPitchDeg += static_cast<float>(d.y) * mouseRotateSpeed * sign;
-                        if (camPitchDeg > 89.f) camPitchDeg = 89.f;
-                        if (camPitchDeg < -89.f) camPitchDeg = -89.f;
-                    }
-                    if (panning){
-                        float panFactor = mousePanFactor * camDistance;
-                        camCenter.x -= static_cast<float>(d.x) * panFactor;
-                        camCenter.y += static_cast<float>(d.y) * panFactor;
-                    }
+                    SimCommand c; c.x = static_cast<float>(d.x); c.y = static_cast<float>(d.y);
+                    if (rotating){ c.action = SimAction::OrbitRotate; sim.post(c); }
+                    if (panning){ c.action = SimAction::OrbitPan; sim.post(c); }
+                }
+            } else if (event.is<sf::Event::MouseMovedRaw>()){
+                // device motion, unaffected by the cursor being clamped or re-centred;
+                // summed so a frame posts one look command however many events arrive
+                if (cursorCaptured){
+                    rawMouseSeen = true;
+                    lookDelta += event.getIf<sf::Event::MouseMovedRaw>()->delta;
                 }
             } else if (event.is<sf::Event::MouseWheelScrolled>()){
                 auto ws = event.getIf<sf::Event::MouseWheelScrolled>();
-                camDistance -= ws->delta * scrollZoomSpeed;
-                if (camDistance < 1.f) camDistance = 1.f;
+                SimCommand c; c.action = SimAction::Zoom; c.x = ws->delta;
+                sim.post(c);
             }
         }
 
+        // Sample held keys for the simulation thread
+        uint32_t heldKeys = 0;
+        const std::pair<sf::Keyboard::Key, uint32_t> keyMap[] = {
+            {sf::Keyboard::Key::W, KEY_W}, {sf::Keyboard::Key::A, KEY_A}, {sf::Keyboard::Key::S, KEY_S}, {sf::Keyboard::Key::D, KEY_D},
+            {sf::Keyboard::Key::Q, KEY_Q}, {sf::Keyboard::Key::E, KEY_E}, {sf::Keyboard::Key::Space, KEY_SPACE},
+            {sf::Keyboard::Key::LShift, KEY_LSHIFT}, {sf::Keyboard::Key::LControl, KEY_LCONTROL},
+            {sf::Keyboard::Key::Left, KEY_LEFT}, {sf::Keyboard::Key::Right, KEY_RIGHT}, {sf::Keyboard::Key::Up, KEY_UP}, {sf::Keyboard::Key::Down, KEY_DOWN}
+        };
+        for (const auto &k : keyMap) if (sf::Keyboard::isKeyPressed(k.first)) heldKeys |= k.second;
+        sim.setHeldKeys(heldKeys);
+
+        if (cursorCaptured){
+            if (!rawMouseSeen){
+                // no raw motion: read cursor delta relative to center and re-center every frame
+                auto sz = window.getSize();
+                sf::Vector2i center{static_cast<int>(sz.x/2), static_cast<int>(sz.y/2)};
+                lookDelta += sf::Mouse::getPosition(window) - center;
+                sf::Mouse::setPosition(center, window);
+            }
+            if (lookDelta.x != 0 || lookDelta.y != 0){
+                SimCommand c; c.action = SimAction::Look; c.x = static_cast<float>(lookDelta.x); c.y = static_cast<float>(lookDelta.y);
+                sim.post(c);
+                lookDelta = sf::Vector2i{0,0};
+            }
+        }
+        if (options.measureLatency && sim.commandsPosted() != postedAtFrameStart)
+            latency.inputPosted(sim.commandsPosted(), frameStart);
+        eventsZone.end();
+
+        // Render from the newest published simulation snapshot
+        const SimSnapshot &snap = sim.latest();
+        const SimState &st = snap.state;
+        if (replaying && sim.replayFinished()){
+            std::cout << "Replay end state: tick " << snap.tick << " eye (" << st.playerPos.x << ", " << st.playerPos.y << ", " << st.playerPos.z << ")"
+                      << " yaw " << st.camYawDeg << " pitch " << st.camPitchDeg << "\n";
+            window.close();
+        }
+        if (st.terrainVersion != seenTerrainVersion){
+            seenTerrainVersion = st.terrainVersion;
+            terrain.markAllDirty();
+        }
+
         float dt = clock.restart().asSeconds();
         angle += 30.f * dt; // cube self-rotation
 
@@ -408,342 +617,90 @@ if (hudFont.openFromFile("assets/arial.ttf") || hudFont.openFromFile("C:/Windows
             fps = static_cast<float>(frameCount) / fpsAccum;
             frameCount = 0;
             fpsAccum = 0.f;
-            char buf[256];
-            snprintf(buf, sizeof(buf), "Cube - Textured (Minecraft-like) - FPS: %.0f%s", fps, (flyMode ? " - FLY" : ""));
-            window.setTitle(buf);
-            if (haveFont) fpsText.setString(std::to_string(static_cast<int>(fps)) + " FPS");
-        }
-
-        // Handle continuous camera controls (keyboard held)
-        const float yawSpeed = 90.f; // deg/sec
-        const float pitchSpeed = 80.f; // deg/sec
-        const float zoomSpeed = 3.f; // units/sec
-        const float panSpeed = 2.f; // units/sec
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left)) camYawDeg -= yawSpeed * dt;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right)) camYawDeg += yawSpeed * dt;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up)) camPitchDeg += pitchSpeed * dt;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down)) camPitchDeg -= pitchSpeed * dt;
-        if (fpsMode){
-            // FPS mouse look: read cursor delta relative to center and re-center every frame
-            auto sz = window.getSize();
-            sf::Vector2i center{static_cast<int>(sz.x/2), static_cast<int>(sz.y/2)};
-            sf::Vector2i cur = sf::Mouse::getPosition(window);
-            sf::Vector2i d = cur - center;
-            // always reset mouse to center so we can get relative movement next frame
-            sf::Mouse::setPosition(center, window);
-            if (d.x != 0 || d.y != 0){
-                float sign = invertMouse ? -1.f : 1.f;
-                camYawDeg += static_cast<float>(d.x) * mouseLookSpeed * sign;
-                camPitchDeg += static_cast<float>(d.y) * mouseLookSpeed * sign;
-                if (camPitchDeg > 89.f) camPitchDeg = 89.f;
-                if (camPitchDeg < -89.f) camPitchDeg = -89.f;
-            }
-
-            // Movement on XZ plane for walking
-            float yawR = camYawDeg * 3.14159265f / 180.f;
-            sf::Vector3f forwardXZ{ sinf(yawR), 0.f, cosf(yawR) };
-            sf::Vector3f rightXZ{ forwardXZ.z, 0.f, -forwardXZ.x };
-            float fwd=0.f, rgt=0.f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) fwd += 1.f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) fwd -= 1.f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) rgt += 1.f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) rgt -= 1.f;
-            // invert strafing when invertMouse is set
-            rgt *= (invertMouse ? -1.f : 1.f);
-            float speed = walkSpeed;
-            bool sprinting = false;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LShift)) { speed *= sprintMultiplier; sprinting = true; }
-
-            if (flyMode){
-                // Fly-style FPS (no gravity), include pitch for forward/back
-                float pitchR = camPitchDeg * 3.14159265f / 180.f;
-                sf::Vector3f forward{ sinf(yawR) * cosf(pitchR), sinf(pitchR), cosf(yawR) * cosf(pitchR) };
-                sf::Vector3f right{ forward.y*0.f - forward.z*0.f, forward.z*1.f - forward.x*0.f, forward.x*0.f - forward.y*1.f };
-                float upf = 0.f;
-                if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space)) upf += 1.f;
-                if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl)) upf -= 1.f;
-                sf::Vector3f delta = sf::Vector3f{ forward.x * fwd + right.x * rgt, forward.y * fwd + upf, forward.z * fwd + right.z * rgt };
-                playerPos.x += delta.x * speed * dt;
-                playerPos.y += delta.y * speed * dt;
-                playerPos.z += delta.z * speed * dt;
-            } else {
-                // walking with gravity and simple block collision
-                sf::Vector3f delta = sf::Vector3f{ forwardXZ.x * fwd + rightXZ.x * rgt, 0.f, forwardXZ.z * fwd + rightXZ.z * rgt };
-                float moveX = delta.x * speed * dt;
-                float moveZ = delta.z * speed * dt;
-                float oldX = playerPos.x;
-                float oldZ = playerPos.z;
-
-                // attempt X movement
-                playerPos.x += moveX;
-                int half = CHUNK/2;
-                int xi = std::clamp(int(round(playerPos.x + half)), 0, CHUNK-1);
-                int zi = std::clamp(int(round(playerPos.z + half)), 0, CHUNK-1);
-                float footY = playerPos.y - eyeHeight;
-                if (getHeightAt(xi, zi) > footY + 0.2f){ // blocked
-                    playerPos.x = oldX; // rollback X
-                }
-
-                // attempt Z movement
-                playerPos.z += moveZ;
-                xi = std::clamp(int(round(playerPos.x + half)), 0, CHUNK-1);
-                zi = std::clamp(int(round(playerPos.z + half)), 0, CHUNK-1);
-                if (getHeightAt(xi, zi) > footY + 0.2f){ // blocked
-                    playerPos.z = oldZ; // rollback Z
-                }
-
-                // Apply gravity
-                playerVy -= gravity * dt;
-                playerPos.y += playerVy * dt;
-
-                // ground collision
-                xi = std::clamp(int(round(playerPos.x + half)), 0, CHUNK-1);
-                zi = std::clamp(int(round(playerPos.z + half)), 0, CHUNK-1);
-                float groundY = static_cast<float>(getHeightAt(xi, zi)) + eyeHeight;
-                if (playerPos.y <= groundY){
-                    playerPos.y = groundY;
-                    playerVy = 0.f;
-                    canJump = true;
-                }
-            }
-        } else if (!flyMode){
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) camDistance -= zoomSpeed * dt;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) camDistance += zoomSpeed * dt;
-            float hSign = invertMouse ? -1.f : 1.f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) camCenter.x -= panSpeed * dt * hSign;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) camCenter.x += panSpeed * dt * hSign;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Q)) camCenter.y += panSpeed * dt;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::E)) camCenter.y -= panSpeed * dt;
-        } else {
-            // Fly movement: W/S forward/back, A/D strafe, Space up, LShift down
-            float yawR = camYawDeg * 3.14159265f / 180.f;
-            float pitchR = camPitchDeg * 3.14159265f / 180.f;
-            sf::Vector3f forward{ sinf(yawR) * cosf(pitchR), sinf(pitchR), cosf(yawR) * cosf(pitchR) };
-            sf::Vector3f upVec{0.f,1.f,0.f};
-            sf::Vector3f right{ forward.y*upVec.z - forward.z*upVec.y, forward.z*upVec.x - forward.x*upVec.z, forward.x*upVec.y - forward.y*upVec.x };
-            auto normalize3 = [](sf::Vector3f v)->sf::Vector3f{ float l = sqrtf(v.x*v.x+v.y*v.y+v.z*v.z); if (l==0.f) return v; return sf::Vector3f{v.x/l, v.y/l, v.z/l}; };
-            forward = normalize3(forward);
-            right = normalize3(right);
-            float fwd=0.f, rgt=0.f, upf=0.f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) fwd += 1.f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) fwd -= 1.f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) rgt += 1.f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) rgt -= 1.f;
-            // invert strafe when invertMouse is set
-            rgt *= (invertMouse ? -1.f : 1.f);
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space)) upf += 1.f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LShift)) upf -= 1.f;
-            float speed = flySpeed;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl)) speed *= flySpeedBoost;
-            sf::Vector3f delta{ forward.x * fwd + right.x * rgt, forward.y * fwd + right.y * rgt + upf, forward.z * fwd + right.z * rgt };
-            camCenter.x += delta.x * speed * dt;
-            camCenter.y += delta.y * speed * dt;
-            camCenter.z += delta.z * speed * dt;
+            TextBuilder title(frameArena, 128);
+            title.add("Cube - Textured (Minecraft-like) - FPS: ").addInt(std::lround(fps)).add(st.flyMode ? " - FLY" : "");
+            window.setTitle(title.c_str());
+#if CUBE_COUNT_ALLOCATIONS
+            if (allocsThisSecond > 0)
+                std::cout << "[alloc] " << allocsThisSecond << " heap allocations in " << allocFramesThisSecond << " frames during the last second\n";
+            allocsThisSecond = 0;
+            allocFramesThisSecond = 0;
+#endif
+            if (options.measureLatency) latency.report();
         }
-        // clamp
-        if (camDistance < 1.0f) camDistance = 1.0f;
-        if (camPitchDeg > 89.f) camPitchDeg = 89.f;
-        if (camPitchDeg < -89.f) camPitchDeg = -89.f;
 
         // Prepare viewport & perspective projection
         auto size = window.getSize();
         int w = static_cast<int>(size.x);
         int h = static_cast<int>(size.y);
-        float aspect = static_cast<float>(w) / static_cast<float>(h);
-
-        glViewport(0, 0, w, h);
-        glMatrixMode(GL_PROJECTION);
-        glLoadIdentity();
-        const float fov = 60.f;
-        const float znear = 0.1f;
-        const float zfar = 100.f;
-        float top = znear * tanf(fov * 3.14159265f / 360.f);
-        float right = top * aspect;
-        glFrustum(-right, right, -top, top, znear, zfar);
-
-        // Camera (view) matrix - compute lookAt and load it into MODELVIEW
-        glMatrixMode(GL_MODELVIEW);
-        glLoadIdentity();
-        // compute eye position and center from either orbit or FPS mode
-        float yawRad = camYawDeg * 3.14159265f / 180.f;
-        float pitchRad = camPitchDeg * 3.14159265f / 180.f;
-        sf::Vector3f eye;
-        sf::Vector3f center;
-        if (!fpsMode){
-            float ex = camCenter.x + camDistance * cosf(pitchRad) * sinf(yawRad);
-            float ey = camCenter.y + camDistance * sinf(pitchRad);
-            float ez = camCenter.z + camDistance * cosf(pitchRad) * cosf(yawRad);
-            eye = sf::Vector3f{ex, ey, ez};
-            center = sf::Vector3f{camCenter};
-        } else {
-            // First-person: eye is player position, center is position + forward vector
-            eye = playerPos;
-            float fx = sinf(yawRad) * cosf(pitchRad);
-            float fy = sinf(pitchRad);
-            float fz = cosf(yawRad) * cosf(pitchRad);
-            center = sf::Vector3f{eye.x + fx, eye.y + fy, eye.z + fz};
+        renderScene(st, w, h, camera, pipeline, terrain, atlas, uploadBudget);
+        if (terrain.idle() != terrainWasIdle){
+            terrainWasIdle = terrain.idle();
+            if (terrainWasIdle) printPoolStats(terrain);
         }
 
-        // lookAt matrix
-        auto normalize = [](sf::Vector3f v){
-            float l = sqrtf(v.x*v.x + v.y*v.y + v.z*v.z);
-            if (l==0) return v;
-            return sf::Vector3f{v.x/l, v.y/l, v.z/l};
-        };
-        sf::Vector3f f = center - eye; f = normalize(f);
-        sf::Vector3f up{0.f,1.f,0.f};
-        sf::Vector3f s{f.y*up.z - f.z*up.y, f.z*up.x - f.x*up.z, f.x*up.y - f.y*up.x}; // cross(f,up)
-        s = normalize(s);
-        sf::Vector3f u{ s.y*f.z - s.z*f.y, s.z*f.x - s.x*f.z, s.x*f.y - s.y*f.x };
-        float m[16] = {
-            s.x, u.x, -f.x, 0.f,
-            s.y, u.y, -f.y, 0.f,
-            s.z, u.z, -f.z, 0.f,
-            - (s.x*eye.x + s.y*eye.y + s.z*eye.z), - (u.x*eye.x + u.y*eye.y + u.z*eye.z), (f.x*eye.x + f.y*eye.y + f.z*eye.z), 1.f
-        };
-        glLoadMatrixf(m);
-
-        // Clear
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // Draw Sun (Skybox style - rotation only)
-        {
-            glPushMatrix();
-            // Remove translation from view matrix to make sun infinite
-            float viewM[16];
-            glGetFloatv(GL_MODELVIEW_MATRIX, viewM);
-            viewM[12] = 0.f; viewM[13] = 0.f; viewM[14] = 0.f;
-            glLoadMatrixf(viewM);
-
-            glDisable(GL_TEXTURE_2D);
-            glDisable(GL_DEPTH_TEST);
-            
-            // Sun direction: Fixed (e.g. Noon or late afternoon)
-            sf::Vector3f sunDir = {0.3f, 0.8f, -0.2f};
-            float sl = sqrt(sunDir.x*sunDir.x + sunDir.y*sunDir.y + sunDir.z*sunDir.z);
-            sunDir = {sunDir.x/sl, sunDir.y/sl, sunDir.z/sl};
-            
-            float sunDist = 80.0f; // Push it out further
-            float sunSize = 12.0f; // Make it bigger
-            sf::Vector3f sunPos = {sunDir.x * sunDist, sunDir.y * sunDist, sunDir.z * sunDist};
-            
-            glTranslatef(sunPos.x, sunPos.y, sunPos.z);
-            
-            // Billboard rotation: Face the origin
-            sf::Vector3f f = {-sunDir.x, -sunDir.y, -sunDir.z}; // forward
-            sf::Vector3f up = {0.f, 1.f, 0.f};
-            if (std::abs(f.y) > 0.99f) up = {1.f, 0.f, 0.f}; // Gimbal lock fix
-            sf::Vector3f r = {up.y*f.z - up.z*f.y, up.z*f.x - up.x*f.z, up.x*f.y - up.y*f.x}; // right
-            float rl = sqrt(r.x*r.x + r.y*r.y + r.z*r.z); r = {r.x/rl, r.y/rl, r.z/rl};
-            sf::Vector3f u = {f.y*r.z - f.z*r.y, f.z*r.x - f.x*r.z, f.x*r.y - f.y*r.x}; // up
-            
-            float lookMat[16] = {
-                r.x, r.y, r.z, 0.f,
-                u.x, u.y, u.z, 0.f,
-                f.x, f.y, f.z, 0.f,
-                0.f, 0.f, 0.f, 1.f
-            };
-            glMultMatrixf(lookMat);
-
-            glColor3f(1.0f, 1.0f, 0.0f);
-            
-            glBegin(GL_QUADS);
-                glVertex3f(-sunSize, -sunSize, 0.f);
-                glVertex3f( sunSize, -sunSize, 0.f);
-                glVertex3f( sunSize,  sunSize, 0.f);
-                glVertex3f(-sunSize,  sunSize, 0.f);
-            glEnd();
-            
-            glEnable(GL_DEPTH_TEST);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-
-        // Render terrain grid of blocks
-        glColor3f(1,1,1);
-        glPushMatrix();
-            const int half = CHUNK/2;
-
-            if (terrainDirty || terrainDL == 0) {
-                if (terrainDL == 0) terrainDL = glGenLists(1);
-                glNewList(terrainDL, GL_COMPILE);
-                
-                // If atlas is loaded, bind it ONCE here to optimize (though drawBlockAt rebinds, 
-                // but at least we can try to minimize if we refactored, but DL handles this anyway)
-                // Actually, since drawBlockAt binds texture, we can't easily optimize the bind 
-                // without changing drawBlockAt. But DL should record the binds.
-                // NOTE: If we wanted to really optimize, we'd batch geometry by texture.
-                // But DL is good enough for this.
-                
-                for(int xi=0; xi<CHUNK; ++xi){
-                    for(int zi=0; zi<CHUNK; ++zi){
-                        int h = getHeightAt(xi, zi);
-                        for(int yi=0; yi<h; ++yi){
-                            // Determine block type based on depth
-                            // Top level: Grass (index 1)
-                            // Next 3 levels: Dirt (index 0)
-                            // Deeper: Stone (index 2) - check if Stone exists
-                            const Block* bPtr = &blocks[0];
-                            if (yi == h-1) bPtr = &blocks[1];
-                            else if (yi >= h-4) bPtr = &blocks[0];
-                            else if (blocks.size() > 2) bPtr = &blocks[2];
-                            
-                            const Block &b = *bPtr;
-                            float gx = static_cast<float>(xi - half);
-                            float gz = static_cast<float>(zi - half);
-                            float gy = static_cast<float>(yi);
-
-                            int mask = 0;
-                            if (yi == h-1) mask |= FACE_TOP;
-                            if (yi == 0) mask |= FACE_BOTTOM;
-                            if (isAirAt(xi, zi+1, yi)) mask |= FACE_FRONT;
-                            if (isAirAt(xi, zi-1, yi)) mask |= FACE_BACK;
-                            if (isAirAt(xi+1, zi, yi)) mask |= FACE_RIGHT;
-                            if (isAirAt(xi-1, zi, yi)) mask |= FACE_LEFT;
-
-                            if (mask == 0) continue; // block fully surrounded
-                            drawBlockAt(gx, gy, gz, b, mask, atlas);
-                        }
-                    }
-                }
-                glEndList();
-                terrainDirty = false;
-            }
-            glCallList(terrainDL);
-        glPopMatrix();
-
         // Draw HUD overlay
+        TraceZone hudZone("hud");
         window.pushGLStates();
         // Build status strings
-        std::string modeStr = "Orbit";
-        if (fpsMode) modeStr = flyMode ? "FPS-Fly" : "FPS-Walk";
-        else if (flyMode) modeStr = "Creative-Fly";
-        std::string sprintStr = (fpsMode && sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LShift)) ? "SPRINT" : "";
+        const char *modeStr = "Orbit";
+        if (st.fpsMode) modeStr = st.flyMode ? "FPS-Fly" : "FPS-Walk";
+        else if (st.flyMode) modeStr = "Creative-Fly";
+        const char *sprintStr = st.sprinting ? "SPRINT" : "";
         if (haveFont){
             // show FPS, mode, sprint and optionally speed
-            char buf[256];
-            if (showSpeed) snprintf(buf, sizeof(buf), "%d FPS  | %s %s  | speed=%d  | sens=%.2f jump=%.1f grav=%.1f  | invert=%s", static_cast<int>(fps), modeStr.c_str(), sprintStr.c_str(), static_cast<int>(roundf(flySpeed)), mouseLookSpeed, jumpSpeed, gravity, (invertMouse ? "ON" : "OFF"));
-            else snprintf(buf, sizeof(buf), "%d FPS  | %s %s  | sens=%.2f jump=%.1f grav=%.1f  | invert=%s", static_cast<int>(fps), modeStr.c_str(), sprintStr.c_str(), mouseLookSpeed, jumpSpeed, gravity, (invertMouse ? "ON" : "OFF"));
-            fpsText.setString(buf);
+            TextBuilder hud(frameArena, sizeof(shownHudText));
+            hud.addInt(static_cast<int>(fps)).add(" FPS  | ").add(modeStr).add(' ').add(sprintStr);
+            if (showSpeed) hud.add("  | speed=").addInt(static_cast<int>(roundf(st.flySpeed)));
+            hud.add("  | sens=").addFixed(st.mouseLookSpeed, 2).add(" jump=").addFixed(st.jumpSpeed, 1).add(" grav=").addFixed(st.gravity, 1)
+               .add("  | invert=").add(st.invertMouse ? "ON" : "OFF");
+            if (std::strcmp(hud.c_str(), shownHudText) != 0){
+                std::memcpy(shownHudText, hud.c_str(), hud.size() + 1);
+                fpsText.setString(shownHudText);
+            }
             window.draw(fpsText);
         } else {
-            // Draw numeric FPS and mode using built-in bitmap font
-            std::string fpsstr = std::to_string(static_cast<int>(fps));
-            drawBitmapText(fpsstr, 8, 8, 2);
-            std::string m2 = modeStr + (sprintStr.empty() ? std::string() : " ") + sprintStr;
-            drawBitmapText(m2, 8, 22, 2);
-            if (showSpeed){
-                std::string s2 = "spd:" + std::to_string(static_cast<int>(roundf(flySpeed)));
-                drawBitmapText(s2, 8, 36, 2);
-            }
-            // invert status
-            std::string invs = std::string("invert:") + (invertMouse ? "ON" : "OFF");
-            drawBitmapText(invs, 8, 50, 2);
+            // FPS, mode, speed and invert status with the built-in bitmap font, one draw call
+            TextBuilder line(frameArena, BitmapHud::MAX_CHARS + 1);
+            line.addInt(static_cast<int>(fps)).add(" FPS");
+            bitmapHud.setLine(0, line.c_str(), {8.f, 8.f}, 2.f);
+            line.clear();
+            line.add(modeStr);
+            if (*sprintStr) line.add(' ').add(sprintStr);
+            bitmapHud.setLine(1, line.c_str(), {8.f, 22.f}, 2.f);
+            line.clear();
+            if (showSpeed) line.add("spd:").addInt(static_cast<int>(roundf(st.flySpeed)));
+            bitmapHud.setLine(2, line.c_str(), {8.f, 36.f}, 2.f);
+            line.clear();
+            line.add("invert:").add(st.invertMouse ? "ON" : "OFF");
+            bitmapHud.setLine(3, line.c_str(), {8.f, 50.f}, 2.f);
+            bitmapHud.draw(window);
         }
         window.popGLStates();
+        hudZone.end();
+
+        pacer.renderFinished();
+        {
+            TRACE_ZONE("display");
+            window.display();
+            if (options.measureLatency){
+                glFinish(); // display() can return before the swap has happened
+                latency.framePresented(snap.commandsConsumed, frameStart, std::chrono::steady_clock::now());
+            }
+        }
+        pacer.framePresented();
+        if (!firstFrameShown){
+            firstFrameShown = true;
+            std::printf("First frame %.1f ms after launch\n", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launched).count());
+        }
 
-        window.display();
+        const uint64_t frameAllocs = threadAllocationCount() - allocsAtFrameStart;
+        allocsThisSecond += frameAllocs;
+        if (frameAllocs) ++allocFramesThisSecond;
+        frameZone.end();
+        trace.frameEnd();
     }
+    trace.finish(); // closed mid-capture: keep what was recorded
 
     return 0;
 }
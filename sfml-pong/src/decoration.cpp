@@ -0,0 +1,170 @@
+#include "decoration.h"
+#include "world.h"
+#include <algorithm>
+
+// Feature kinds, in the order they win overlaps (the top byte of a rank)
+enum : uint32_t { RANK_LEAVES = 1u << 24, RANK_BOULDER = 2u << 24, RANK_LOG = 3u << 24 };
+
+static const int MAX_TREES = 3;     // per chunk
+static const int BOULDER_ODDS = 4;  // one chunk in this many has a boulder
+
+static uint32_t featureHash(unsigned seed, int x, int z, uint32_t salt){
+    uint64_t h = (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) ^ static_cast<uint32_t>(z);
+    h ^= (static_cast<uint64_t>(seed) << 17) ^ (static_cast<uint64_t>(salt) * 0x9e3779b97f4a7c15ull);
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return static_cast<uint32_t>(h);
+}
+
+static int groundHeight(unsigned seed, int x, int z){
+    return std::min(CHUNK_HEIGHT, terrainHeight(seed, x, z));
+}
+
+void ChunkDecorator::plan(ChunkPos origin, std::vector<std::pair<ChunkPos, Placement>> &out) const{
+    auto put = [&](int x, int y, int z, BlockId id, uint32_t rank, bool overwrite){
+        if (y < 0 || y >= CHUNK_HEIGHT) return;
+        Placement p;
+        p.index = static_cast<uint16_t>(Chunk::index(floorMod(x, CHUNK_SIZE), y, floorMod(z, CHUNK_SIZE)));
+        p.id = id;
+        p.overwrite = overwrite;
+        p.rank = rank;
+        out.push_back({chunkOf(x, z), p});
+    };
+    const int x0 = origin.x * CHUNK_SIZE, z0 = origin.z * CHUNK_SIZE;
+
+    // trees: a trunk of 4-6 logs under a rounded crown of leaves
+    const int trees = featureHash(seed_, origin.x, origin.z, 0) % (MAX_TREES + 1);
+    for (int t = 0; t < trees; ++t){
+        const uint32_t h = featureHash(seed_, origin.x, origin.z, 1 + t);
+        const int x = x0 + static_cast<int>(h % CHUNK_SIZE), z = z0 + static_cast<int>((h >> 4) % CHUNK_SIZE);
+        const int ground = groundHeight(seed_, x, z);
+        const int trunk = 4 + static_cast<int>((h >> 8) % 3);
+        const int top = ground + trunk - 1;
+        const uint32_t tag = (h >> 8) & 0xffffff;
+        for (int y = ground; y <= top; ++y) put(x, y, z, BLOCK_LOG, RANK_LOG | tag, false);
+        for (int dy = -2; dy <= 1; ++dy){
+            const int r = dy < 0 ? 2 : 1;
+            for (int dz = -r; dz <= r; ++dz)
+                for (int dx = -r; dx <= r; ++dx){
+                    if (dx == 0 && dz == 0 && dy <= 0) continue; // trunk
+                    const bool corner = (dx == -r || dx == r) && (dz == -r || dz == r);
+                    if (corner && (dy == 1 || (featureHash(seed_, x + dx, z + dz, top + dy) & 1))) continue;
+                    put(x + dx, top + dy, z + dz, BLOCK_LEAVES, RANK_LEAVES | tag, false);
+                }
+        }
+    }
+
+    // boulder: a half-buried ball of cobblestone
+    const uint32_t b = featureHash(seed_, origin.x, origin.z, 100);
+    if (b % BOULDER_ODDS == 0){
+        const int x = x0 + static_cast<int>((b >> 4) % CHUNK_SIZE), z = z0 + static_cast<int>((b >> 8) % CHUNK_SIZE);
+        const int y = groundHeight(seed_, x, z);
+        const int r = 1 + static_cast<int>((b >> 12) % 2);
+        const uint32_t tag = (b >> 8) & 0xffffff;
+        for (int dy = -r; dy <= r; ++dy)
+            for (int dz = -r; dz <= r; ++dz)
+                for (int dx = -r; dx <= r; ++dx)
+                    if (dx*dx + dy*dy + dz*dz <= r*r + 1) put(x + dx, y + dy, z + dz, BLOCK_COBBLE, RANK_BOULDER | tag, true);
+    }
+}
+
+void ChunkDecorator::decorate(Chunk &c){
+    std::vector<Placement> mine;
+    std::vector<std::pair<ChunkPos, Placement>> blocks;
+    bool again;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        again = decorated.count(c.pos) != 0;
+        if (!again){
+            // plan the neighbourhood (under the lock, so a neighbour decorating
+            // concurrently never sees an origin planned but not yet queued)
+            for (int dz = -1; dz <= 1; ++dz)
+                for (int dx = -1; dx <= 1; ++dx){
+                    const ChunkPos o{c.pos.x + dx, c.pos.z + dz};
+                    if (!planned.insert(o).second) continue;
+                    blocks.clear();
+                    plan(o, blocks);
+                    for (const auto &b : blocks){
+                        if (decorated.count(b.first)) continue; // loaded from storage with it
+                        queue[b.first].push_back(b.second);
+                        ++queued;
+                    }
+                }
+            auto it = queue.find(c.pos);
+            if (it != queue.end()){
+                mine = std::move(it->second);
+                queued -= mine.size();
+                queue.erase(it);
+            }
+            decorated.insert(c.pos);
+        }
+    }
+    if (again){
+        for (int dz = -1; dz <= 1; ++dz)
+            for (int dx = -1; dx <= 1; ++dx){
+                blocks.clear();
+                plan({c.pos.x + dx, c.pos.z + dz}, blocks);
+                for (const auto &b : blocks) if (b.first == c.pos) mine.push_back(b.second);
+            }
+    }
+
+    // one winner per block, judged against the bare terrain, so the order
+    // placements arrived in cannot matter
+    std::sort(mine.begin(), mine.end(), [](const Placement &a, const Placement &b){
+        return a.index != b.index ? a.index < b.index : a.rank > b.rank;
+    });
+    for (size_t i = 0; i < mine.size(); ++i){
+        if (i > 0 && mine[i].index == mine[i - 1].index) continue;
+        const Placement &p = mine[i];
+        if (p.overwrite || c.blocks.get(p.index) == BLOCK_AIR) c.blocks.set(p.index, p.id);
+    }
+}
+
+void ChunkDecorator::markDecorated(ChunkPos p){
+    std::lock_guard<std::mutex> lock(mutex);
+    decorated.insert(p);
+    auto it = queue.find(p);
+    if (it != queue.end()){
+        queued -= it->second.size();
+        queue.erase(it);
+    }
+}
+
+void ChunkDecorator::forget(ChunkPos p){
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!decorated.erase(p)) return;
+    // a fresh decorate() only replans origins not in `planned`, so every
+    // origin reaching into p has to be planned again when p comes back
+    for (int dz = -1; dz <= 1; ++dz)
+        for (int dx = -1; dx <= 1; ++dx) planned.erase({p.x + dx, p.z + dz});
+    // blocks of an unplanned origin come again when it is replanned, so a
+    // queue with no planned origin left around it only holds duplicates
+    for (int dz = -2; dz <= 2; ++dz)
+        for (int dx = -2; dx <= 2; ++dx){
+            const ChunkPos q{p.x + dx, p.z + dz};
+            auto it = queue.find(q);
+            if (it == queue.end()) continue;
+            bool live = false;
+            for (int oz = -1; oz <= 1 && !live; ++oz)
+                for (int ox = -1; ox <= 1 && !live; ++ox) live = planned.count({q.x + ox, q.z + oz}) != 0;
+            if (live) continue;
+            queued -= it->second.size();
+            queue.erase(it);
+        }
+}
+
+size_t ChunkDecorator::trackedChunks() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    return planned.size() + decorated.size();
+}
+
+size_t ChunkDecorator::queuedBlocks() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queued;
+}
+
+size_t ChunkDecorator::queuedChunks() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
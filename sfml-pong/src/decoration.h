@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "voxel_world.h"
+
+// Trees and boulders on top of generated terrain. Each chunk's features are
+// planned once from the seed and the terrain height function alone, so a
+// feature that reaches into a neighbour never makes the neighbour generate:
+// blocks aimed at chunks that have not been decorated yet wait in a queue
+// keyed by target chunk and are applied when that chunk arrives.
+//
+// The result does not depend on generation order or threads: every block a
+// chunk receives is known when it is decorated (its 3x3 neighbourhood is
+// planned first), and where features overlap the highest ranked one wins.
+class ChunkDecorator {
+public:
+    explicit ChunkDecorator(unsigned seed) : seed_(seed) {}
+
+    // Adds every feature block inside c, whose terrain must already be
+    // generated. Safe to call from several threads for different chunks.
+    // Decorating a chunk again (it was unloaded and regenerated) replans
+    // its neighbours rather than relying on the queue.
+    void decorate(Chunk &c);
+    // The chunk came from storage with its features already in place.
+    void markDecorated(ChunkPos p);
+    // The chunk was unloaded. Drops what is kept for it so the sets do not
+    // grow with every chunk ever visited; it is planned again on its return.
+    void forget(ChunkPos p);
+
+    size_t trackedChunks() const;   // planned origins plus decorated chunks
+
+    size_t queuedBlocks() const;    // waiting for their chunk
+    size_t queuedChunks() const;
+
+private:
+    struct Placement {
+        uint16_t index = 0;         // Chunk::index() in the target chunk
+        BlockId id = BLOCK_AIR;
+        bool overwrite = false;     // replaces terrain, not just air
+        uint32_t rank = 0;          // highest wins where features overlap
+    };
+
+    // Every block of the features rooted in `origin`, grouped by target chunk.
+    void plan(ChunkPos origin, std::vector<std::pair<ChunkPos, Placement>> &out) const;
+
+    unsigned seed_;
+    mutable std::mutex mutex;
+    std::unordered_set<ChunkPos, ChunkPosHash> planned;
+    std::unordered_set<ChunkPos, ChunkPosHash> decorated;
+    std::unordered_map<ChunkPos, std::vector<Placement>, ChunkPosHash> queue;
+    size_t queued = 0;
+};
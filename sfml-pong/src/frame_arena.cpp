@@ -0,0 +1,70 @@
+#include "frame_arena.h"
+#include <algorithm>
+#include <cmath>
+
+FrameArena::FrameArena(size_t capacity) : buffer(new unsigned char[capacity]), cap(capacity) {}
+
+void* FrameArena::allocate(size_t bytes, size_t align){
+    // align the address, not the offset: new[] only guarantees alignof(std::max_align_t)
+    const uintptr_t base = reinterpret_cast<uintptr_t>(buffer.get());
+    size_t start = static_cast<size_t>(((base + offset + align - 1) & ~static_cast<uintptr_t>(align - 1)) - base);
+    if (start + bytes <= cap){
+        offset = start + bytes;
+        peak = std::max(peak, offset);
+        return buffer.get() + start;
+    }
+    // out of room this frame; the grown buffer will need the padding as well
+    overflow.emplace_back(::operator new(bytes ? bytes : 1, std::align_val_t(align)), AlignedFree{align});
+    overflowBytes += bytes + align;
+    peak = std::max(peak, offset + overflowBytes);
+    return overflow.back().get();
+}
+
+void FrameArena::reset(){
+    if (!overflow.empty()){
+        cap = std::max(cap * 2, cap + overflowBytes);
+        buffer.reset(new unsigned char[cap]);
+        overflow.clear();
+        overflowBytes = 0;
+    }
+    offset = 0;
+}
+
+TextBuilder::TextBuilder(char *buffer, size_t capacity) : buf(buffer), cap(capacity) { clear(); }
+
+TextBuilder::TextBuilder(FrameArena &arena, size_t capacity) : buf(arena.allocArray<char>(capacity)), cap(capacity) { clear(); }
+
+TextBuilder& TextBuilder::add(char c){
+    if (len + 1 < cap){ buf[len++] = c; buf[len] = '\0'; }
+    return *this;
+}
+
+TextBuilder& TextBuilder::add(const char *s){
+    while (*s) add(*s++);
+    return *this;
+}
+
+TextBuilder& TextBuilder::addInt(long long v){
+    char digits[24];
+    int n = 0;
+    unsigned long long u = v < 0 ? 0ull - static_cast<unsigned long long>(v) : static_cast<unsigned long long>(v);
+    do { digits[n++] = static_cast<char>('0' + u % 10); u /= 10; } while (u);
+    if (v < 0) add('-');
+    while (n) add(digits[--n]);
+    return *this;
+}
+
+TextBuilder& TextBuilder::addFixed(float v, int decimals){
+    if (!std::isfinite(v)) return add(std::isnan(v) ? "nan" : (v < 0 ? "-inf" : "inf"));
+    long long scale = 1;
+    for (int i = 0; i < decimals; ++i) scale *= 10;
+    long long scaled = std::llround(static_cast<double>(v) * static_cast<double>(scale));
+    if (scaled < 0){ add('-'); scaled = -scaled; }
+    addInt(scaled / scale);
+    if (decimals > 0){
+        add('.');
+        long long frac = scaled % scale;
+        for (long long d = scale / 10; d > 0; d /= 10) add(static_cast<char>('0' + (frac / d) % 10));
+    }
+    return *this;
+}
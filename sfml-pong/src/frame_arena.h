@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Linear allocator for data that only lives until the end of the frame.
+// allocate() bumps an offset; reset() at the start of each frame rewinds it.
+// Requests that don't fit are served from the heap and the buffer grows to fit
+// them at the next reset, so a steady-state frame never allocates. Any
+// power-of-two alignment is honoured, in the buffer and on the heap.
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity = 16 * 1024);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+    // Uninitialised storage for n Ts; nothing is destroyed on reset.
+    template <typename T>
+    T* allocArray(size_t n){
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        return static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    void reset();
+    size_t used() const { return offset; }
+    size_t capacity() const { return cap; }
+    size_t highWater() const { return peak; }
+
+private:
+    std::unique_ptr<unsigned char[]> buffer;
+    size_t cap = 0;
+    size_t offset = 0;
+    size_t peak = 0;
+    // heap blocks from the aligned operator new, freed through the matching delete
+    struct AlignedFree {
+        size_t align;
+        void operator()(void *p) const { ::operator delete(p, std::align_val_t(align)); }
+    };
+    std::vector<std::unique_ptr<void, AlignedFree>> overflow;
+    size_t overflowBytes = 0;
+};
+
+// Builds a NUL-terminated string in a fixed buffer without touching the heap.
+// Output past the capacity is dropped.
+class TextBuilder {
+public:
+    TextBuilder(char *buffer, size_t capacity);
+    TextBuilder(FrameArena &arena, size_t capacity);
+
+    TextBuilder& add(const char *s);
+    TextBuilder& add(char c);
+    TextBuilder& addInt(long long v);
+    TextBuilder& addFixed(float v, int decimals); // like printf("%.*f")
+
+    const char* c_str() const { return buf; }
+    size_t size() const { return len; }
+    void clear(){ len = 0; if (cap) buf[0] = '\0'; }
+
+private:
+    char *buf;
+    size_t cap;
+    size_t len = 0;
+};
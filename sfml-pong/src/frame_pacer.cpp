@@ -0,0 +1,63 @@
+#include "frame_pacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using PacerClock = FramePacer::Clock;
+
+void preciseSleepUntil(PacerClock::time_point until){
+    // moving mean and variance of what a 1 ms sleep really takes, so the
+    // estimate follows changes in timer resolution
+    static double mean = 2.0, variance = 1.0;
+    const double alpha = 1.0 / 64.0;
+    for (;;){
+        const auto now = PacerClock::now();
+        const double remaining = std::chrono::duration<double, std::milli>(until - now).count();
+        if (remaining <= mean + std::sqrt(variance)) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const double took = std::chrono::duration<double, std::milli>(PacerClock::now() - now).count();
+        const double delta = took - mean;
+        mean += alpha * delta;
+        variance = (1.0 - alpha) * (variance + alpha * delta * delta);
+    }
+    while (PacerClock::now() < until) std::this_thread::yield();
+}
+
+void FramePacer::configure(double fps, bool lateInput, bool vsyncOn){
+    period = fps > 0.0 ? std::chrono::duration_cast<PacerClock::duration>(std::chrono::duration<double>(1.0 / fps)) : PacerClock::duration::zero();
+    late = lateInput;
+    vsync = vsyncOn;
+    started = false;
+}
+
+void FramePacer::waitForFrameStart(){
+    if (late && started && period > PacerClock::duration::zero()){
+        // a little slack on top of the estimate for the wake-up itself
+        const auto margin = std::chrono::microseconds(500);
+        preciseSleepUntil(deadline - std::min(workEstimate + margin, period));
+    }
+    frameStart = PacerClock::now();
+}
+
+void FramePacer::renderFinished(){
+    const auto work = PacerClock::now() - frameStart;
+    // follow a slower frame at once and a faster one gradually, so one quick
+    // frame does not make the next start too late
+    workEstimate = work > workEstimate ? work : workEstimate - (workEstimate - work) / 32;
+    // present on the schedule, not whenever the frame is done: without late
+    // sampling this is setFramerateLimit's whole wait, with it only what the
+    // estimate had to spare. Under vsync display() waits instead.
+    if (!vsync && started) preciseSleepUntil(deadline);
+}
+
+void FramePacer::framePresented(){
+    const auto now = PacerClock::now();
+    if (!started){
+        deadline = now;
+        started = true;
+    }
+    // display() returning marks a vertical blank under vsync, so the next one
+    // is a period on; otherwise a late frame moves the schedule rather than
+    // making the next ones hurry
+    deadline = (vsync ? now : std::max(deadline, now)) + period;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+
+// Replaces sf::Window::setFramerateLimit, whose sleep can overshoot by a
+// whole scheduler quantum, with waits that sleep most of the way and spin
+// the rest.
+//
+// With late input sampling the wait goes before the frame rather than after
+// it: the loop sleeps until the next present is only about one frame's work
+// away, then polls input, renders and presents, so what is shown is as fresh
+// as the frame cost allows. Under vsync display() does the final wait for
+// the vertical blank and the pacer only trims the input age in front of it.
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // fps 0 disables pacing; under vsync pass the display's refresh rate
+    void configure(double fps, bool lateInput, bool vsync);
+
+    // Call at the top of the frame, before polling events
+    void waitForFrameStart();
+    // Call right before window.display(); without vsync this is where the
+    // frame waits for its slot.
+    void renderFinished();
+    // Call right after window.display()
+    void framePresented();
+
+    // The work from frame start to present the pacer plans around
+    double workEstimateMillis() const { return std::chrono::duration<double, std::milli>(workEstimate).count(); }
+
+private:
+    Clock::duration period{};
+    bool late = true;
+    bool vsync = false;
+    Clock::time_point deadline;             // when the coming frame should be presented
+    Clock::time_point frameStart;
+    Clock::duration workEstimate{};         // recent worst frame cost, decaying slowly
+    bool started = false;
+};
+
+// Sleeps in 1 ms steps while that is safe, judging from how long such sleeps
+// have really taken (15 ms with the default Windows timer), then spins.
+void preciseSleepUntil(FramePacer::Clock::time_point until);
@@ -0,0 +1,29 @@
+#include "gl_functions.h"
+#include <SFML/Window.hpp>
+#include <iostream>
+
+#define CUBE_GL_DEFINE(ret, name, args) CubePFN_gl##name cube_gl##name = nullptr;
+CUBE_GL_FUNCTIONS(CUBE_GL_DEFINE)
+CUBE_GL_OPTIONAL_FUNCTIONS(CUBE_GL_DEFINE)
+#undef CUBE_GL_DEFINE
+
+bool loadGLFunctions(){
+    bool ok = true;
+#define CUBE_GL_LOAD(ret, name, args) \
+    cube_gl##name = reinterpret_cast<CubePFN_gl##name>(sf::Context::getFunction("gl" #name)); \
+    if (!cube_gl##name){ std::cerr << "Missing OpenGL function gl" #name "\n"; ok = false; }
+    CUBE_GL_FUNCTIONS(CUBE_GL_LOAD)
+#undef CUBE_GL_LOAD
+#define CUBE_GL_LOAD_OPTIONAL(ret, name, args) \
+    cube_gl##name = reinterpret_cast<CubePFN_gl##name>(sf::Context::getFunction("gl" #name));
+    CUBE_GL_OPTIONAL_FUNCTIONS(CUBE_GL_LOAD_OPTIONAL)
+#undef CUBE_GL_LOAD_OPTIONAL
+    return ok;
+}
+
+bool hasMultiDrawIndirect(){
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    return (major > 4 || (major == 4 && minor >= 3)) && cube_glMultiDrawElementsIndirect;
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include <SFML/OpenGL.hpp>
+#include <cstddef>
+
+// GL 2.0-3.3 entry points used by the shader pipeline, loaded at runtime
+// through sf::Context::getFunction (the system gl.h only covers GL 1.1 on
+// Windows). Call loadGLFunctions() with the context active before using them.
+// Newer entry points the renderer can do without are in the optional list.
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+// glext.h (where the platform ships one) already defines these
+#ifndef GL_VERSION_1_5
+typedef std::ptrdiff_t GLsizeiptr;
+typedef std::ptrdiff_t GLintptr;
+#endif
+#ifndef GL_VERSION_2_0
+typedef char GLchar;
+#endif
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_STATIC_DRAW 0x88E4
+#define GL_DYNAMIC_DRAW 0x88E8
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_LINK_STATUS 0x8B82
+#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
+#define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif
+#ifndef GL_COPY_READ_BUFFER
+#define GL_COPY_READ_BUFFER 0x8F36
+#define GL_COPY_WRITE_BUFFER 0x8F37
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_MAJOR_VERSION
+#define GL_MAJOR_VERSION 0x821B
+#define GL_MINOR_VERSION 0x821C
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+#define CUBE_GL_FUNCTIONS(X) \
+    X(void,   GenBuffers, (GLsizei n, GLuint *buffers)) \
+    X(void,   DeleteBuffers, (GLsizei n, const GLuint *buffers)) \
+    X(void,   BindBuffer, (GLenum target, GLuint buffer)) \
+    X(void,   BufferData, (GLenum target, GLsizeiptr size, const void *data, GLenum usage)) \
+    X(void,   BufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const void *data)) \
+    X(void,   BindBufferBase, (GLenum target, GLuint index, GLuint buffer)) \
+    X(void,   GenVertexArrays, (GLsizei n, GLuint *arrays)) \
+    X(void,   DeleteVertexArrays, (GLsizei n, const GLuint *arrays)) \
+    X(void,   BindVertexArray, (GLuint array)) \
+    X(void,   EnableVertexAttribArray, (GLuint index)) \
+    X(void,   DisableVertexAttribArray, (GLuint index)) \
+    X(void,   VertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)) \
+    X(void,   VertexAttribDivisor, (GLuint index, GLuint divisor)) \
+    X(void,   VertexAttrib3f, (GLuint index, GLfloat x, GLfloat y, GLfloat z)) \
+    X(void,   CopyBufferSubData, (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)) \
+    X(void,   DrawElementsBaseVertex, (GLenum mode, GLsizei count, GLenum type, const void *indices, GLint basevertex)) \
+    X(GLuint, CreateShader, (GLenum type)) \
+    X(void,   ShaderSource, (GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length)) \
+    X(void,   CompileShader, (GLuint shader)) \
+    X(void,   GetShaderiv, (GLuint shader, GLenum pname, GLint *params)) \
+    X(void,   GetShaderInfoLog, (GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog)) \
+    X(void,   DeleteShader, (GLuint shader)) \
+    X(GLuint, CreateProgram, (void)) \
+    X(void,   AttachShader, (GLuint program, GLuint shader)) \
+    X(void,   LinkProgram, (GLuint program)) \
+    X(void,   GetProgramiv, (GLuint program, GLenum pname, GLint *params)) \
+    X(void,   GetProgramInfoLog, (GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog)) \
+    X(void,   DeleteProgram, (GLuint program)) \
+    X(void,   UseProgram, (GLuint program)) \
+    X(GLint,  GetUniformLocation, (GLuint program, const GLchar *name)) \
+    X(void,   Uniform1i, (GLint location, GLint v0)) \
+    X(void,   Uniform3f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)) \
+    X(void,   Uniform4f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)) \
+    X(void,   UniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)) \
+    X(GLuint, GetUniformBlockIndex, (GLuint program, const GLchar *uniformBlockName)) \
+    X(void,   UniformBlockBinding, (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding))
+
+// GL 4.3 (multi-draw indirect with base instance)
+#define CUBE_GL_OPTIONAL_FUNCTIONS(X) \
+    X(void,   MultiDrawElementsIndirect, (GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride))
+
+// Declared as cube_glName pointers and mapped onto the usual names, the same
+// way GL loaders do it.
+#define CUBE_GL_DECLARE(ret, name, args) typedef ret (APIENTRY *CubePFN_gl##name) args; extern CubePFN_gl##name cube_gl##name;
+CUBE_GL_FUNCTIONS(CUBE_GL_DECLARE)
+CUBE_GL_OPTIONAL_FUNCTIONS(CUBE_GL_DECLARE)
+#undef CUBE_GL_DECLARE
+
+#define glGenBuffers cube_glGenBuffers
+#define glDeleteBuffers cube_glDeleteBuffers
+#define glBindBuffer cube_glBindBuffer
+#define glBufferData cube_glBufferData
+#define glBufferSubData cube_glBufferSubData
+#define glBindBufferBase cube_glBindBufferBase
+#define glGenVertexArrays cube_glGenVertexArrays
+#define glDeleteVertexArrays cube_glDeleteVertexArrays
+#define glBindVertexArray cube_glBindVertexArray
+#define glEnableVertexAttribArray cube_glEnableVertexAttribArray
+#define glDisableVertexAttribArray cube_glDisableVertexAttribArray
+#define glVertexAttribPointer cube_glVertexAttribPointer
+#define glVertexAttribDivisor cube_glVertexAttribDivisor
+#define glVertexAttrib3f cube_glVertexAttrib3f
+#define glCopyBufferSubData cube_glCopyBufferSubData
+#define glDrawElementsBaseVertex cube_glDrawElementsBaseVertex
+#define glCreateShader cube_glCreateShader
+#define glShaderSource cube_glShaderSource
+#define glCompileShader cube_glCompileShader
+#define glGetShaderiv cube_glGetShaderiv
+#define glGetShaderInfoLog cube_glGetShaderInfoLog
+#define glDeleteShader cube_glDeleteShader
+#define glCreateProgram cube_glCreateProgram
+#define glAttachShader cube_glAttachShader
+#define glLinkProgram cube_glLinkProgram
+#define glGetProgramiv cube_glGetProgramiv
+#define glGetProgramInfoLog cube_glGetProgramInfoLog
+#define glDeleteProgram cube_glDeleteProgram
+#define glUseProgram cube_glUseProgram
+#define glGetUniformLocation cube_glGetUniformLocation
+#define glUniform1i cube_glUniform1i
+#define glUniform3f cube_glUniform3f
+#define glUniform4f cube_glUniform4f
+#define glUniformMatrix4fv cube_glUniformMatrix4fv
+#define glGetUniformBlockIndex cube_glGetUniformBlockIndex
+#define glUniformBlockBinding cube_glUniformBlockBinding
+#define glMultiDrawElementsIndirect cube_glMultiDrawElementsIndirect
+
+// Resolves every entry point; prints the missing ones and returns false if
+// the context doesn't provide GL 3.3.
+bool loadGLFunctions();
+// true if the context is GL 4.3+ and glMultiDrawElementsIndirect resolved
+// (some platforms hand out pointers for any name, so the version is checked too)
+bool hasMultiDrawIndirect();
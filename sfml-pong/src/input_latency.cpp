@@ -0,0 +1,34 @@
+#include "input_latency.h"
+#include <algorithm>
+#include <cstdio>
+
+void InputLatencyMeter::inputPosted(uint64_t posted, Clock::time_point at){
+    if (pendingCount == PENDING){ ++overflowed; return; }
+    pending[(pendingHead + pendingCount) % PENDING] = {posted, at};
+    ++pendingCount;
+}
+
+void InputLatencyMeter::framePresented(uint64_t consumed, Clock::time_point frameStart, Clock::time_point presentedAt){
+    while (pendingCount > 0 && pending[pendingHead].posted <= consumed){
+        const Pending &p = pending[pendingHead];
+        pendingHead = (pendingHead + 1) % PENDING;
+        --pendingCount;
+        if (samples == SAMPLES){ ++overflowed; continue; }
+        total[samples] = std::chrono::duration<float, std::milli>(presentedAt - p.at).count();
+        frame[samples] = std::chrono::duration<float, std::milli>(presentedAt - std::max(frameStart, p.at)).count();
+        ++samples;
+    }
+}
+
+void InputLatencyMeter::report(){
+    if (samples == 0) return;
+    std::sort(total, total + samples);
+    std::sort(frame, frame + samples);
+    auto pct = [&](const float *v, double q){ return v[std::min(samples - 1, static_cast<int>(q * samples))]; };
+    std::printf("[latency] %d inputs: input->present p50 %.1f ms, p99 %.1f ms, max %.1f ms (frame start->present p50 %.1f ms)",
+        samples, pct(total, 0.5), pct(total, 0.99), total[samples - 1], pct(frame, 0.5));
+    if (overflowed) std::printf(", %llu not measured", static_cast<unsigned long long>(overflowed));
+    std::printf("\n");
+    samples = 0;
+    overflowed = 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Input-to-present latency (cube --latency). The window thread notes how
+// many commands it had posted to the simulation when it read a frame's
+// input; each snapshot says how many the simulation has consumed, and the
+// first frame drawn from one that covers them closes the sample when it is
+// presented. SFML events carry no timestamps, so input counts from when it
+// was polled, not from the device. Fixed storage: nothing allocates per frame.
+class InputLatencyMeter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Commands up to number `posted` were read at `at`
+    void inputPosted(uint64_t posted, Clock::time_point at);
+    // A frame drawn from a snapshot that had consumed `consumed` commands,
+    // started at `frameStart`, finished presenting at `presentedAt`
+    void framePresented(uint64_t consumed, Clock::time_point frameStart, Clock::time_point presentedAt);
+
+    // Prints percentiles of the samples since the last report, then clears them
+    void report();
+
+private:
+    static const int PENDING = 64;
+    static const int SAMPLES = 1024;
+
+    struct Pending { uint64_t posted; Clock::time_point at; };
+    Pending pending[PENDING];
+    int pendingHead = 0, pendingCount = 0;
+
+    float total[SAMPLES];       // ms from input to present
+    float frame[SAMPLES];       // of which from frame start to present
+    int samples = 0;
+    uint64_t overflowed = 0;
+};
@@ -0,0 +1,141 @@
+#include "input_log.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+static const char MAGIC[4] = {'C','B','I','L'};
+static const uint8_t VERSION = 1;
+
+static void putVarint(std::vector<uint8_t> &b, uint32_t v){
+    while (v >= 0x80){ b.push_back(static_cast<uint8_t>(v | 0x80)); v >>= 7; }
+    b.push_back(static_cast<uint8_t>(v));
+}
+
+static void putFloat(std::vector<uint8_t> &b, float f){
+    uint32_t u;
+    std::memcpy(&u, &f, 4);
+    for (int i = 0; i < 4; ++i) b.push_back(static_cast<uint8_t>(u >> (8 * i)));
+}
+
+static bool getVarint(const std::vector<uint8_t> &d, size_t &pos, uint32_t &v){
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7){
+        if (pos >= d.size()) return false;
+        uint8_t byte = d[pos++];
+        v |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static bool getFloat(const std::vector<uint8_t> &d, size_t &pos, float &f){
+    if (pos + 4 > d.size()) return false;
+    uint32_t u = 0;
+    for (int i = 0; i < 4; ++i) u |= static_cast<uint32_t>(d[pos++]) << (8 * i);
+    std::memcpy(&f, &u, 4);
+    return true;
+}
+
+bool InputRecorder::open(const std::string &path, const InputLogHeader &header){
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    buf.clear();
+    for (char c : MAGIC) buf.push_back(static_cast<uint8_t>(c));
+    buf.push_back(VERSION);
+    putVarint(buf, header.seed);
+    putFloat(buf, header.tickRate);
+    lastHeld = 0;
+    tickCount = 0;
+    byteCount = 0;
+    flush();
+    return true;
+}
+
+void InputRecorder::record(const SimInput &in){
+    if (!file.is_open()) return;
+    const size_t count = in.commands.size();
+    const bool heldChanged = in.held != lastHeld;
+    buf.push_back(static_cast<uint8_t>((std::min<size_t>(count, 127) << 1) | (heldChanged ? 1 : 0)));
+    if (count >= 127) putVarint(buf, static_cast<uint32_t>(count));
+    if (heldChanged){ putVarint(buf, in.held); lastHeld = in.held; }
+    for (const auto &c : in.commands){
+        buf.push_back(static_cast<uint8_t>(c.action));
+        switch (c.action){
+        case SimAction::Look: case SimAction::OrbitRotate: case SimAction::OrbitPan:
+            putFloat(buf, c.x); putFloat(buf, c.y); break;
+        case SimAction::Zoom: putFloat(buf, c.x); break;
+        case SimAction::Regenerate: putVarint(buf, c.seed); break;
+        default: break;
+        }
+    }
+    ++tickCount;
+    if (buf.size() >= 16 * 1024) flush();
+}
+
+void InputRecorder::flush(){
+    if (buf.empty()) return;
+    TRACE_ZONE("write input log");
+    file.write(reinterpret_cast<const char*>(buf.data()), static_cast<std::streamsize>(buf.size()));
+    byteCount += buf.size();
+    buf.clear();
+}
+
+void InputRecorder::close(){
+    if (!file.is_open()) return;
+    flush();
+    file.close();
+}
+
+bool InputPlayer::load(const std::string &path){
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    pos = 0;
+    held = 0;
+    tickCount = 0;
+    if (data.size() < 5 || std::memcmp(data.data(), MAGIC, 4) != 0 || data[4] != VERSION){
+        std::cerr << "Not an input log (or unsupported version): " << path << "\n";
+        return false;
+    }
+    pos = 5;
+    if (!getVarint(data, pos, hdr.seed) || !getFloat(data, pos, hdr.tickRate)){
+        std::cerr << "Truncated input log header: " << path << "\n";
+        return false;
+    }
+    // every recorded input belongs to one fixed tick; at another rate the replay would diverge
+    if (hdr.tickRate != SIM_TICK_RATE){
+        std::cerr << "Input log " << path << " was recorded at " << hdr.tickRate << " ticks/s, but the simulation runs at "
+                  << SIM_TICK_RATE << "; it cannot be replayed\n";
+        return false;
+    }
+    return true;
+}
+
+bool InputPlayer::next(SimInput &out){
+    out.commands.clear();
+    if (pos >= data.size()) return false;
+    uint8_t tag = data[pos++];
+    uint32_t count = tag >> 1;
+    if (count == 127 && !getVarint(data, pos, count)) return false;
+    if ((tag & 1) && !getVarint(data, pos, held)) return false;
+    out.held = held;
+    for (uint32_t i = 0; i < count; ++i){
+        if (pos >= data.size()) return false;
+        SimCommand c;
+        c.action = static_cast<SimAction>(data[pos++]);
+        bool ok = true;
+        switch (c.action){
+        case SimAction::Look: case SimAction::OrbitRotate: case SimAction::OrbitPan:
+            ok = getFloat(data, pos, c.x) && getFloat(data, pos, c.y); break;
+        case SimAction::Zoom: ok = getFloat(data, pos, c.x); break;
+        case SimAction::Regenerate: ok = getVarint(data, pos, c.seed); break;
+        default: break;
+        }
+        if (!ok) return false;
+        out.commands.push_back(c);
+    }
+    ++tickCount;
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "simulation.h"
+
+// Binary log of every SimInput the simulation consumed, one record per tick.
+// Together with the terrain seed in the header, replaying it reproduces the
+// session tick for tick.
+//
+// Layout (little endian):
+//   header: "CBIL" u8 version, varint seed, f32 tickRate
+//   tick:   u8 tag = (commandCount << 1) | heldChanged   (count 127 => varint follows)
+//           [varint held] then per command: u8 action + payload
+//   payload: Look/OrbitRotate/OrbitPan f32 x, f32 y; Zoom f32 x; Regenerate varint seed
+struct InputLogHeader {
+    uint32_t seed = 0;
+    float tickRate = SIM_TICK_RATE;
+};
+
+class InputRecorder {
+public:
+    bool open(const std::string &path, const InputLogHeader &header);
+    void record(const SimInput &in);
+    void close();
+    ~InputRecorder() { close(); }
+
+    uint64_t ticks() const { return tickCount; }
+    uint64_t bytes() const { return byteCount; }
+
+private:
+    void flush();
+
+    std::ofstream file;
+    std::vector<uint8_t> buf;
+    uint32_t lastHeld = 0;
+    uint64_t tickCount = 0;
+    uint64_t byteCount = 0;
+};
+
+class InputPlayer {
+public:
+    bool load(const std::string &path);
+    const InputLogHeader& header() const { return hdr; }
+    // Fills the next tick's input; false once the log is exhausted or corrupt.
+    bool next(SimInput &out);
+    uint64_t ticks() const { return tickCount; }
+
+private:
+    InputLogHeader hdr;
+    std::vector<uint8_t> data;
+    size_t pos = 0;
+    uint32_t held = 0;
+    uint64_t tickCount = 0;
+};
@@ -0,0 +1,51 @@
+#include "launch_options.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+bool parseLaunchArgs(int argc, char **argv, LaunchOptions &opt){
+    for (int i = 1; i < argc; ++i){
+        std::string a = argv[i];
+        auto next = [&](const char *name) -> const char* {
+            if (i + 1 >= argc){ std::cerr << name << " needs a value\n"; return nullptr; }
+            return argv[++i];
+        };
+        const char *v = nullptr;
+        if (a == "--bench") opt.bench.enabled = true;
+        else if (a == "--frames"){ if (!(v = next("--frames"))) return false; opt.bench.frames = std::max(1, std::atoi(v)); }
+        else if (a == "--seed"){ if (!(v = next("--seed"))) return false; opt.bench.seed = static_cast<unsigned>(std::strtoul(v, nullptr, 10)); }
+        else if (a == "--path"){ if (!(v = next("--path"))) return false; opt.bench.pathFile = v; }
+        else if (a == "--out"){ if (!(v = next("--out"))) return false; opt.bench.outFile = v; }
+        else if (a == "--record"){ if (!(v = next("--record"))) return false; opt.recordFile = v; }
+        else if (a == "--replay"){ if (!(v = next("--replay"))) return false; opt.replayFile = v; }
+        else if (a == "--fps"){ if (!(v = next("--fps"))) return false; opt.fps = std::max(0.0, std::atof(v)); }
+        else if (a == "--vsync") opt.vsync = true;
+        else if (a == "--no-late-input") opt.lateInput = false;
+        else if (a == "--latency") opt.measureLatency = true;
+        else if (a == "--bundle"){ if (!(v = next("--bundle"))) return false; opt.bundleFile = v; }
+        else if (a == "--loose-assets") opt.looseAssets = true;
+        else if (a == "--no-mdi") opt.multiDrawIndirect = false;
+        else if (a == "--trace"){ if (!(v = next("--trace"))) return false; opt.traceFile = v; }
+        else if (a == "--trace-frames"){ if (!(v = next("--trace-frames"))) return false; opt.traceFrames = std::max(1, std::atoi(v)); }
+        else if (a == "--asset-bench"){ if (!(v = next("--asset-bench"))) return false; opt.assetBench = std::max(1, std::atoi(v)); }
+        else if (a == "--size"){
+            if (!(v = next("--size"))) return false;
+            unsigned w = 0, h = 0;
+            if (std::sscanf(v, "%ux%u", &w, &h) != 2 || w == 0 || h == 0){ std::cerr << "--size expects WxH\n"; return false; }
+            opt.bench.width = w; opt.bench.height = h;
+        } else {
+            std::cerr << "Unknown argument: " << a << "\n"
+                      << "Usage: cube [--record input.log | --replay input.log] [--fps N] [--vsync] [--no-late-input] [--latency]\n"
+                      << "            [--bundle assets.bundle | --loose-assets] [--no-mdi] [--trace trace.json] [--trace-frames N]\n"
+                      << "       cube --asset-bench N [--bundle assets.bundle]\n"
+                      << "       cube --bench [--no-mdi] [--frames N] [--seed S] [--size WxH] [--path camera.txt] [--out report.json] [--trace trace.json]\n";
+            return false;
+        }
+    }
+    if (!opt.recordFile.empty() && !opt.replayFile.empty()){
+        std::cerr << "--record and --replay cannot be combined\n";
+        return false;
+    }
+    return true;
+}
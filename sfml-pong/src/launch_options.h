@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include "bench.h"
+
+// Command-line options for the cube executable.
+struct LaunchOptions {
+    BenchOptions bench;
+    std::string recordFile;   // --record: log every simulation tick input
+    std::string replayFile;   // --replay: drive the simulation from a log, exit when it ends
+    double fps = 60.0;        // --fps: frame rate to pace to, 0 = unlimited (the refresh rate under --vsync)
+    bool vsync = false;       // --vsync
+    bool lateInput = true;    // --no-late-input: read input right after the previous frame instead
+    bool measureLatency = false; // --latency: print input-to-present latency every second
+    std::string bundleFile = "assets/assets.bundle"; // --bundle: asset bundle written by asset_pack
+    bool looseAssets = false; // --loose-assets: ignore the bundle, load atlas.png and the font as files
+    int assetBench = 0;       // --asset-bench N: time N loads each way and exit
+    bool multiDrawIndirect = true; // --no-mdi: draw terrain one section at a time even on GL 4.3
+    std::string traceFile;    // --trace: capture the first traceFrames frames to this Chrome trace (F9 writes here too)
+    int traceFrames = 300;    // --trace-frames
+};
+
+bool parseLaunchArgs(int argc, char **argv, LaunchOptions &opt);
@@ -1,28 +1,74 @@
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <cstdlib>
 #include <ctime>
 #include <optional>
+#include <thread>
+#include "pong_batch.h"
+#include "pong_netplay.h"
+#include "pong_sim.h"
+
+// pong: two players on one keyboard, or one on each side of a UDP link.
+//   --batch N      headless throughput run of N matches (with --seconds T, --threads K)
+//   --rollback-bench T  time worst-case rollbacks for T seconds and exit
+//   --peer P       play against the pong listening on localhost port P
+//   --port P       our UDP port (default 27020)
+//   --side S       left or right paddle (default left)
+//   --seed S       serve seed, the same on both sides (default 1)
+//   --latency MS, --jitter MS, --loss PCT  delay, reorder and drop what we send
+//   --headless F   no window: a tracking player plays our side for F frames,
+//                  then the state checksum is printed to compare with the peer
+int main(int argc, char **argv){
+    size_t batch = 0;
+    double batchSeconds = 5.0;
+    unsigned batchThreads = std::max(1u, std::thread::hardware_concurrency());
+    double rollbackBenchSeconds = 0.0;
+    NetplayConfig net;
+    bool netplay = false;
+    int headlessFrames = 0;
+    for(int i = 1; i < argc; ++i){
+        std::string a = argv[i];
+        if(i + 1 >= argc){ std::cerr << "Missing value for " << a << "\n"; return 2; }
+        const char *v = argv[++i];
+        if(a == "--batch") batch = static_cast<size_t>(std::max(1, std::atoi(v)));
+        else if(a == "--seconds") batchSeconds = std::max(0.1, std::atof(v));
+        else if(a == "--threads") batchThreads = static_cast<unsigned>(std::max(1, std::atoi(v)));
+        else if(a == "--rollback-bench") rollbackBenchSeconds = std::max(0.1, std::atof(v));
+        else if(a == "--peer"){ net.peerPort = static_cast<unsigned short>(std::atoi(v)); netplay = true; }
+        else if(a == "--port") net.port = static_cast<unsigned short>(std::atoi(v));
+        else if(a == "--side") net.side = std::string(v) == "right" ? 1 : 0;
+        else if(a == "--seed") net.seed = static_cast<uint32_t>(std::strtoul(v, nullptr, 10));
+        else if(a == "--latency") net.latencyMs = std::max(0.0, std::atof(v));
+        else if(a == "--jitter") net.jitterMs = std::max(0.0, std::atof(v));
+        else if(a == "--loss") net.lossPercent = std::clamp(std::atof(v), 0.0, 100.0);
+        else if(a == "--headless") headlessFrames = std::max(1, std::atoi(v));
+        else { std::cerr << "Unknown argument: " << a << "\nUsage: pong [--batch N [--seconds T] [--threads K]] [--rollback-bench T]"
+            " [--peer P [--port P] [--side left|right] [--seed S] [--latency MS] [--jitter MS] [--loss PCT] [--headless F]]\n"; return 2; }
+    }
+    if(batch > 0) return runPongBatch(batch, batchSeconds, batchThreads);
+    if(rollbackBenchSeconds > 0.0) return runRollbackBench(rollbackBenchSeconds);
+    if(headlessFrames > 0){
+        if(!netplay){ std::cerr << "--headless needs --peer\n"; return 2; }
+        return runHeadlessNetplay(net, static_cast<uint32_t>(headlessFrames));
+    }
 
-int main(){
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
-    const unsigned WINDOW_W = 800, WINDOW_H = 600;
+    const unsigned WINDOW_W = static_cast<unsigned>(PONG_W), WINDOW_H = static_cast<unsigned>(PONG_H);
     sf::RenderWindow window(sf::VideoMode(sf::Vector2u{WINDOW_W, WINDOW_H}), "Pong - SFML");
     window.setFramerateLimit(60);
 
-    sf::RectangleShape leftPaddle(sf::Vector2f{10.f, 100.f});
-    leftPaddle.setPosition(sf::Vector2f{50.f, WINDOW_H/2.f - 50.f});
-    sf::RectangleShape rightPaddle(sf::Vector2f{10.f, 100.f});
-    rightPaddle.setPosition(sf::Vector2f{static_cast<float>(WINDOW_W) - 60.f, WINDOW_H/2.f - 50.f});
-
-    float paddleSpeed = 400.f;
-
-    sf::CircleShape ball(8.f);
-    ball.setPosition(sf::Vector2f{WINDOW_W/2.f, WINDOW_H/2.f});
-    sf::Vector2f ballVel{-300.f, -150.f};
+    PongState game = pongNewMatch(static_cast<uint32_t>(std::time(nullptr)));
+    std::optional<PongNetSession> session;
+    if(netplay){
+        session.emplace(net);
+        if(!session->open()) return 1;
+        std::cout << "Playing the " << (net.side == 0 ? "left" : "right") << " paddle, waiting for port " << net.peerPort << "\n";
+    }
 
-    int scoreLeft = 0, scoreRight = 0;
+    sf::RectangleShape leftPaddle(sf::Vector2f{PONG_PADDLE_W, PONG_PADDLE_H});
+    sf::RectangleShape rightPaddle(sf::Vector2f{PONG_PADDLE_W, PONG_PADDLE_H});
+    sf::CircleShape ball(PONG_BALL_SIZE / 2.f);
 
     sf::Font font;
     bool fontLoaded = font.openFromFile("assets/arial.ttf"); // new SFML3 API
@@ -35,9 +81,11 @@ int main(){
         std::cerr << "Warning: could not open assets/arial.ttf. Scores will not be shown.\n";
     }
 
-    sf::Clock clock;
+    // the rules run at a fixed PONG_TICK (see pong_sim.h); frames just show the latest state
+    sf::Clock clock, reportClock;
+    float accumulator = 0.f;
     while(window.isOpen()){
-        float dt = clock.restart().asSeconds();
+        accumulator += std::min(clock.restart().asSeconds(), 0.25f);
 
         // Event handling
         while (const auto eventOpt = window.pollEvent()){
@@ -47,52 +95,29 @@ int main(){
         }
 
         // Input (real-time)
-        if(sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) leftPaddle.move(sf::Vector2f{0.f, -paddleSpeed * dt});
-        if(sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) leftPaddle.move(sf::Vector2f{0.f, paddleSpeed * dt});
-        if(sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up)) rightPaddle.move(sf::Vector2f{0.f, -paddleSpeed * dt});
-        if(sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down)) rightPaddle.move(sf::Vector2f{0.f, paddleSpeed * dt});
-
-        // Clamp paddles
-        auto clamp = [&](sf::RectangleShape &p){
-            if(p.getPosition().y < 0.f) p.setPosition(sf::Vector2f{p.getPosition().x, 0.f});
-            if(p.getPosition().y + p.getSize().y > static_cast<float>(WINDOW_H)) p.setPosition(sf::Vector2f{p.getPosition().x, static_cast<float>(WINDOW_H) - p.getSize().y});
+        auto axis = [](sf::Keyboard::Key up, sf::Keyboard::Key down){
+            return static_cast<int8_t>(sf::Keyboard::isKeyPressed(down) - sf::Keyboard::isKeyPressed(up));
         };
-        clamp(leftPaddle); clamp(rightPaddle);
-
-        // Ball movement
-        ball.move(ballVel * dt);
-
-        // Top/bottom collision
-        if(ball.getPosition().y <= 0.f) ballVel.y = std::abs(ballVel.y);
-        if(ball.getPosition().y + ball.getRadius()*2 >= WINDOW_H) ballVel.y = -std::abs(ballVel.y);
-
-        // Paddle collision (using findIntersection)
-        if(ball.getGlobalBounds().findIntersection(leftPaddle.getGlobalBounds())){
-            ballVel.x = std::abs(ballVel.x);
-            // add a little spin based on where it hit the paddle
-            float offset = (ball.getPosition().y + ball.getRadius()) - (leftPaddle.getPosition().y + leftPaddle.getSize().y/2.f);
-            ballVel.y = offset * 5.f;
-        }
-        if(ball.getGlobalBounds().findIntersection(rightPaddle.getGlobalBounds())){
-            ballVel.x = -std::abs(ballVel.x);
-            float offset = (ball.getPosition().y + ball.getRadius()) - (rightPaddle.getPosition().y + rightPaddle.getSize().y/2.f);
-            ballVel.y = offset * 5.f;
-        }
-
-        // Scoring
-        if(ball.getPosition().x < 0.f){
-            scoreRight++;
-            ball.setPosition(sf::Vector2f{WINDOW_W/2.f, WINDOW_H/2.f});
-            ballVel = sf::Vector2f{-300.f, static_cast<float>(std::rand()%200 - 100)};
-        }
-        if(ball.getPosition().x > WINDOW_W){
-            scoreLeft++;
-            ball.setPosition(sf::Vector2f{WINDOW_W/2.f, WINDOW_H/2.f});
-            ballVel = sf::Vector2f{300.f, static_cast<float>(std::rand()%200 - 100)};
+        PongInput input;
+        input.left = axis(sf::Keyboard::Key::W, sf::Keyboard::Key::S);
+        input.right = axis(sf::Keyboard::Key::Up, sf::Keyboard::Key::Down);
+
+        if(session){
+            // either set of keys moves our paddle; the session supplies the other
+            const int8_t mine = input.left ? input.left : input.right;
+            for(; accumulator >= PONG_TICK; accumulator -= PONG_TICK) session->tick(mine);
+            game = session->game().state();
+            const float sinceReport = reportClock.getElapsedTime().asSeconds();
+            if(sinceReport >= 2.f){ session->report(sinceReport); reportClock.restart(); }
+        } else {
+            for(; accumulator >= PONG_TICK; accumulator -= PONG_TICK) stepPong(game, input);
         }
 
+        leftPaddle.setPosition(sf::Vector2f{PONG_LEFT_X, game.leftY});
+        rightPaddle.setPosition(sf::Vector2f{PONG_RIGHT_X, game.rightY});
+        ball.setPosition(sf::Vector2f{game.ballX, game.ballY});
         if(fontLoaded){
-            (*scoreText).setString(std::to_string(scoreLeft) + "  -  " + std::to_string(scoreRight));
+            (*scoreText).setString(std::to_string(game.scoreLeft) + "  -  " + std::to_string(game.scoreRight));
         }
 
         // Draw
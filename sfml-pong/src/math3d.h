@@ -0,0 +1,252 @@
+#pragma once
+#include <SFML/System.hpp>
+#include <cmath>
+
+// Vectors are sf::Vector3f (vec3) and Vec4; matrices are column-major Mat4.
+// Multiply, inverse and frustum-plane extraction use SSE where the compiler
+// targets it (every x86-64 build) and plain loops elsewhere.
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CUBE_MATH_SSE 1
+#include <xmmintrin.h>
+#else
+#define CUBE_MATH_SSE 0
+#endif
+
+const float DEG_TO_RAD = 3.14159265f / 180.f;
+
+struct alignas(16) Vec4 {
+    float x = 0.f, y = 0.f, z = 0.f, w = 0.f;
+};
+
+// Column-major 4x4 matrix laid out the way GL expects it (m[12..14] is the translation).
+struct alignas(16) Mat4 {
+    float m[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
+    const float* data() const { return m; }
+};
+
+inline sf::Vector3f cross(const sf::Vector3f &a, const sf::Vector3f &b){
+    return { a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x };
+}
+
+inline float dot(const sf::Vector3f &a, const sf::Vector3f &b){ return a.x*b.x + a.y*b.y + a.z*b.z; }
+
+inline sf::Vector3f normalize(const sf::Vector3f &v){
+    float l = std::sqrt(dot(v, v));
+    return l == 0.f ? v : sf::Vector3f{v.x/l, v.y/l, v.z/l};
+}
+
+// Unit view direction for a yaw around +Y (0 = +Z) and a pitch above the horizon.
+inline sf::Vector3f forwardFromYawPitch(float yawDeg, float pitchDeg){
+    const float yaw = yawDeg * DEG_TO_RAD, pitch = pitchDeg * DEG_TO_RAD;
+    return { std::sin(yaw) * std::cos(pitch), std::sin(pitch), std::cos(yaw) * std::cos(pitch) };
+}
+
+inline Mat4 operator*(const Mat4 &a, const Mat4 &b){
+    Mat4 r;
+#if CUBE_MATH_SSE
+    const __m128 a0 = _mm_load_ps(a.m), a1 = _mm_load_ps(a.m + 4), a2 = _mm_load_ps(a.m + 8), a3 = _mm_load_ps(a.m + 12);
+    for (int c = 0; c < 4; ++c){
+        const float *bc = b.m + c*4;
+        __m128 col = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+        col = _mm_add_ps(col, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+        col = _mm_add_ps(col, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+        col = _mm_add_ps(col, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+        _mm_store_ps(r.m + c*4, col);
+    }
+#else
+    for (int c = 0; c < 4; ++c)
+        for (int row = 0; row < 4; ++row){
+            float s = 0.f;
+            for (int k = 0; k < 4; ++k) s += a.m[k*4 + row] * b.m[c*4 + k];
+            r.m[c*4 + row] = s;
+        }
+#endif
+    return r;
+}
+
+inline Vec4 operator*(const Mat4 &a, const Vec4 &v){
+    Vec4 r;
+#if CUBE_MATH_SSE
+    __m128 col = _mm_mul_ps(_mm_load_ps(a.m), _mm_set1_ps(v.x));
+    col = _mm_add_ps(col, _mm_mul_ps(_mm_load_ps(a.m + 4), _mm_set1_ps(v.y)));
+    col = _mm_add_ps(col, _mm_mul_ps(_mm_load_ps(a.m + 8), _mm_set1_ps(v.z)));
+    col = _mm_add_ps(col, _mm_mul_ps(_mm_load_ps(a.m + 12), _mm_set1_ps(v.w)));
+    _mm_store_ps(&r.x, col);
+#else
+    r.x = a.m[0]*v.x + a.m[4]*v.y + a.m[8]*v.z  + a.m[12]*v.w;
+    r.y = a.m[1]*v.x + a.m[5]*v.y + a.m[9]*v.z  + a.m[13]*v.w;
+    r.z = a.m[2]*v.x + a.m[6]*v.y + a.m[10]*v.z + a.m[14]*v.w;
+    r.w = a.m[3]*v.x + a.m[7]*v.y + a.m[11]*v.z + a.m[15]*v.w;
+#endif
+    return r;
+}
+
+#if CUBE_MATH_SSE
+// 2x2 matrices packed row-major as (a b c d)
+#define CUBE_SHUF(v, x, y, z, w) _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x))
+inline __m128 sseMul2(__m128 a, __m128 b){ // a*b
+    return _mm_add_ps(_mm_mul_ps(a, CUBE_SHUF(b, 0,3,0,3)), _mm_mul_ps(CUBE_SHUF(a, 1,0,3,2), CUBE_SHUF(b, 2,1,2,1)));
+}
+inline __m128 sseAdjMul2(__m128 a, __m128 b){ // adj(a)*b
+    return _mm_sub_ps(_mm_mul_ps(CUBE_SHUF(a, 3,3,0,0), b), _mm_mul_ps(CUBE_SHUF(a, 1,1,2,2), CUBE_SHUF(b, 2,3,0,1)));
+}
+inline __m128 sseMulAdj2(__m128 a, __m128 b){ // a*adj(b)
+    return _mm_sub_ps(_mm_mul_ps(a, CUBE_SHUF(b, 3,0,3,0)), _mm_mul_ps(CUBE_SHUF(a, 1,0,3,2), CUBE_SHUF(b, 2,1,2,1)));
+}
+#endif
+
+// General inverse (projections included). A singular matrix gives non-finite values.
+inline Mat4 inverse(const Mat4 &a){
+    Mat4 r;
+#if CUBE_MATH_SSE
+    // Block method on 2x2 sub-matrices. The storage is the transpose of the
+    // matrix, and inverse(transpose(M)) = transpose(inverse(M)), so working on
+    // the columns as if they were rows gives the column-major inverse directly.
+    const __m128 c0 = _mm_load_ps(a.m), c1 = _mm_load_ps(a.m + 4), c2 = _mm_load_ps(a.m + 8), c3 = _mm_load_ps(a.m + 12);
+    const __m128 A = _mm_movelh_ps(c0, c1), B = _mm_movehl_ps(c1, c0);
+    const __m128 C = _mm_movelh_ps(c2, c3), D = _mm_movehl_ps(c3, c2);
+    // (|A| |B| |C| |D|)
+    const __m128 det = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2,0,2,0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3,1,3,1))),
+        _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3,1,3,1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2,0,2,0))));
+    const __m128 detA = CUBE_SHUF(det, 0,0,0,0), detB = CUBE_SHUF(det, 1,1,1,1);
+    const __m128 detC = CUBE_SHUF(det, 2,2,2,2), detD = CUBE_SHUF(det, 3,3,3,3);
+
+    const __m128 DC = sseAdjMul2(D, C);
+    const __m128 AB = sseAdjMul2(A, B);
+    __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), sseMul2(B, DC));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), sseMul2(C, AB));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), sseMulAdj2(D, AB));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), sseMulAdj2(A, DC));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 tr = _mm_mul_ps(AB, CUBE_SHUF(DC, 0,2,1,3));
+    tr = _mm_add_ps(tr, _mm_movehl_ps(tr, tr));
+    tr = _mm_add_ss(tr, CUBE_SHUF(tr, 1,1,1,1));
+    tr = CUBE_SHUF(tr, 0,0,0,0);
+    const __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+    const __m128 rcp = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), detM);
+    X = _mm_mul_ps(X, rcp);
+    Y = _mm_mul_ps(Y, rcp);
+    Z = _mm_mul_ps(Z, rcp);
+    W = _mm_mul_ps(W, rcp);
+    // adjugate swizzle folded into the store
+    _mm_store_ps(r.m,      _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1,3,1,3)));
+    _mm_store_ps(r.m + 4,  _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0,2,0,2)));
+    _mm_store_ps(r.m + 8,  _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1,3,1,3)));
+    _mm_store_ps(r.m + 12, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0,2,0,2)));
+#undef CUBE_SHUF
+#else
+    const float *m = a.m;
+    float *o = r.m;
+    o[0]  =  m[5]*m[10]*m[15] - m[5]*m[11]*m[14] - m[9]*m[6]*m[15] + m[9]*m[7]*m[14] + m[13]*m[6]*m[11] - m[13]*m[7]*m[10];
+    o[4]  = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14] + m[8]*m[6]*m[15] - m[8]*m[7]*m[14] - m[12]*m[6]*m[11] + m[12]*m[7]*m[10];
+    o[8]  =  m[4]*m[9]*m[15]  - m[4]*m[11]*m[13] - m[8]*m[5]*m[15] + m[8]*m[7]*m[13] + m[12]*m[5]*m[11] - m[12]*m[7]*m[9];
+    o[12] = -m[4]*m[9]*m[14]  + m[4]*m[10]*m[13] + m[8]*m[5]*m[14] - m[8]*m[6]*m[13] - m[12]*m[5]*m[10] + m[12]*m[6]*m[9];
+    o[1]  = -m[1]*m[10]*m[15] + m[1]*m[11]*m[14] + m[9]*m[2]*m[15] - m[9]*m[3]*m[14] - m[13]*m[2]*m[11] + m[13]*m[3]*m[10];
+    o[5]  =  m[0]*m[10]*m[15] - m[0]*m[11]*m[14] - m[8]*m[2]*m[15] + m[8]*m[3]*m[14] + m[12]*m[2]*m[11] - m[12]*m[3]*m[10];
+    o[9]  = -m[0]*m[9]*m[15]  + m[0]*m[11]*m[13] + m[8]*m[1]*m[15] - m[8]*m[3]*m[13] - m[12]*m[1]*m[11] + m[12]*m[3]*m[9];
+    o[13] =  m[0]*m[9]*m[14]  - m[0]*m[10]*m[13] - m[8]*m[1]*m[14] + m[8]*m[2]*m[13] + m[12]*m[1]*m[10] - m[12]*m[2]*m[9];
+    o[2]  =  m[1]*m[6]*m[15]  - m[1]*m[7]*m[14]  - m[5]*m[2]*m[15] + m[5]*m[3]*m[14] + m[13]*m[2]*m[7]  - m[13]*m[3]*m[6];
+    o[6]  = -m[0]*m[6]*m[15]  + m[0]*m[7]*m[14]  + m[4]*m[2]*m[15] - m[4]*m[3]*m[14] - m[12]*m[2]*m[7]  + m[12]*m[3]*m[6];
+    o[10] =  m[0]*m[5]*m[15]  - m[0]*m[7]*m[13]  - m[4]*m[1]*m[15] + m[4]*m[3]*m[13] + m[12]*m[1]*m[7]  - m[12]*m[3]*m[5];
+    o[14] = -m[0]*m[5]*m[14]  + m[0]*m[6]*m[13]  + m[4]*m[1]*m[14] - m[4]*m[2]*m[13] - m[12]*m[1]*m[6]  + m[12]*m[2]*m[5];
+    o[3]  = -m[1]*m[6]*m[11]  + m[1]*m[7]*m[10]  + m[5]*m[2]*m[11] - m[5]*m[3]*m[10] - m[9]*m[2]*m[7]   + m[9]*m[3]*m[6];
+    o[7]  =  m[0]*m[6]*m[11]  - m[0]*m[7]*m[10]  - m[4]*m[2]*m[11] + m[4]*m[3]*m[10] + m[8]*m[2]*m[7]   - m[8]*m[3]*m[6];
+    o[11] = -m[0]*m[5]*m[11]  + m[0]*m[7]*m[9]   + m[4]*m[1]*m[11] - m[4]*m[3]*m[9]  - m[8]*m[1]*m[7]   + m[8]*m[3]*m[5];
+    o[15] =  m[0]*m[5]*m[10]  - m[0]*m[6]*m[9]   - m[4]*m[1]*m[10] + m[4]*m[2]*m[9]  + m[8]*m[1]*m[6]   - m[8]*m[2]*m[5];
+    const float det = m[0]*o[0] + m[1]*o[4] + m[2]*o[8] + m[3]*o[12];
+    const float inv = 1.f / det;
+    for (float &v : r.m) v *= inv;
+#endif
+    return r;
+}
+
+// Six planes (a, b, c, d) with unit normals pointing inwards: a point p is
+// inside a plane when a*p.x + b*p.y + c*p.z + d >= 0.
+struct Frustum {
+    enum { LEFT, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, COUNT };
+    Vec4 planes[COUNT];
+
+    // false only when the box is entirely outside one plane (conservative near corners)
+    bool intersectsAABB(const sf::Vector3f &lo, const sf::Vector3f &hi) const {
+        for (const Vec4 &p : planes){
+            // the box corner furthest along the plane normal
+            const float x = p.x >= 0.f ? hi.x : lo.x;
+            const float y = p.y >= 0.f ? hi.y : lo.y;
+            const float z = p.z >= 0.f ? hi.z : lo.z;
+            if (p.x*x + p.y*y + p.z*z + p.w < 0.f) return false;
+        }
+        return true;
+    }
+};
+
+// Gribb-Hartmann: the clip-space planes are sums and differences of the rows
+// of viewProj, giving world-space planes.
+inline Frustum extractFrustum(const Mat4 &viewProj){
+    Frustum f;
+#if CUBE_MATH_SSE
+    __m128 r0 = _mm_load_ps(viewProj.m), r1 = _mm_load_ps(viewProj.m + 4);
+    __m128 r2 = _mm_load_ps(viewProj.m + 8), r3 = _mm_load_ps(viewProj.m + 12);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3); // columns -> rows
+    __m128 p[Frustum::COUNT] = {
+        _mm_add_ps(r3, r0), _mm_sub_ps(r3, r0),
+        _mm_add_ps(r3, r1), _mm_sub_ps(r3, r1),
+        _mm_add_ps(r3, r2), _mm_sub_ps(r3, r2),
+    };
+    const __m128 xyzMask = _mm_setr_ps(1.f, 1.f, 1.f, 0.f);
+    for (int i = 0; i < Frustum::COUNT; ++i){
+        __m128 sq = _mm_mul_ps(_mm_mul_ps(p[i], p[i]), xyzMask);
+        sq = _mm_add_ps(sq, _mm_movehl_ps(sq, sq));
+        sq = _mm_add_ss(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1,1,1,1)));
+        const __m128 len = _mm_sqrt_ps(_mm_shuffle_ps(sq, sq, _MM_SHUFFLE(0,0,0,0)));
+        _mm_store_ps(&f.planes[i].x, _mm_div_ps(p[i], len));
+    }
+#else
+    const float *m = viewProj.m;
+    auto row = [m](int i){ return Vec4{m[i], m[4+i], m[8+i], m[12+i]}; };
+    const Vec4 r[4] = {row(0), row(1), row(2), row(3)};
+    for (int i = 0; i < Frustum::COUNT; ++i){
+        const Vec4 &a = r[i / 2];
+        const float s = (i % 2) ? -1.f : 1.f;
+        Vec4 p{r[3].x + s*a.x, r[3].y + s*a.y, r[3].z + s*a.z, r[3].w + s*a.w};
+        const float len = std::sqrt(p.x*p.x + p.y*p.y + p.z*p.z);
+        f.planes[i] = Vec4{p.x/len, p.y/len, p.z/len, p.w/len};
+    }
+#endif
+    return f;
+}
+
+// Same matrix glFrustum(-r, r, -t, t, n, f) builds for a symmetric frustum
+inline Mat4 perspective(float fovYDeg, float aspect, float znear, float zfar){
+    const float top = znear * std::tan(fovYDeg * DEG_TO_RAD * 0.5f);
+    const float right = top * aspect;
+    Mat4 p;
+    p.m[0] = znear / right;
+    p.m[5] = znear / top;
+    p.m[10] = -(zfar + znear) / (zfar - znear);
+    p.m[11] = -1.f;
+    p.m[14] = -2.f * zfar * znear / (zfar - znear);
+    p.m[15] = 0.f;
+    return p;
+}
+
+inline Mat4 lookAt(const sf::Vector3f &eye, const sf::Vector3f &center, const sf::Vector3f &up){
+    const sf::Vector3f f = normalize(center - eye);
+    const sf::Vector3f s = normalize(cross(f, up));
+    const sf::Vector3f u = cross(s, f);
+    Mat4 v;
+    v.m[0] = s.x; v.m[4] = s.y; v.m[8]  = s.z;
+    v.m[1] = u.x; v.m[5] = u.y; v.m[9]  = u.z;
+    v.m[2] = -f.x; v.m[6] = -f.y; v.m[10] = -f.z;
+    v.m[12] = -dot(s, eye);
+    v.m[13] = -dot(u, eye);
+    v.m[14] = dot(f, eye);
+    return v;
+}
+
+inline Mat4 translation(const sf::Vector3f &t){
+    Mat4 r;
+    r.m[12] = t.x; r.m[13] = t.y; r.m[14] = t.z;
+    return r;
+}
@@ -0,0 +1,123 @@
+#include "net_protocol.h"
+
+static sf::Packet begin(MsgType t){
+    sf::Packet p;
+    p << static_cast<uint8_t>(t);
+    return p;
+}
+
+sf::Packet makeHello(const std::string &name){
+    sf::Packet p = begin(MsgType::Hello);
+    p << PROTOCOL_VERSION << name;
+    return p;
+}
+
+sf::Packet makeWelcome(const WelcomeMsg &m){
+    sf::Packet p = begin(MsgType::Welcome);
+    p << m.playerId << m.seed << m.tickRate;
+    return p;
+}
+
+sf::Packet makeInput(const InputMsg &m){
+    sf::Packet p = begin(MsgType::Input);
+    p << m.tick << m.moveX << m.moveZ << m.yawDeg << m.jump;
+    return p;
+}
+
+sf::Packet makeEdit(MsgType type, const EditMsg &m){
+    sf::Packet p = begin(type);
+    p << m.x << m.y << m.z << m.block;
+    return p;
+}
+
+sf::Packet makeChunkData(const Chunk &c){
+    std::vector<uint8_t> encoded;
+    encodeChunk(c, encoded);
+    return makeChunkData(c.pos, c.version, encoded);
+}
+
+sf::Packet makeChunkData(ChunkPos pos, uint32_t version, const std::vector<uint8_t> &encoded){
+    sf::Packet p = begin(MsgType::ChunkData);
+    p << static_cast<int32_t>(pos.x) << static_cast<int32_t>(pos.z) << version;
+    p.append(encoded.data(), encoded.size()); // rest of the packet is the payload
+    return p;
+}
+
+sf::Packet makeChunkDelta(ChunkPos pos, uint32_t baseVersion, uint32_t version, const std::vector<uint8_t> &encoded){
+    sf::Packet p = begin(MsgType::ChunkDelta);
+    p << static_cast<int32_t>(pos.x) << static_cast<int32_t>(pos.z) << baseVersion << version;
+    p.append(encoded.data(), encoded.size());
+    return p;
+}
+
+sf::Packet makeEntityUpdate(const std::vector<EntityState> &entities){
+    sf::Packet p = begin(MsgType::EntityUpdate);
+    p << static_cast<uint32_t>(entities.size());
+    for (const auto &e : entities) p << e.id << e.x << e.y << e.z << e.yawDeg;
+    return p;
+}
+
+sf::Packet makeEntityRemove(uint32_t id){
+    sf::Packet p = begin(MsgType::EntityRemove);
+    p << id;
+    return p;
+}
+
+sf::Packet makeRegionEdit(const RegionEditMsg &m){
+    sf::Packet p = begin(MsgType::RegionEdit);
+    p << m.op << m.x0 << m.y0 << m.z0 << m.x1 << m.y1 << m.z1 << m.block << m.mask << m.turns << m.skipAir;
+    return p;
+}
+
+bool readHello(sf::Packet &p, uint32_t &version, std::string &name){
+    return static_cast<bool>(p >> version >> name);
+}
+
+bool readWelcome(sf::Packet &p, WelcomeMsg &m){
+    return static_cast<bool>(p >> m.playerId >> m.seed >> m.tickRate);
+}
+
+bool readInput(sf::Packet &p, InputMsg &m){
+    return static_cast<bool>(p >> m.tick >> m.moveX >> m.moveZ >> m.yawDeg >> m.jump);
+}
+
+bool readEdit(sf::Packet &p, EditMsg &m){
+    return static_cast<bool>(p >> m.x >> m.y >> m.z >> m.block);
+}
+
+static const uint8_t* remaining(sf::Packet &p, size_t &size){
+    size = p.getDataSize() - p.getReadPosition();
+    return static_cast<const uint8_t*>(p.getData()) + p.getReadPosition();
+}
+
+bool readChunkData(sf::Packet &p, Chunk &c){
+    int32_t cx = 0, cz = 0;
+    if (!(p >> cx >> cz >> c.version)) return false;
+    c.pos = { cx, cz };
+    size_t size = 0;
+    const uint8_t *data = remaining(p, size);
+    return decodeChunk(data, size, c);
+}
+
+bool readChunkDelta(sf::Packet &p, ChunkPos &pos, uint32_t &baseVersion, uint32_t &version, std::vector<BlockDelta> &deltas){
+    int32_t cx = 0, cz = 0;
+    if (!(p >> cx >> cz >> baseVersion >> version)) return false;
+    pos = { cx, cz };
+    size_t size = 0;
+    const uint8_t *data = remaining(p, size);
+    return decodeDeltas(data, size, deltas);
+}
+
+bool readEntityUpdate(sf::Packet &p, std::vector<EntityState> &out){
+    uint32_t n = 0;
+    if (!(p >> n)) return false;
+    if (n > (p.getDataSize() - p.getReadPosition()) / 20) return false; // 20 bytes per entity
+    out.resize(n);
+    for (auto &e : out)
+        if (!(p >> e.id >> e.x >> e.y >> e.z >> e.yawDeg)) return false;
+    return true;
+}
+
+bool readRegionEdit(sf::Packet &p, RegionEditMsg &m){
+    return static_cast<bool>(p >> m.op >> m.x0 >> m.y0 >> m.z0 >> m.x1 >> m.y1 >> m.z1 >> m.block >> m.mask >> m.turns >> m.skipAir);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "chunk_codec.h"
+#include "voxel_world.h"
+
+// Client/server messages over TCP, one sf::Packet per message. Every packet
+// starts with a MsgType byte.
+const unsigned short DEFAULT_SERVER_PORT = 27015;
+const uint32_t PROTOCOL_VERSION = 3;
+
+enum class MsgType : uint8_t {
+    Hello = 1,      // c->s: protocol version, name
+    Welcome,        // s->c: player id, world seed, tick rate
+    Input,          // c->s: InputMsg
+    Edit,           // c->s: EditMsg
+    ChunkData,      // s->c: full chunk, encodeChunk() payload
+    ChunkDelta,     // s->c: edits to a chunk the client has, encodeDeltas() payload
+    EntityUpdate,   // s->c: positions of the other players in range
+    EntityRemove,   // s->c: player left
+    RegionEdit      // c->s: RegionEditMsg, a builder's bulk edit
+};
+
+struct InputMsg {
+    uint32_t tick = 0;
+    float moveX = 0.f, moveZ = 0.f; // desired walk direction (world XZ, length <= 1)
+    float yawDeg = 0.f;
+    bool jump = false;
+};
+
+struct EditMsg {
+    int32_t x = 0, y = 0, z = 0;
+    uint16_t block = 0;
+};
+
+enum class RegionOp : uint8_t { Fill, Replace, Copy, Paste, Undo };
+
+// Corners in any order. Paste puts the sender's clipboard with its lowest
+// corner at (x0, y0, z0); Undo reverts the sender's last fill, replace or paste.
+struct RegionEditMsg {
+    uint8_t op = 0;             // RegionOp
+    int32_t x0 = 0, y0 = 0, z0 = 0;
+    int32_t x1 = 0, y1 = 0, z1 = 0;
+    uint16_t block = 0;         // Fill, Replace: the block written
+    uint32_t mask = 0;          // Replace: bit i set replaces block id i
+    uint8_t turns = 0;          // Paste: quarter turns about +Y
+    bool skipAir = false;       // Paste: leave the world alone where the clipboard is air
+};
+
+struct EntityState {
+    uint32_t id = 0;
+    float x = 0.f, y = 0.f, z = 0.f, yawDeg = 0.f;
+};
+
+struct WelcomeMsg {
+    uint32_t playerId = 0;
+    uint32_t seed = 0;
+    float tickRate = 0.f;
+};
+
+// Bytes a packet occupies on the wire (SFML prefixes a 32-bit size)
+inline size_t wireSize(const sf::Packet &p){ return p.getDataSize() + 4; }
+
+sf::Packet makeHello(const std::string &name);
+sf::Packet makeWelcome(const WelcomeMsg &m);
+sf::Packet makeInput(const InputMsg &m);
+sf::Packet makeEdit(MsgType type, const EditMsg &m);
+sf::Packet makeChunkData(const Chunk &c);
+sf::Packet makeChunkData(ChunkPos pos, uint32_t version, const std::vector<uint8_t> &encoded);
+// baseVersion is the chunk version the deltas apply on top of
+sf::Packet makeChunkDelta(ChunkPos pos, uint32_t baseVersion, uint32_t version, const std::vector<uint8_t> &encoded);
+sf::Packet makeEntityUpdate(const std::vector<EntityState> &entities);
+sf::Packet makeEntityRemove(uint32_t id);
+sf::Packet makeRegionEdit(const RegionEditMsg &m);
+
+// Readers expect the MsgType byte to have been consumed already.
+bool readHello(sf::Packet &p, uint32_t &version, std::string &name);
+bool readWelcome(sf::Packet &p, WelcomeMsg &m);
+bool readInput(sf::Packet &p, InputMsg &m);
+bool readEdit(sf::Packet &p, EditMsg &m);
+bool readChunkData(sf::Packet &p, Chunk &c);
+bool readChunkDelta(sf::Packet &p, ChunkPos &pos, uint32_t &baseVersion, uint32_t &version, std::vector<BlockDelta> &deltas);
+bool readEntityUpdate(sf::Packet &p, std::vector<EntityState> &out);
+bool readRegionEdit(sf::Packet &p, RegionEditMsg &m);
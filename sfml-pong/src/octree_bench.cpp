@@ -0,0 +1,190 @@
+#include "octree_bench.h"
+#include "voxel_octree.h"
+#include "voxel_world.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+using BenchClock = std::chrono::steady_clock;
+static volatile size_t benchSink; // keeps the timed loops from being optimised away
+
+static double secondsSince(BenchClock::time_point t0){
+    return std::chrono::duration<double>(BenchClock::now() - t0).count();
+}
+
+// Amanatides-Woo walk through the chunk grid one block at a time, limited to
+// the same cube as the octree so both answer the same question.
+static bool gridRaycast(const VoxelWorld &world, sf::Vector3i lo, int size,
+                        const sf::Vector3f &from, const sf::Vector3f &dir, float maxDistance, RayHit &hit){
+    const float len = std::sqrt(dir.x*dir.x + dir.y*dir.y + dir.z*dir.z);
+    if (len == 0.f) return false;
+    const float o[3] = { from.x - lo.x, from.y - lo.y, from.z - lo.z };
+    const float d[3] = { dir.x / len, dir.y / len, dir.z / len };
+    const float inf = std::numeric_limits<float>::infinity();
+
+    float t = 0.f, tEnd = maxDistance;
+    int axis = -1;
+    for (int a = 0; a < 3; ++a){
+        if (d[a] == 0.f){
+            if (o[a] < 0.f || o[a] >= size) return false;
+            continue;
+        }
+        float t0 = (0.f - o[a]) / d[a], t1 = (size - o[a]) / d[a];
+        if (t0 > t1) std::swap(t0, t1);
+        if (t0 > t){ t = t0; axis = a; }
+        tEnd = std::min(tEnd, t1);
+    }
+    if (t > tEnd) return false;
+
+    int cell[3], step[3];
+    float tMax[3], tDelta[3];
+    for (int a = 0; a < 3; ++a){
+        cell[a] = std::clamp(static_cast<int>(std::floor(o[a] + d[a] * t)), 0, size - 1);
+        step[a] = d[a] > 0.f ? 1 : -1;
+        tDelta[a] = d[a] != 0.f ? std::abs(1.f / d[a]) : inf;
+    }
+    if (axis >= 0) cell[axis] = d[axis] > 0.f ? 0 : size - 1;
+    for (int a = 0; a < 3; ++a)
+        tMax[a] = d[a] == 0.f ? inf : ((d[a] > 0.f ? cell[a] + 1 : cell[a]) - o[a]) / d[a];
+
+    const Chunk *c = nullptr;
+    ChunkPos cached{};
+    for (;;){
+        const int x = cell[0] + lo.x, y = cell[1] + lo.y, z = cell[2] + lo.z;
+        if (y >= 0 && y < CHUNK_HEIGHT){
+            const ChunkPos p = chunkOf(x, z);
+            if (!c || p != cached){ c = world.findChunk(p); cached = p; }
+            const BlockId id = c ? c->get(floorMod(x, CHUNK_SIZE), y, floorMod(z, CHUNK_SIZE)) : BlockId(BLOCK_AIR);
+            if (id != BLOCK_AIR){
+                hit.x = x; hit.y = y; hit.z = z;
+                hit.id = id;
+                hit.distance = t;
+                hit.normalAxis = axis;
+                return true;
+            }
+        }
+        axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+        if (tMax[axis] > tEnd) return false;
+        cell[axis] += step[axis];
+        if (cell[axis] < 0 || cell[axis] >= size) return false;
+        t = tMax[axis];
+        tMax[axis] += tDelta[axis];
+    }
+}
+
+struct Ray { sf::Vector3f from, dir; };
+
+static bool sameHit(bool a, const RayHit &ha, bool b, const RayHit &hb){
+    if (a != b) return false;
+    return !a || (ha.x == hb.x && ha.y == hb.y && ha.z == hb.z && ha.id == hb.id);
+}
+
+// Times both walks over the same rays, repeating until each has run for a
+// while, and counts the rays where they disagree.
+static void benchRays(const char *name, const VoxelWorld &world, const VoxelOctree &tree,
+                      const std::vector<Ray> &rays, float maxDistance){
+    const sf::Vector3i lo = tree.origin();
+    const int size = tree.size();
+    size_t hits = 0, mismatches = 0;
+    for (const Ray &r : rays){
+        RayHit a, b;
+        const bool ha = tree.raycast(r.from, r.dir, maxDistance, a);
+        const bool hb = gridRaycast(world, lo, size, r.from, r.dir, maxDistance, b);
+        hits += ha ? 1 : 0;
+        mismatches += sameHit(ha, a, hb, b) ? 0 : 1;
+    }
+
+    size_t svoRays = 0, gridRays = 0, sink = 0;
+    RayHit h;
+    auto t0 = BenchClock::now();
+    do {
+        for (const Ray &r : rays) sink += tree.raycast(r.from, r.dir, maxDistance, h) ? 1 : 0;
+        svoRays += rays.size();
+    } while (secondsSince(t0) < 0.3);
+    const double svoSeconds = secondsSince(t0);
+    t0 = BenchClock::now();
+    do {
+        for (const Ray &r : rays) sink += gridRaycast(world, lo, size, r.from, r.dir, maxDistance, h) ? 1 : 0;
+        gridRays += rays.size();
+    } while (secondsSince(t0) < 0.3);
+    const double gridSeconds = secondsSince(t0);
+    benchSink = sink;
+
+    const double svoRate = svoRays / svoSeconds, gridRate = gridRays / gridSeconds;
+    std::printf("  %-14s %6.2f M rays/s octree, %6.2f M rays/s grid (%.1fx), %zu/%zu hit, %zu mismatched\n",
+        name, svoRate / 1e6, gridRate / 1e6, svoRate / gridRate, hits, rays.size(), mismatches);
+}
+
+int runOctreeBench(unsigned seed, int radius){
+    int side = 1;
+    while (side < (2 * radius + 1) * CHUNK_SIZE) side *= 2;
+    const sf::Vector3i lo(-side / 2, 0, -side / 2);
+
+    VoxelWorld world(seed);
+    auto t0 = BenchClock::now();
+    for (int z = lo.z; z < lo.z + side; z += CHUNK_SIZE)
+        for (int x = lo.x; x < lo.x + side; x += CHUNK_SIZE) world.chunk(chunkOf(x, z));
+    const double generateSeconds = secondsSince(t0);
+
+    VoxelOctree tree(lo, side);
+    t0 = BenchClock::now();
+    tree.build(world);
+    const double buildSeconds = secondsSince(t0);
+
+    const ChunkMemoryStats mem = world.memoryStats();
+    const double rawBytes = static_cast<double>(mem.chunks) * CHUNK_VOLUME * sizeof(BlockId);
+    std::printf("%zu chunks, octree %d^3 blocks from (%d,%d,%d)\n", mem.chunks, side, lo.x, lo.y, lo.z);
+    std::printf("  generate       %8.1f ms\n", generateSeconds * 1000.0);
+    std::printf("  octree build   %8.1f ms, %zu nodes\n", buildSeconds * 1000.0, tree.nodeCount());
+    std::printf("  memory         %8.1f KB octree, %8.1f KB palette chunks, %8.1f KB raw grid\n",
+        tree.memoryBytes() / 1024.0, mem.bytes / 1024.0, rawBytes / 1024.0);
+
+    // eyes above the surface somewhere in the middle half of the cube
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> inner(-side * 0.25f, side * 0.25f); // the cube is centred on x = z = 0
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    auto eye = [&](float above){
+        const float x = inner(rng), z = inner(rng);
+        const int ground = world.surfaceHeight(static_cast<int>(std::floor(x)), static_cast<int>(std::floor(z)));
+        return sf::Vector3f(x, ground + above, z);
+    };
+    const int RAYS = 20000;
+    const float maxDistance = 256.f;
+
+    std::vector<Ray> horizon, sphere, picking;
+    for (int i = 0; i < RAYS; ++i){
+        const float a = unit(rng) * 3.14159265f;
+        horizon.push_back({ eye(1.6f), { std::cos(a), unit(rng) * 0.05f, std::sin(a) } });
+        sf::Vector3f d;
+        do d = { unit(rng), unit(rng), unit(rng) }; while (d.x*d.x + d.y*d.y + d.z*d.z > 1.f || d == sf::Vector3f());
+        sphere.push_back({ eye(1.f + (unit(rng) + 1.f) * 20.f), d });
+        picking.push_back({ eye(1.6f), { unit(rng), -0.3f - (unit(rng) + 1.f) * 0.35f, unit(rng) } });
+    }
+    benchRays("line of sight", world, tree, horizon, maxDistance);
+    benchRays("any direction", world, tree, sphere, maxDistance);
+    benchRays("picking", world, tree, picking, 8.f);
+
+    // edits go through the world, which mirrors them into the attached tree
+    world.attachOctree(&tree);
+    std::uniform_int_distribution<int> coord(0, side - 1), height(0, CHUNK_HEIGHT - 1), block(0, BLOCK_TYPE_COUNT - 1);
+    const int EDITS = 100000;
+    t0 = BenchClock::now();
+    for (int i = 0; i < EDITS; ++i)
+        world.setBlock(lo.x + coord(rng), height(rng), lo.z + coord(rng), static_cast<BlockId>(block(rng)));
+    const double editSeconds = secondsSince(t0);
+    world.attachOctree(nullptr);
+
+    size_t wrong = 0;
+    for (int z = lo.z; z < lo.z + side; ++z)
+        for (int x = lo.x; x < lo.x + side; ++x)
+            for (int y = 0; y < CHUNK_HEIGHT; ++y)
+                if (tree.get(x, y, z) != world.getBlock(x, y, z)) ++wrong;
+    std::printf("  %d edits      %8.1f ns each (world + octree), %zu nodes after, %zu blocks differ\n",
+        EDITS, editSeconds * 1e9 / EDITS, tree.nodeCount(), wrong);
+    benchRays("after edits", world, tree, sphere, maxDistance);
+    return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// `cube_server --svo-bench R`: builds a sparse voxel octree over the chunks
+// within R chunks of the origin and compares its memory use and ray throughput
+// with the chunk grid walked one block at a time.
+int runOctreeBench(unsigned seed, int radius);
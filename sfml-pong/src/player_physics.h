@@ -0,0 +1,48 @@
+#pragma once
+#include <SFML/System.hpp>
+#include <algorithm>
+#include <cmath>
+
+const float PLAYER_EYE_HEIGHT = 1.62f;
+const float PLAYER_RADIUS = 0.3f;
+
+// Position is the eye; the feet are PLAYER_EYE_HEIGHT below it.
+struct PlayerBody {
+    sf::Vector3f pos{0.f, 2.f, 0.f};
+    float vy = 0.f;
+    bool canJump = false;
+};
+
+// Walking with gravity and simple column collision, shared by the client
+// simulation and the dedicated server. heightAt(x, z) returns the solid column
+// height at integer world coordinates (x = round(pos.x)).
+template <typename HeightFn>
+void stepWalking(PlayerBody &b, float moveX, float moveZ, float gravity, float dt, HeightFn &&heightAt){
+    float oldX = b.pos.x;
+    float oldZ = b.pos.z;
+
+    // attempt X movement
+    b.pos.x += moveX;
+    float footY = b.pos.y - PLAYER_EYE_HEIGHT;
+    if (heightAt(int(std::round(b.pos.x)), int(std::round(b.pos.z))) > footY + 0.2f){ // blocked
+        b.pos.x = oldX; // rollback X
+    }
+
+    // attempt Z movement
+    b.pos.z += moveZ;
+    if (heightAt(int(std::round(b.pos.x)), int(std::round(b.pos.z))) > footY + 0.2f){ // blocked
+        b.pos.z = oldZ; // rollback Z
+    }
+
+    // Apply gravity
+    b.vy -= gravity * dt;
+    b.pos.y += b.vy * dt;
+
+    // ground collision
+    float groundY = static_cast<float>(heightAt(int(std::round(b.pos.x)), int(std::round(b.pos.z)))) + PLAYER_EYE_HEIGHT;
+    if (b.pos.y <= groundY){
+        b.pos.y = groundY;
+        b.vy = 0.f;
+        b.canJump = true;
+    }
+}
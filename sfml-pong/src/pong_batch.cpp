@@ -0,0 +1,111 @@
+#include "pong_batch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+PongBatch::PongBatch(size_t matches, uint32_t seed)
+    : leftY(matches), rightY(matches), ballX(matches), ballY(matches), velX(matches), velY(matches),
+      scoreLeft(matches), scoreRight(matches), rng(matches){
+    for (size_t i = 0; i < matches; ++i){
+        // spread the seeds so neighbouring matches diverge at the first serve
+        uint32_t s = seed ^ static_cast<uint32_t>(i * 0x9e3779b9u);
+        for (int k = 0; k < 4; ++k) s = pongNextRandom(s ? s : 1);
+        const PongState m = pongNewMatch(s);
+        leftY[i] = m.leftY; rightY[i] = m.rightY;
+        ballX[i] = m.ballX; ballY[i] = m.ballY;
+        velX[i] = m.velX; velY[i] = m.velY;
+        scoreLeft[i] = m.scoreLeft; scoreRight[i] = m.scoreRight;
+        rng[i] = m.rng;
+    }
+}
+
+PongState PongBatch::state(size_t i) const{
+    PongState s;
+    s.leftY = leftY[i]; s.rightY = rightY[i];
+    s.ballX = ballX[i]; s.ballY = ballY[i];
+    s.velX = velX[i]; s.velY = velY[i];
+    s.scoreLeft = scoreLeft[i]; s.scoreRight = scoreRight[i];
+    s.rng = rng[i];
+    return s;
+}
+
+size_t PongBatch::step(size_t begin, size_t end, const int8_t *left, const int8_t *right){
+    // the fields as plain pointers, loaded once rather than through this on every store
+    float *ly = leftY.data(), *ry = rightY.data();
+    float *bx = ballX.data(), *by = ballY.data();
+    float *vx = velX.data(), *vy = velY.data();
+    int32_t *sl = scoreLeft.data(), *sr = scoreRight.data();
+    uint32_t *rn = rng.data();
+    const int8_t *in0 = left - begin, *in1 = right - begin;
+    size_t finished = 0;
+    for (size_t i = begin; i < end; ++i){
+        PongState s;
+        s.leftY = ly[i]; s.rightY = ry[i];
+        s.ballX = bx[i]; s.ballY = by[i];
+        s.velX = vx[i]; s.velY = vy[i];
+        s.scoreLeft = sl[i]; s.scoreRight = sr[i];
+        s.rng = rn[i];
+        stepPong(s, PongInput{in0[i], in1[i]});
+        const bool over = (s.scoreLeft >= PONG_WIN_SCORE) | (s.scoreRight >= PONG_WIN_SCORE);
+        finished += over;
+        ly[i] = s.leftY; ry[i] = s.rightY;
+        bx[i] = s.ballX; by[i] = s.ballY;
+        vx[i] = s.velX; vy[i] = s.velY;
+        sl[i] = over ? 0 : s.scoreLeft;
+        sr[i] = over ? 0 : s.scoreRight;
+        rn[i] = s.rng;
+    }
+    return finished;
+}
+
+void PongBatch::trackingInputs(size_t begin, size_t end, int8_t *left, int8_t *right) const{
+    for (size_t i = begin; i < end; ++i){
+        left[i - begin] = pongTrackingMove(ballY[i], velX[i], velY[i], leftY[i], rng[i], true);
+        right[i - begin] = pongTrackingMove(ballY[i], velX[i], velY[i], rightY[i], rng[i], false);
+    }
+}
+
+size_t PongBatch::run(size_t begin, size_t end, int ticks){
+    std::vector<int8_t> left(end - begin), right(end - begin);
+    size_t finished = 0;
+    for (int t = 0; t < ticks; ++t){
+        trackingInputs(begin, end, left.data(), right.data());
+        finished += step(begin, end, left.data(), right.data());
+    }
+    return finished;
+}
+
+int runPongBatch(size_t matches, double seconds, unsigned threads){
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::max<size_t>(matches, 1))));
+    PongBatch batch(matches, 12345);
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> ticks(threads), finished(threads);
+    std::vector<std::thread> workers;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]{
+            // each worker owns a contiguous slice, so no tick needs a barrier
+            const size_t begin = matches * t / threads, end = matches * (t + 1) / threads;
+            const int TICKS_PER_CHECK = 256;
+            while (!stop.load(std::memory_order_relaxed)){
+                finished[t] += batch.run(begin, end, TICKS_PER_CHECK);
+                ticks[t] += static_cast<uint64_t>(TICKS_PER_CHECK) * (end - begin);
+            }
+        });
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &w : workers) w.join();
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    uint64_t totalTicks = 0, totalMatches = 0;
+    for (unsigned t = 0; t < threads; ++t){ totalTicks += ticks[t]; totalMatches += finished[t]; }
+    const double tickRate = totalTicks / elapsed;
+    std::printf("%zu matches on %u threads for %.1f s\n", matches, threads, elapsed);
+    std::printf("  %.1f M match ticks/s (%.0fx real time per match at %.0f Hz)\n",
+        tickRate / 1e6, tickRate / matches * PONG_TICK, 1.0 / PONG_TICK);
+    std::printf("  %.0f matches finished/s (first to %d), %.1f s of play per match\n",
+        totalMatches / elapsed, PONG_WIN_SCORE, totalMatches ? totalTicks * PONG_TICK / totalMatches : 0.0);
+    return 0;
+}
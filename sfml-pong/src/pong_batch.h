@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pong_sim.h"
+
+// Many independent Pong matches stored field by field (structure of arrays),
+// stepped with the same stepPong() as the windowed game. A finished match
+// (first to PONG_WIN_SCORE) is counted and restarts at 0-0, keeping its
+// generator. Different ranges of matches may be stepped on different threads.
+class PongBatch {
+public:
+    // Match i is seeded from seed and i, so results do not depend on how the
+    // matches are split across threads.
+    PongBatch(size_t matches, uint32_t seed);
+
+    size_t size() const { return ballX.size(); }
+    // One tick for matches [begin, end) with one input per match; returns
+    // the number of matches that finished.
+    size_t step(size_t begin, size_t end, const int8_t *left, const int8_t *right);
+    // pongTrackingMove() for both sides of matches [begin, end)
+    void trackingInputs(size_t begin, size_t end, int8_t *left, int8_t *right) const;
+    // ticks of trackingInputs() + step() over [begin, end)
+    size_t run(size_t begin, size_t end, int ticks);
+
+    PongState state(size_t i) const;
+
+private:
+    std::vector<float> leftY, rightY, ballX, ballY, velX, velY;
+    std::vector<int32_t> scoreLeft, scoreRight;
+    std::vector<uint32_t> rng;
+};
+
+// `pong --batch N`: steps N matches on every core for a few seconds with no
+// window and prints ticks and finished matches per second.
+int runPongBatch(size_t matches, double seconds, unsigned threads);
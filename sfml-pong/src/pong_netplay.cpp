@@ -0,0 +1,191 @@
+#include "pong_netplay.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <thread>
+
+using NetClock = std::chrono::steady_clock;
+
+PongNetSession::PongNetSession(const NetplayConfig &cfg)
+    : cfg(cfg), sim(cfg.seed, cfg.side), rng(cfg.port) {}
+
+bool PongNetSession::open(){
+    if (socket.bind(cfg.port) != sf::Socket::Status::Done){
+        std::cerr << "Could not bind UDP port " << cfg.port << "\n";
+        return false;
+    }
+    socket.setBlocking(false);
+    return true;
+}
+
+void PongNetSession::receive(){
+    sf::Packet p;
+    std::optional<sf::IpAddress> from;
+    unsigned short fromPort = 0;
+    while (socket.receive(p, from, fromPort) == sf::Socket::Status::Done){
+        if (fromPort != cfg.peerPort) continue;
+        uint8_t magic = 0, count = 0;
+        uint32_t frame = 0, peerHas = 0, sumFrame = 0, sum = 0, first = 0;
+        int16_t advantage = 0;
+        if (!(p >> magic >> frame >> peerHas >> advantage >> sumFrame >> sum >> first >> count) || magic != 'P') continue;
+        ++received;
+        heard = true;
+        for (uint32_t k = 0; k < count; ++k){
+            int8_t input = 0;
+            if (!(p >> input)) break;
+            sim.addRemoteInput(first + k, input);
+        }
+        // datagrams can arrive out of order: keep the newest of each
+        ack = std::max(ack, peerHas);
+        if (frame >= peerFrame){
+            peerFrame = frame;
+            peerAdvantage = advantage;
+        }
+        if (sumFrame != UINT32_MAX && (checkFrame == UINT32_MAX || sumFrame > checkFrame)){
+            checkFrame = sumFrame;
+            checkSum = sum;
+        }
+    }
+}
+
+void PongNetSession::checkPeerSum(){
+    if (checkFrame == UINT32_MAX) return;
+    uint32_t mine = 0;
+    if (sim.checksum(checkFrame, mine)){
+        if (mine != checkSum){
+            if (desyncCount == 0) std::cerr << "Desync at frame " << checkFrame << "\n";
+            ++desyncCount;
+        }
+        checkFrame = UINT32_MAX;
+    } else if (sim.frame() > checkFrame + ROLLBACK_HISTORY){
+        checkFrame = UINT32_MAX;    // fell out of the history before we had every input
+    }
+}
+
+void PongNetSession::send(){
+    const uint32_t frame = sim.frame();
+    const uint32_t first = std::min(ack, frame);
+    const uint32_t count = std::min<uint32_t>(frame - first, ROLLBACK_HISTORY);
+    // the latest state both peers have every input for
+    uint32_t sumFrame = std::min(sim.confirmedFrame(), ack), sum = 0;
+    if (!sim.checksum(sumFrame, sum)) sumFrame = UINT32_MAX;
+    const int advantage = std::clamp(static_cast<int>(static_cast<int32_t>(frame - peerFrame)), -32768, 32767);
+
+    sf::Packet p;
+    p << uint8_t('P') << frame << sim.confirmedFrame() << static_cast<int16_t>(advantage)
+      << sumFrame << sum << first << static_cast<uint8_t>(count);
+    for (uint32_t f = first; f < first + count; ++f) p << sim.localInput(f);
+
+    if (cfg.lossPercent > 0.0 && std::uniform_real_distribution<double>(0.0, 100.0)(rng) < cfg.lossPercent){
+        ++dropped;
+        return;
+    }
+    const double delayMs = cfg.latencyMs + (cfg.jitterMs > 0.0 ? std::uniform_real_distribution<double>(0.0, cfg.jitterMs)(rng) : 0.0);
+    Delayed d;
+    d.due = NetClock::now() + std::chrono::duration_cast<NetClock::duration>(std::chrono::duration<double, std::milli>(delayMs));
+    const uint8_t *bytes = static_cast<const uint8_t*>(p.getData());
+    d.bytes.assign(bytes, bytes + p.getDataSize());
+    outbox.push_back(std::move(d));
+}
+
+void PongNetSession::flush(){
+    // jitter can let a later datagram overtake an earlier one, as on a real network
+    const auto now = NetClock::now();
+    for (size_t i = 0; i < outbox.size();){
+        if (outbox[i].due > now){ ++i; continue; }
+        if (socket.send(outbox[i].bytes.data(), outbox[i].bytes.size(), sf::IpAddress::LocalHost, cfg.peerPort) == sf::Socket::Status::Done) ++sent;
+        outbox[i] = std::move(outbox.back());
+        outbox.pop_back();
+    }
+}
+
+bool PongNetSession::tick(int8_t local){
+    receive();
+    bool advanced = false;
+    if (heard){
+        // Both peers see the other's frame a one-way trip late, so the
+        // difference of the two advantages is twice how far this one is
+        // really ahead. Waiting a tick now and then lets the other catch up
+        // instead of this side predicting further and further.
+        const int advantage = static_cast<int32_t>(sim.frame() - peerFrame);
+        ++sinceWait;
+        if (!sim.canAdvance()) ++stalls;
+        else if (advantage - peerAdvantage > 2 && sinceWait >= 8){ ++syncWaits; sinceWait = 0; }
+        else { sim.advance(local); advanced = true; }
+    }
+    checkPeerSum();
+    send();
+    flush();
+    return advanced;
+}
+
+void PongNetSession::idle(){
+    receive();
+    sim.rollback();
+    checkPeerSum();
+    send();
+    flush();
+}
+
+void PongNetSession::report(double seconds){
+    const PongRollbackStats &st = sim.stats();
+    std::printf("[netplay] frame %u, %d ahead of peer | %.0f rollbacks/s, %.1f frames avg, %d max, worst frame %.3f ms"
+        " | %llu stalls, %llu sync waits | %llu sent, %llu received, %llu dropped | %llu desyncs\n",
+        sim.frame(), static_cast<int32_t>(sim.frame() - peerFrame),
+        st.rollbacks / seconds, st.rollbacks ? double(st.resimulated) / st.rollbacks : 0.0, st.maxRollbackFrames,
+        st.worstAdvanceSeconds * 1000.0,
+        static_cast<unsigned long long>(stalls), static_cast<unsigned long long>(syncWaits),
+        static_cast<unsigned long long>(sent), static_cast<unsigned long long>(received),
+        static_cast<unsigned long long>(dropped), static_cast<unsigned long long>(desyncCount));
+    sim.resetStats();
+    stalls = syncWaits = sent = received = dropped = 0;
+}
+
+int runHeadlessNetplay(const NetplayConfig &cfg, uint32_t frames){
+    PongNetSession session(cfg);
+    if (!session.open()) return 1;
+    std::printf("Headless %s paddle on UDP %u, peer on %u (latency %.0f ms, jitter %.0f ms, loss %.0f%%)\n",
+        cfg.side == 0 ? "left" : "right", cfg.port, cfg.peerPort, cfg.latencyMs, cfg.jitterMs, cfg.lossPercent);
+
+    const auto tickDuration = std::chrono::duration_cast<NetClock::duration>(std::chrono::duration<double>(PONG_TICK));
+    const auto started = NetClock::now();
+    auto next = started, lastReport = started;
+    std::optional<NetClock::time_point> done;
+    for (;;){
+        const PongRollback &game = session.game();
+        if (game.frame() < frames){
+            const PongState &s = game.state();
+            const bool left = cfg.side == 0;
+            session.tick(pongTrackingMove(s.ballY, s.velX, s.velY, left ? s.leftY : s.rightY, s.rng, left));
+        } else {
+            session.idle();
+        }
+
+        const auto now = NetClock::now();
+        // once both have every input, keep sending for a while so the peer
+        // hears that too, through whatever the shim drops
+        if (!done && game.frame() >= frames && game.confirmedFrame() >= frames && session.peerAck() >= frames) done = now;
+        if (done && now - *done > std::chrono::duration<double, std::milli>(1000.0 + cfg.latencyMs + cfg.jitterMs)) break;
+        if (!session.connected() && now - started > std::chrono::seconds(30)){
+            std::cerr << "No datagram from port " << cfg.peerPort << " in 30 s\n";
+            return 1;
+        }
+        const double sinceReport = std::chrono::duration<double>(now - lastReport).count();
+        if (sinceReport >= 2.0){
+            session.report(sinceReport);
+            lastReport = now;
+        }
+
+        next += tickDuration;
+        if (now > next + tickDuration * 4) next = now;
+        std::this_thread::sleep_until(next);
+    }
+
+    uint32_t sum = 0;
+    const bool have = session.game().checksum(frames, sum);
+    const PongState &s = session.game().state();
+    std::printf("Frame %u: state %08x, score %d - %d, %llu desyncs\n", frames, have ? sum : 0u,
+        s.scoreLeft, s.scoreRight, static_cast<unsigned long long>(session.desyncs()));
+    return have && session.desyncs() == 0 ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "pong_rollback.h"
+
+// Two-player Pong between two processes over UDP, on top of PongRollback.
+// Every tick each peer sends one datagram holding all its inputs the other
+// has not acknowledged yet, so a lost or late datagram is covered by the
+// next one and nothing is ever re-requested.
+//
+// Datagram: u8 'P', u32 frame, u32 ack (remote inputs held), i16 advantage,
+// u32 checksum frame, u32 checksum, u32 first input frame, u8 count, then
+// count i8 inputs.
+const unsigned short DEFAULT_PONG_PORT = 27020;
+
+struct NetplayConfig {
+    unsigned short port = DEFAULT_PONG_PORT;        // ours
+    unsigned short peerPort = DEFAULT_PONG_PORT + 1; // the other process, on localhost
+    int side = 0;                   // 0 left paddle, 1 right
+    uint32_t seed = 1;              // both peers must use the same one
+    // test shim: what we send is held back latency + [0, jitter] ms and a
+    // share of it dropped (each process delays its own datagrams, so a round
+    // trip sees both)
+    double latencyMs = 0.0, jitterMs = 0.0, lossPercent = 0.0;
+};
+
+class PongNetSession {
+public:
+    explicit PongNetSession(const NetplayConfig &cfg);
+
+    bool open();
+    // Something has arrived from the peer; the match starts then
+    bool connected() const { return heard; }
+
+    // One fixed tick: reads what arrived, advances with this side's input
+    // unless waiting for the peer, and sends. Returns whether it advanced.
+    bool tick(int8_t local);
+    // The same without advancing, once this side has played all it wants to
+    void idle();
+
+    const PongRollback &game() const { return sim; }
+    uint32_t peerAck() const { return ack; }
+    uint64_t desyncs() const { return desyncCount; }
+    // prints what happened since the last report
+    void report(double seconds);
+
+private:
+    void receive();
+    void send();
+    void flush();
+    void checkPeerSum();
+
+    NetplayConfig cfg;
+    sf::UdpSocket socket;
+    PongRollback sim;
+    bool heard = false;
+    uint32_t ack = 0;               // the peer holds our inputs before this
+    uint32_t peerFrame = 0;         // latest frame the peer reported
+    int peerAdvantage = 0;          // how far it thinks it is ahead of us
+    uint32_t sinceWait = 0;
+    uint32_t checkFrame = UINT32_MAX, checkSum = 0; // peer's checksum, compared once we have that frame
+
+    struct Delayed { std::chrono::steady_clock::time_point due; std::vector<uint8_t> bytes; };
+    std::vector<Delayed> outbox;
+    std::mt19937 rng;
+
+    uint64_t stalls = 0, syncWaits = 0, sent = 0, received = 0, dropped = 0, desyncCount = 0;
+};
+
+// `pong --headless`: plays this side with pongTrackingMove() until `frames`
+// frames are confirmed by both peers, then prints the state checksum there,
+// which must match the other process.
+int runHeadlessNetplay(const NetplayConfig &cfg, uint32_t frames);
@@ -0,0 +1,147 @@
+#include "pong_rollback.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+using RollbackClock = std::chrono::steady_clock;
+
+PongRollback::PongRollback(uint32_t seed, int side) : side_(side), now(pongNewMatch(seed)){
+    std::fill(std::begin(remoteTag), std::end(remoteTag), UINT32_MAX);
+}
+
+int8_t PongRollback::remoteFor(uint32_t f) const{
+    const int i = f % ROLLBACK_HISTORY;
+    if (remoteTag[i] == f) return remote[i];
+    // guess: the player is still pressing what they pressed last
+    return remoteKnown > 0 ? remote[(remoteKnown - 1) % ROLLBACK_HISTORY] : 0;
+}
+
+void PongRollback::simulate(uint32_t f){
+    const int i = f % ROLLBACK_HISTORY;
+    snapshots[i] = now;
+    used[i] = remoteFor(f);
+    PongInput in;
+    in.left = side_ == 0 ? local[i] : used[i];
+    in.right = side_ == 0 ? used[i] : local[i];
+    stepPong(now, in);
+}
+
+void PongRollback::rollback(){
+    if (rollbackFrom < current){
+        const int frames = static_cast<int>(current - rollbackFrom);
+        now = snapshots[rollbackFrom % ROLLBACK_HISTORY];
+        for (uint32_t f = rollbackFrom; f < current; ++f) simulate(f);
+        ++stats_.rollbacks;
+        stats_.resimulated += frames;
+        stats_.maxRollbackFrames = std::max(stats_.maxRollbackFrames, frames);
+    }
+    rollbackFrom = UINT32_MAX;
+}
+
+void PongRollback::advance(int8_t input){
+    const auto t0 = RollbackClock::now();
+    rollback();
+    local[current % ROLLBACK_HISTORY] = input;
+    simulate(current);
+    ++current;
+    ++stats_.frames;
+    stats_.worstAdvanceSeconds = std::max(stats_.worstAdvanceSeconds,
+        std::chrono::duration<double>(RollbackClock::now() - t0).count());
+}
+
+void PongRollback::addRemoteInput(uint32_t f, int8_t input){
+    // anything before remoteKnown is already final; the peer cannot be more
+    // than a window ahead of us
+    if (f < remoteKnown || f >= current + ROLLBACK_WINDOW) return;
+    const int i = f % ROLLBACK_HISTORY;
+    if (remoteTag[i] == f) return;
+    remote[i] = input;
+    remoteTag[i] = f;
+    while (remoteTag[remoteKnown % ROLLBACK_HISTORY] == remoteKnown) ++remoteKnown;
+    // frame f itself may have been guessed wrong, and so may later ones whose
+    // guess now repeats a different input
+    for (uint32_t g = f; g < current; ++g)
+        if (used[g % ROLLBACK_HISTORY] != remoteFor(g)){ rollbackFrom = std::min(rollbackFrom, g); break; }
+}
+
+bool PongRollback::checksum(uint32_t f, uint32_t &out) const{
+    if (f > current || f > remoteKnown || f > rollbackFrom || current - f > static_cast<uint32_t>(ROLLBACK_HISTORY)) return false;
+    out = pongChecksum(f == current ? now : snapshots[f % ROLLBACK_HISTORY]);
+    return true;
+}
+
+uint32_t pongChecksum(const PongState &s){
+    // FNV-1a over the fields (not the struct, which could have padding)
+    uint32_t h = 2166136261u;
+    auto mix = [&](const void *p, size_t n){
+        const unsigned char *b = static_cast<const unsigned char*>(p);
+        for (size_t i = 0; i < n; ++i){ h ^= b[i]; h *= 16777619u; }
+    };
+    mix(&s.leftY, 4); mix(&s.rightY, 4);
+    mix(&s.ballX, 4); mix(&s.ballY, 4);
+    mix(&s.velX, 4); mix(&s.velY, 4);
+    mix(&s.scoreLeft, 4); mix(&s.scoreRight, 4);
+    mix(&s.rng, 4);
+    return h;
+}
+
+int runRollbackBench(double seconds){
+    const uint32_t seed = 2024;
+    PongRollback peers[2] = { PongRollback(seed, 0), PongRollback(seed, 1) };
+    struct Sent { uint32_t frame; int8_t input; };
+    std::deque<Sent> wire[2];          // inputs on their way to the other peer
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> press(-1, 1);
+    const uint32_t lag = ROLLBACK_WINDOW - 1;
+
+    // press a random direction every frame, so the repeat-the-last guess is
+    // wrong two times in three and rollbacks reach the oldest frame sent
+    std::vector<double> costs;
+    const auto t0 = RollbackClock::now();
+    uint32_t frame = 0;
+    while (std::chrono::duration<double>(RollbackClock::now() - t0).count() < seconds){
+        for (int p = 0; p < 2; ++p){
+            PongRollback &me = peers[p];
+            std::deque<Sent> &in = wire[1 - p];
+            while (!in.empty() && in.front().frame + lag <= frame){
+                me.addRemoteInput(in.front().frame, in.front().input);
+                in.pop_front();
+            }
+            const int8_t input = static_cast<int8_t>(press(rng));
+            const auto a = RollbackClock::now();
+            me.advance(input);
+            costs.push_back(std::chrono::duration<double>(RollbackClock::now() - a).count());
+            wire[p].push_back({frame, input});
+        }
+        ++frame;
+    }
+    // deliver the rest; both must then agree on the final state
+    for (int p = 0; p < 2; ++p)
+        for (const Sent &s : wire[1 - p]) peers[p].addRemoteInput(s.frame, s.input);
+    const uint32_t end = frame;
+    uint32_t sum[2] = {};
+    bool ok = true;
+    for (int p = 0; p < 2; ++p){
+        peers[p].advance(0);
+        ok &= peers[p].checksum(end, sum[p]);
+    }
+    ok &= sum[0] == sum[1];
+
+    std::sort(costs.begin(), costs.end());
+    auto pct = [&](double q){ return costs[std::min(costs.size() - 1, static_cast<size_t>(q * costs.size()))] * 1e6; };
+    double total = 0.0;
+    for (double c : costs) total += c;
+    const PongRollbackStats &st = peers[0].stats();
+    std::printf("%u frames per peer, inputs arriving %u frames late, random presses\n", end, lag);
+    std::printf("  rollbacks      %llu of %llu frames, %.1f frames re-simulated on average, %d at most\n",
+        static_cast<unsigned long long>(st.rollbacks), static_cast<unsigned long long>(st.frames),
+        st.rollbacks ? double(st.resimulated) / st.rollbacks : 0.0, st.maxRollbackFrames);
+    // the slowest samples are the OS taking the core away, not re-simulation
+    std::printf("  frame cost     %.2f us mean, %.2f us p99.9, %.2f us max incl. preemption (tick is %.0f us)\n",
+        total / costs.size() * 1e6, pct(0.999), costs.back() * 1e6, PONG_TICK * 1e6);
+    std::printf("  final state    %08x / %08x, %s\n", sum[0], sum[1], ok ? "peers agree" : "DESYNC");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include "pong_sim.h"
+
+// Frames one peer may run ahead of the last input it has from the other,
+// predicting the missing ones (16 ticks = 133 ms at 120 Hz)
+const int ROLLBACK_WINDOW = 16;
+// Ring size for snapshots and inputs; remote inputs can arrive for frames up
+// to a window behind and a window ahead of the current one
+const int ROLLBACK_HISTORY = 64;
+
+struct PongRollbackStats {
+    uint64_t frames = 0;            // advance() calls
+    uint64_t rollbacks = 0;         // advances that re-simulated mispredicted frames
+    uint64_t resimulated = 0;       // frames simulated again
+    int maxRollbackFrames = 0;
+    double worstAdvanceSeconds = 0.0;
+};
+
+// Two-player Pong with rollback: the local input is applied the frame it is
+// read, the remote one is guessed (it repeats the last one received) and,
+// when the real one arrives and differs, the state is restored from the
+// snapshot before that frame and the frames since are simulated again.
+// Frame f uses the inputs for f and moves from the state before f to the
+// state before f + 1. Knows nothing about the network.
+class PongRollback {
+public:
+    // side: 0 if the local player is the left paddle, 1 for the right
+    PongRollback(uint32_t seed, int side);
+
+    // The frame the next advance() simulates
+    uint32_t frame() const { return current; }
+    // Every remote input before this frame has arrived
+    uint32_t confirmedFrame() const { return remoteKnown; }
+    // False while the remote input is a whole window behind: predicting
+    // further would make rollbacks too long, so the caller waits a tick
+    bool canAdvance() const { return current - remoteKnown < static_cast<uint32_t>(ROLLBACK_WINDOW); }
+
+    // Re-simulates from the first mispredicted frame if any, then simulates
+    // frame() with `local` as this side's input
+    void advance(int8_t local);
+    // Just the re-simulation, for when inputs arrive while not advancing
+    void rollback();
+    // The remote input for `frame`; repeats and frames out of range are ignored
+    void addRemoteInput(uint32_t frame, int8_t input);
+
+    // Local input sent for frame f, for frames within the history
+    int8_t localInput(uint32_t f) const { return local[f % ROLLBACK_HISTORY]; }
+    const PongState &state() const { return now; }
+    int side() const { return side_; }
+
+    // Hash of the state before frame f, if f is in the history and every
+    // input before it is known, so both peers must agree on it
+    bool checksum(uint32_t f, uint32_t &out) const;
+
+    const PongRollbackStats &stats() const { return stats_; }
+    void resetStats() { stats_ = PongRollbackStats(); }
+
+private:
+    void simulate(uint32_t f);
+    int8_t remoteFor(uint32_t f) const;
+
+    int side_;
+    PongState now;
+    uint32_t current = 0;
+    uint32_t remoteKnown = 0;
+    uint32_t rollbackFrom = UINT32_MAX;     // oldest frame whose guess was wrong
+    PongState snapshots[ROLLBACK_HISTORY];  // state before frame f at f % ROLLBACK_HISTORY
+    int8_t local[ROLLBACK_HISTORY] = {};
+    int8_t used[ROLLBACK_HISTORY] = {};     // remote input frame f was simulated with
+    int8_t remote[ROLLBACK_HISTORY] = {};
+    uint32_t remoteTag[ROLLBACK_HISTORY];   // which frame remote[i] belongs to
+    PongRollbackStats stats_;
+};
+
+uint32_t pongChecksum(const PongState &s);
+
+// `pong --rollback-bench`: two sessions in one process exchanging inputs a
+// window late with random presses, so nearly every frame rolls back as far
+// as it can; prints the cost per frame and checks both end in the same state.
+int runRollbackBench(double seconds);
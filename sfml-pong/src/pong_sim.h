@@ -0,0 +1,102 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Pong rules as a pure function of state, input and a fixed tick, shared by
+// the windowed game and the headless batch runner. Positions are the top-left
+// corners the game draws at; the serve angle comes from a per-match
+// xorshift generator, so a match replays exactly from its seed.
+const float PONG_W = 800.f, PONG_H = 600.f;
+const float PONG_PADDLE_W = 10.f, PONG_PADDLE_H = 100.f;
+const float PONG_LEFT_X = 50.f, PONG_RIGHT_X = PONG_W - 60.f;
+const float PONG_PADDLE_SPEED = 400.f;
+const float PONG_BALL_SIZE = 16.f;          // radius 8
+const float PONG_SERVE_SPEED = 300.f;
+const float PONG_SPIN = 5.f;                // vertical speed per pixel off the paddle centre
+const float PONG_TICK = 1.f / 120.f;
+const int PONG_WIN_SCORE = 11;
+
+struct PongState {
+    float leftY = PONG_H / 2.f - PONG_PADDLE_H / 2.f;
+    float rightY = PONG_H / 2.f - PONG_PADDLE_H / 2.f;
+    float ballX = PONG_W / 2.f, ballY = PONG_H / 2.f;
+    float velX = -PONG_SERVE_SPEED, velY = -150.f;
+    int32_t scoreLeft = 0, scoreRight = 0;
+    uint32_t rng = 1;                       // never 0
+};
+
+// Paddle movement: -1 up, 0 stay, +1 down
+struct PongInput {
+    int8_t left = 0, right = 0;
+};
+
+inline uint32_t pongNextRandom(uint32_t x){
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return x;
+}
+
+inline PongState pongNewMatch(uint32_t seed){
+    PongState s;
+    s.rng = seed ? seed : 1;
+    return s;
+}
+
+// Ball and paddle overlap with positive area (as sf::Rect::findIntersection)
+inline bool pongHitsPaddle(float ballX, float ballY, float paddleX, float paddleY){
+    return (ballX < paddleX + PONG_PADDLE_W) & (paddleX < ballX + PONG_BALL_SIZE)
+         & (ballY < paddleY + PONG_PADDLE_H) & (paddleY < ballY + PONG_BALL_SIZE);
+}
+
+// Advances one tick. Written as selects rather than branches, so a batch of
+// matches in different situations does not stall on mispredictions. Returns 1 if the left player
+// scored, 2 if the right did, 0 otherwise.
+inline int stepPong(PongState &s, PongInput in, float dt = PONG_TICK){
+    const float maxY = PONG_H - PONG_PADDLE_H;
+    s.leftY = std::min(std::max(s.leftY + in.left * PONG_PADDLE_SPEED * dt, 0.f), maxY);
+    s.rightY = std::min(std::max(s.rightY + in.right * PONG_PADDLE_SPEED * dt, 0.f), maxY);
+
+    s.ballX += s.velX * dt;
+    s.ballY += s.velY * dt;
+    const float speedY = std::fabs(s.velY);
+    s.velY = s.ballY <= 0.f ? speedY : s.velY;
+    s.velY = s.ballY + PONG_BALL_SIZE >= PONG_H ? -speedY : s.velY;
+
+    // paddles send the ball back with spin from where it hit
+    const float ballCentre = s.ballY + PONG_BALL_SIZE / 2.f;
+    const float speedX = std::fabs(s.velX);
+    const bool hitLeft = pongHitsPaddle(s.ballX, s.ballY, PONG_LEFT_X, s.leftY);
+    const bool hitRight = pongHitsPaddle(s.ballX, s.ballY, PONG_RIGHT_X, s.rightY);
+    s.velX = hitLeft ? speedX : s.velX;
+    s.velY = hitLeft ? (ballCentre - (s.leftY + PONG_PADDLE_H / 2.f)) * PONG_SPIN : s.velY;
+    s.velX = hitRight ? -speedX : s.velX;
+    s.velY = hitRight ? (ballCentre - (s.rightY + PONG_PADDLE_H / 2.f)) * PONG_SPIN : s.velY;
+
+    // a point re-serves from the centre towards the player who lost it
+    const bool rightScored = s.ballX < 0.f;
+    const bool leftScored = s.ballX > PONG_W;
+    const bool scored = leftScored | rightScored;
+    const uint32_t next = pongNextRandom(s.rng);
+    const float serveY = static_cast<float>(static_cast<int>(next % 200u) - 100);
+    s.scoreLeft += leftScored;
+    s.scoreRight += rightScored;
+    s.rng = scored ? next : s.rng;
+    s.ballX = scored ? PONG_W / 2.f : s.ballX;
+    s.ballY = scored ? PONG_H / 2.f : s.ballY;
+    s.velX = rightScored ? -PONG_SERVE_SPEED : (leftScored ? PONG_SERVE_SPEED : s.velX);
+    s.velY = scored ? serveY : s.velY;
+    return leftScored ? 1 : (rightScored ? 2 : 0);
+}
+
+// A simple player for benchmarks and unattended tests. It moves only while
+// the ball comes towards it and aims off centre by an amount that changes
+// with every return (the ball's speed off a paddle only changes there, walls
+// flip its sign), sometimes enough to miss.
+inline int8_t pongTrackingMove(float ballY, float velX, float velY, float paddleY, uint32_t rng, bool left){
+    const float deadZone = 4.f;
+    const uint32_t h = pongNextRandom(rng ^ static_cast<uint32_t>(std::fabs(velY)));
+    const float aim = static_cast<float>(static_cast<int>((left ? h : h >> 8) % 141u) - 70);
+    const float d = ballY + PONG_BALL_SIZE / 2.f + aim - (paddleY + PONG_PADDLE_H / 2.f);
+    const bool towards = left ? velX < 0.f : velX >= 0.f;
+    return static_cast<int8_t>(towards * ((d > deadZone) - (d < -deadZone)));
+}
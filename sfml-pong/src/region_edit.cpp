@@ -0,0 +1,199 @@
+#include "region_edit.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <thread>
+
+using EditClock = std::chrono::steady_clock;
+
+BlockRegion regionBetween(int ax, int ay, int az, int bx, int by, int bz){
+    BlockRegion r;
+    r.minX = std::min(ax, bx); r.maxX = std::max(ax, bx);
+    r.minY = std::max(0, std::min(ay, by)); r.maxY = std::min(CHUNK_HEIGHT - 1, std::max(ay, by));
+    r.minZ = std::min(az, bz); r.maxZ = std::max(az, bz);
+    return r;
+}
+
+size_t EditJournal::blocks() const{
+    size_t n = 0;
+    for (const auto &c : chunks)
+        for (const Run &r : c.runs) n += r.length;
+    return n;
+}
+
+size_t EditJournal::bytes() const{
+    size_t n = chunks.capacity() * sizeof(ChunkRuns);
+    for (const auto &c : chunks) n += c.runs.capacity() * sizeof(Run);
+    return n;
+}
+
+RegionEditor::RegionEditor(VoxelWorld &world, unsigned threads) : world(world) { setThreads(threads); }
+
+void RegionEditor::setThreads(unsigned threads){
+    threadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Runs job(i, worker) for every i < count; inline when one worker would do
+void RegionEditor::runParallel(size_t count, const std::function<void(size_t, unsigned)> &job) const{
+    const unsigned workers = static_cast<unsigned>(std::min<size_t>(threadCount, count));
+    if (workers <= 1){
+        for (size_t i = 0; i < count; ++i) job(i, 0);
+        return;
+    }
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < workers; ++t)
+        pool.emplace_back([&, t]{
+            for (size_t i; (i = next.fetch_add(1)) < count;) job(i, t);
+        });
+    for (auto &w : pool) w.join();
+}
+
+RegionEditStats RegionEditor::apply(const BlockRegion &region, const ChunkWrite &write, EditJournal *undo){
+    std::vector<ChunkPos> chunks;
+    std::vector<BlockRegion> local;
+    if (!region.empty()){
+        const ChunkPos lo = chunkOf(region.minX, region.minZ), hi = chunkOf(region.maxX, region.maxZ);
+        for (int cz = lo.z; cz <= hi.z; ++cz){
+            for (int cx = lo.x; cx <= hi.x; ++cx){
+                const int x0 = cx * CHUNK_SIZE, z0 = cz * CHUNK_SIZE;
+                BlockRegion l;
+                l.minX = std::max(region.minX, x0) - x0; l.maxX = std::min(region.maxX, x0 + CHUNK_SIZE - 1) - x0;
+                l.minY = region.minY;                     l.maxY = region.maxY;
+                l.minZ = std::max(region.minZ, z0) - z0; l.maxZ = std::min(region.maxZ, z0 + CHUNK_SIZE - 1) - z0;
+                chunks.push_back({cx, cz});
+                local.push_back(l);
+            }
+        }
+    }
+    return applyChunks(chunks, local, region.volume(), write, undo);
+}
+
+RegionEditStats RegionEditor::applyChunks(const std::vector<ChunkPos> &chunks, const std::vector<BlockRegion> &local, size_t visited,
+                                          const ChunkWrite &write, EditJournal *undo){
+    const auto t0 = EditClock::now();
+    RegionEditStats stats;
+    stats.blocks = visited;
+    // the world is not thread-safe: load or generate everything up front
+    std::vector<Chunk*> targets;
+    targets.reserve(chunks.size());
+    for (ChunkPos p : chunks) targets.push_back(&world.chunk(p));
+
+    std::vector<std::vector<EditJournal::Run>> runs(undo ? chunks.size() : 0);
+    std::vector<size_t> changed(chunks.size(), 0);
+    const unsigned workers = std::max(1u, threadCount);
+    std::vector<std::vector<BlockId>> before(workers, std::vector<BlockId>(CHUNK_VOLUME)), after(workers, std::vector<BlockId>(CHUNK_VOLUME));
+    runParallel(chunks.size(), [&](size_t i, unsigned worker){
+        Chunk &c = *targets[i];
+        BlockId *old = before[worker].data(), *ids = after[worker].data();
+        c.blocks.copyTo(old);
+        std::copy(old, old + CHUNK_VOLUME, ids);
+        write(i, chunks[i], ids, local[i]);
+
+        // one pass finds the changes and, with a journal, the old ids as runs
+        size_t n = 0;
+        EditJournal::Run *open = nullptr;
+        for (int k = 0; k < CHUNK_VOLUME; ++k){
+            if (ids[k] == old[k]){ open = nullptr; continue; }
+            ++n;
+            if (!undo) continue;
+            if (open && open->id == old[k]) ++open->length;
+            else {
+                runs[i].push_back({static_cast<uint16_t>(k), 1, old[k]});
+                open = &runs[i].back();
+            }
+        }
+        changed[i] = n;
+        if (n) c.blocks.assign(ids);
+    });
+
+    if (undo) undo->chunks.clear();
+    for (size_t i = 0; i < chunks.size(); ++i){
+        if (!changed[i]) continue;
+        world.chunkRewritten(chunks[i]);
+        stats.changed += changed[i];
+        stats.changedChunks.push_back(chunks[i]);
+        if (undo) undo->chunks.push_back({chunks[i], std::move(runs[i])});
+    }
+    stats.chunks = stats.changedChunks.size();
+    stats.seconds = std::chrono::duration<double>(EditClock::now() - t0).count();
+    return stats;
+}
+
+RegionEditStats RegionEditor::fill(const BlockRegion &region, BlockId id, EditJournal *undo){
+    return apply(region, [id](size_t, ChunkPos, BlockId *ids, const BlockRegion &l){
+        for (int y = l.minY; y <= l.maxY; ++y)
+            for (int z = l.minZ; z <= l.maxZ; ++z){
+                BlockId *row = ids + Chunk::index(0, y, z);
+                std::fill(row + l.minX, row + l.maxX + 1, id);
+            }
+    }, undo);
+}
+
+RegionEditStats RegionEditor::replace(const BlockRegion &region, const BlockMask &from, BlockId to, EditJournal *undo){
+    return apply(region, [&from, to](size_t, ChunkPos, BlockId *ids, const BlockRegion &l){
+        for (int y = l.minY; y <= l.maxY; ++y)
+            for (int z = l.minZ; z <= l.maxZ; ++z){
+                BlockId *row = ids + Chunk::index(0, y, z);
+                for (int x = l.minX; x <= l.maxX; ++x)
+                    if (row[x] < BLOCK_TYPE_COUNT && from[row[x]]) row[x] = to;
+            }
+    }, undo);
+}
+
+RegionEditStats RegionEditor::copy(const BlockRegion &region, BlockClipboard &out){
+    out.sizeX = region.empty() ? 0 : static_cast<int>(region.spanX());
+    out.sizeY = region.empty() ? 0 : static_cast<int>(region.spanY());
+    out.sizeZ = region.empty() ? 0 : static_cast<int>(region.spanZ());
+    out.blocks.assign(region.volume(), BLOCK_AIR);
+    // reads only: each chunk fills its own part of the clipboard and nothing is rewritten
+    BlockClipboard &clip = out;
+    return apply(region, [&clip, &region](size_t, ChunkPos pos, BlockId *ids, const BlockRegion &l){
+        const int ox = pos.x * CHUNK_SIZE - region.minX, oz = pos.z * CHUNK_SIZE - region.minZ;
+        for (int y = l.minY; y <= l.maxY; ++y)
+            for (int z = l.minZ; z <= l.maxZ; ++z){
+                const BlockId *row = ids + Chunk::index(0, y, z);
+                const size_t at = (static_cast<size_t>(y - region.minY) * clip.sizeZ + (z + oz)) * clip.sizeX + (l.minX + ox);
+                std::copy(row + l.minX, row + l.maxX + 1, clip.blocks.begin() + static_cast<std::ptrdiff_t>(at));
+            }
+    }, nullptr);
+}
+
+RegionEditStats RegionEditor::paste(const BlockClipboard &clip, int x, int y, int z, int quarterTurns, bool skipAir, EditJournal *undo){
+    const int turns = floorMod(quarterTurns, 4);
+    const int spanX = turns % 2 ? clip.sizeZ : clip.sizeX, spanZ = turns % 2 ? clip.sizeX : clip.sizeZ;
+    const int64_t endX = static_cast<int64_t>(x) + spanX - 1, endY = static_cast<int64_t>(y) + clip.sizeY - 1, endZ = static_cast<int64_t>(z) + spanZ - 1;
+    if (clip.empty() || endX > INT_MAX || endY > INT_MAX || endZ > INT_MAX){
+        if (undo) undo->chunks.clear();
+        return RegionEditStats();
+    }
+    const BlockRegion target = regionBetween(x, y, z, static_cast<int>(endX), static_cast<int>(endY), static_cast<int>(endZ));
+    return apply(target, [&clip, x, y, z, turns, skipAir](size_t, ChunkPos pos, BlockId *ids, const BlockRegion &l){
+        for (int wy = l.minY; wy <= l.maxY; ++wy)
+            for (int lz = l.minZ; lz <= l.maxZ; ++lz){
+                BlockId *row = ids + Chunk::index(0, wy, lz);
+                const int dz = pos.z * CHUNK_SIZE + lz - z;
+                for (int lx = l.minX; lx <= l.maxX; ++lx){
+                    const int dx = pos.x * CHUNK_SIZE + lx - x;
+                    // destination offset back to the clipboard cell that lands there
+                    int sx = dx, sz = dz;
+                    if (turns == 1){ sx = dz; sz = clip.sizeZ - 1 - dx; }
+                    else if (turns == 2){ sx = clip.sizeX - 1 - dx; sz = clip.sizeZ - 1 - dz; }
+                    else if (turns == 3){ sx = clip.sizeX - 1 - dz; sz = dx; }
+                    const BlockId id = clip.at(sx, wy - y, sz);
+                    if (!skipAir || id != BLOCK_AIR) row[lx] = id;
+                }
+            }
+    }, undo);
+}
+
+RegionEditStats RegionEditor::undo(const EditJournal &journal, EditJournal *redo){
+    std::vector<ChunkPos> chunks;
+    for (const auto &c : journal.chunks) chunks.push_back(c.pos);
+    // runs carry their own positions; the box is unused
+    const std::vector<BlockRegion> local(chunks.size());
+    return applyChunks(chunks, local, journal.blocks(), [&journal](size_t i, ChunkPos, BlockId *ids, const BlockRegion&){
+        for (const EditJournal::Run &r : journal.chunks[i].runs) std::fill(ids + r.start, ids + r.start + r.length, r.id);
+    }, redo);
+}
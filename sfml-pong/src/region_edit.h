@@ -0,0 +1,114 @@
+#pragma once
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "voxel_world.h"
+
+// Inclusive box of world blocks, min <= max on every axis
+struct BlockRegion {
+    int minX = 0, minY = 0, minZ = 0;
+    int maxX = -1, maxY = -1, maxZ = -1;
+
+    bool empty() const { return minX > maxX || minY > maxY || minZ > maxZ; }
+    // Widths in blocks; 64-bit, since corners at INT_MIN and INT_MAX span 2^32
+    int64_t spanX() const { return static_cast<int64_t>(maxX) - minX + 1; }
+    int64_t spanY() const { return static_cast<int64_t>(maxY) - minY + 1; }
+    int64_t spanZ() const { return static_cast<int64_t>(maxZ) - minZ + 1; }
+    // Saturates at SIZE_MAX rather than wrapping
+    size_t volume() const {
+        if (empty()) return 0;
+        const uint64_t xy = static_cast<uint64_t>(spanX()) * static_cast<uint64_t>(spanY()), z = static_cast<uint64_t>(spanZ());
+        return xy > SIZE_MAX / z ? SIZE_MAX : static_cast<size_t>(xy * z);
+    }
+    // No axis and not the whole box larger than maxBlocks
+    bool fitsWithin(size_t maxBlocks) const {
+        const int64_t limit = static_cast<int64_t>(std::min<size_t>(maxBlocks, INT64_MAX));
+        return empty() || (spanX() <= limit && spanY() <= limit && spanZ() <= limit && volume() <= maxBlocks);
+    }
+};
+
+// Box between two corners given in any order, with Y clipped to the world
+BlockRegion regionBetween(int ax, int ay, int az, int bx, int by, int bz);
+
+// Block ids a replace applies to
+using BlockMask = std::bitset<BLOCK_TYPE_COUNT>;
+
+// A copied box of blocks, indexed like Chunk::index (Y, then Z, then X)
+struct BlockClipboard {
+    int sizeX = 0, sizeY = 0, sizeZ = 0;
+    std::vector<BlockId> blocks;
+
+    bool empty() const { return blocks.empty(); }
+    BlockId at(int x, int y, int z) const { return blocks[(static_cast<size_t>(y) * sizeZ + z) * sizeX + x]; }
+};
+
+// What an edit overwrote, enough to put it back. Per chunk, the old ids are
+// kept as runs of consecutive Chunk::index() positions that held the same id,
+// so a fill over terrain costs a few runs per layer rather than a slot per block.
+struct EditJournal {
+    struct Run {
+        uint16_t start = 0, length = 0;
+        BlockId id = BLOCK_AIR;
+    };
+    struct ChunkRuns {
+        ChunkPos pos;
+        std::vector<Run> runs;
+    };
+    std::vector<ChunkRuns> chunks;
+
+    bool empty() const { return chunks.empty(); }
+    size_t blocks() const;  // blocks it restores
+    size_t bytes() const;   // heap held
+};
+
+struct RegionEditStats {
+    size_t blocks = 0;      // blocks visited
+    size_t changed = 0;     // of those, ones that now hold a different id
+    size_t chunks = 0;      // chunks written (each bumped and remeshed once)
+    double seconds = 0.0;
+    std::vector<ChunkPos> changedChunks;
+
+    double blocksPerSecond() const { return seconds > 0.0 ? static_cast<double>(blocks) / seconds : 0.0; }
+};
+
+// Bulk edits over a VoxelWorld. Each operation loads the chunks it touches on
+// the calling thread, then splits them across worker threads: a worker
+// unpacks one chunk's storage, rewrites every block of the region inside it,
+// records the old ids in the journal if one is given, and packs the storage
+// back once. Afterwards every chunk that changed gets a single
+// VoxelWorld::chunkRewritten(), so it is saved, resent and remeshed once per
+// operation however many of its blocks moved. Block ids are not validated here.
+class RegionEditor {
+public:
+    explicit RegionEditor(VoxelWorld &world, unsigned threads = 0); // 0: every core
+
+    void setThreads(unsigned threads);
+    unsigned threads() const { return threadCount; }
+
+    // A journal passed to an edit is replaced with that edit's undo record.
+    RegionEditStats fill(const BlockRegion &region, BlockId id, EditJournal *undo = nullptr);
+    // Sets blocks whose current id is in `from` to `to`
+    RegionEditStats replace(const BlockRegion &region, const BlockMask &from, BlockId to, EditJournal *undo = nullptr);
+    RegionEditStats copy(const BlockRegion &region, BlockClipboard &out);
+    // Places the clipboard turned `quarterTurns` times about +Y (clockwise seen
+    // from above), its lowest corner at (x, y, z). Y outside the world is cut off;
+    // a paste whose far corner would pass INT_MAX does nothing.
+    RegionEditStats paste(const BlockClipboard &clip, int x, int y, int z, int quarterTurns, bool skipAir, EditJournal *undo = nullptr);
+    // Restores what `journal` recorded; `redo` receives what that overwrote
+    RegionEditStats undo(const EditJournal &journal, EditJournal *redo = nullptr);
+
+private:
+    // Rewrites the unpacked ids (Chunk::index order) of the i-th chunk inside
+    // `local`, the part of the region in that chunk in chunk-local X/Z
+    using ChunkWrite = std::function<void(size_t i, ChunkPos pos, BlockId *ids, const BlockRegion &local)>;
+    RegionEditStats apply(const BlockRegion &region, const ChunkWrite &write, EditJournal *undo);
+    RegionEditStats applyChunks(const std::vector<ChunkPos> &chunks, const std::vector<BlockRegion> &local, size_t visited,
+                                const ChunkWrite &write, EditJournal *undo);
+    void runParallel(size_t count, const std::function<void(size_t, unsigned)> &job) const;
+
+    VoxelWorld &world;
+    unsigned threadCount = 1;
+};
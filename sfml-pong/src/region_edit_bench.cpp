@@ -0,0 +1,105 @@
+#include "region_edit_bench.h"
+#include "region_edit.h"
+#include "voxel_world.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+using BenchClock = std::chrono::steady_clock;
+
+static double secondsSince(BenchClock::time_point t0){
+    return std::chrono::duration<double>(BenchClock::now() - t0).count();
+}
+
+// FNV-1a over every block of the chunks, in order
+static uint64_t worldHash(VoxelWorld &world, const std::vector<ChunkPos> &chunks){
+    uint64_t h = 1469598103934665603ull;
+    std::vector<BlockId> ids(CHUNK_VOLUME);
+    for (ChunkPos p : chunks){
+        world.chunk(p).blocks.copyTo(ids.data());
+        for (BlockId id : ids){ h ^= id; h *= 1099511628211ull; }
+    }
+    return h;
+}
+
+static std::unordered_map<ChunkPos, uint32_t, ChunkPosHash> versions(VoxelWorld &world, const std::vector<ChunkPos> &chunks){
+    std::unordered_map<ChunkPos, uint32_t, ChunkPosHash> v;
+    for (ChunkPos p : chunks) v[p] = world.chunk(p).version;
+    return v;
+}
+
+int runRegionEditBench(unsigned seed, int size, unsigned threads){
+    if (size <= 0) size = 256;
+    const int lo = -size / 2, hi = lo + size - 1;
+    const BlockRegion region = regionBetween(lo, 0, lo, hi, CHUNK_HEIGHT - 1, hi);
+    std::vector<ChunkPos> chunks;
+    const ChunkPos c0 = chunkOf(lo, lo), c1 = chunkOf(hi, hi);
+    for (int z = c0.z; z <= c1.z; ++z)
+        for (int x = c0.x; x <= c1.x; ++x) chunks.push_back({x, z});
+
+    VoxelWorld world(seed);
+    auto t0 = BenchClock::now();
+    for (ChunkPos p : chunks) world.chunk(p);
+    const double genSeconds = secondsSince(t0);
+    RegionEditor editor(world, threads);
+    std::printf("edit bench: seed %u, %dx%dx%d blocks (%zu), %zu chunks generated in %.0f ms, %u threads\n", seed, size, CHUNK_HEIGHT, size,
+        region.volume(), chunks.size(), genSeconds * 1000.0, editor.threads());
+
+    // the baseline writes the same fill one block at a time into a second world
+    {
+        VoxelWorld ref(seed);
+        for (ChunkPos p : chunks) ref.chunk(p);
+        t0 = BenchClock::now();
+        for (int y = region.minY; y <= region.maxY; ++y)
+            for (int z = region.minZ; z <= region.maxZ; ++z)
+                for (int x = region.minX; x <= region.maxX; ++x) ref.setBlock(x, y, z, BLOCK_COBBLE);
+        const double s = secondsSince(t0);
+        std::printf("  %-16s %9zu blocks %29s %8.1f ms %7.1f M blocks/s\n", "setBlock fill", region.volume(), "", s * 1000.0,
+            static_cast<double>(region.volume()) / s / 1e6);
+    }
+
+    const uint64_t original = worldHash(world, chunks);
+    bool ok = true;
+    // every chunk an edit changed moved one version on, the others none
+    auto run = [&](const char *name, const std::function<RegionEditStats(EditJournal*)> &edit){
+        const auto before = versions(world, chunks);
+        EditJournal journal;
+        const RegionEditStats s = edit(&journal);
+        size_t wrongVersions = 0;
+        std::unordered_map<ChunkPos, int, ChunkPosHash> expected;
+        for (ChunkPos p : s.changedChunks) ++expected[p];
+        for (ChunkPos p : chunks){
+            const auto e = expected.find(p);
+            if (world.chunk(p).version - before.at(p) != (e == expected.end() ? 0u : static_cast<uint32_t>(e->second))) ++wrongVersions;
+        }
+        std::printf("  %-16s %9zu blocks %9zu changed %4zu chunks %8.1f ms %7.1f M blocks/s, undo %.1f KB\n", name, s.blocks, s.changed,
+            s.chunks, s.seconds * 1000.0, s.blocksPerSecond() / 1e6, static_cast<double>(journal.bytes()) / 1024.0);
+        const RegionEditStats u = editor.undo(journal);
+        const bool restored = worldHash(world, chunks) == original;
+        std::printf("  %-16s %9zu blocks %9zu changed %4zu chunks %8.1f ms %7.1f M blocks/s%s%s\n", "  undo", u.blocks, u.changed,
+            u.chunks, u.seconds * 1000.0, u.blocksPerSecond() / 1e6, restored ? "" : " NOT RESTORED",
+            wrongVersions ? " (VERSION BUMPS WRONG)" : "");
+        ok = ok && restored && wrongVersions == 0 && s.chunks == s.changedChunks.size();
+    };
+
+    run("fill", [&](EditJournal *j){ return editor.fill(region, BLOCK_COBBLE, j); });
+    BlockMask ground;
+    ground.set(BLOCK_STONE).set(BLOCK_DIRT);
+    run("replace", [&](EditJournal *j){ return editor.replace(region, ground, BLOCK_GLASS, j); });
+
+    // a quarter of the region, pasted turned once into the opposite quarter
+    BlockClipboard clip;
+    const RegionEditStats c = editor.copy(regionBetween(lo, 0, lo, lo + size / 2 - 1, CHUNK_HEIGHT - 1, lo + size / 4 - 1), clip);
+    std::printf("  %-16s %9zu blocks %29s %8.1f ms %7.1f M blocks/s\n", "copy", c.blocks, "", c.seconds * 1000.0, c.blocksPerSecond() / 1e6);
+    run("paste, 1 turn", [&](EditJournal *j){ return editor.paste(clip, lo + size / 2, 0, lo + size / 2, 1, false, j); });
+    run("paste, no air", [&](EditJournal *j){ return editor.paste(clip, lo + size / 2, 0, lo + size / 2, 3, true, j); });
+
+    if (editor.threads() > 1){
+        editor.setThreads(1);
+        run("fill, 1 thread", [&](EditJournal *j){ return editor.fill(region, BLOCK_COBBLE, j); });
+    }
+    if (!ok) std::fprintf(stderr, "edit bench: an undo or version check failed\n");
+    return ok ? 0 : 1;
+}
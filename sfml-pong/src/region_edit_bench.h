@@ -0,0 +1,8 @@
+#pragma once
+
+// `cube_server --edit-bench N`: runs fill, replace, copy/paste and undo over
+// an N x CHUNK_HEIGHT x N block region at the origin (N = 0 uses 256), prints
+// blocks per second for each next to setBlock() one block at a time, and
+// checks that every undo restores the world and that each edit rewrote a
+// chunk at most once. threads = 0 uses every core.
+int runRegionEditBench(unsigned seed, int size, unsigned threads);
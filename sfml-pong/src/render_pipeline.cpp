@@ -0,0 +1,144 @@
+#include "render_pipeline.h"
+#include <iostream>
+
+static const char *CAMERA_BLOCK_GLSL = R"(
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 proj;
+    mat4 viewProj;
+    vec4 eye;
+};
+)";
+
+// aChunkOffset is per instance: each indirect draw picks its section's
+// offset through baseInstance
+static const char *TERRAIN_VS_BODY = R"(
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aUV;
+layout(location = 2) in vec3 aChunkOffset;
+out vec2 vUV;
+void main(){
+    vUV = aUV;
+    gl_Position = viewProj * vec4(aPos + aChunkOffset, 1.0);
+}
+)";
+
+static const char *TERRAIN_FS = R"(#version 330 core
+uniform sampler2D uTexture;
+in vec2 vUV;
+out vec4 fragColor;
+void main(){
+    fragColor = texture(uTexture, vUV);
+}
+)";
+
+// rotation part of the view only, so the sky stays at infinity
+static const char *SKY_VS_BODY = R"(
+uniform mat4 uModel;
+layout(location = 0) in vec3 aPos;
+void main(){
+    gl_Position = proj * mat4(mat3(view)) * uModel * vec4(aPos, 1.0);
+}
+)";
+
+static const char *SKY_FS = R"(#version 330 core
+uniform vec4 uColor;
+out vec4 fragColor;
+void main(){
+    fragColor = uColor;
+}
+)";
+
+RenderPipeline::~RenderPipeline(){
+    if (sunVao) glDeleteVertexArrays(1, &sunVao);
+    if (sunVbo) glDeleteBuffers(1, &sunVbo);
+    if (cameraUbo) glDeleteBuffers(1, &cameraUbo);
+}
+
+bool RenderPipeline::init(){
+    const char *version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    if (!loadGLFunctions()){
+        std::cerr << "OpenGL 3.3 is required (context reports " << (version ? version : "nothing") << ")\n";
+        return false;
+    }
+    const std::string header = std::string("#version 330 core\n") + CAMERA_BLOCK_GLSL;
+    terrain = shaders.load("terrain", (header + TERRAIN_VS_BODY).c_str(), TERRAIN_FS);
+    sky = shaders.load("sky", (header + SKY_VS_BODY).c_str(), SKY_FS);
+    if (!terrain || !sky) return false;
+
+    terrain->bindBlock("Camera", CAMERA_UBO_BINDING);
+    sky->bindBlock("Camera", CAMERA_UBO_BINDING);
+    skyModelLoc = sky->uniform("uModel");
+    skyColorLoc = sky->uniform("uColor");
+    terrain->use();
+    glUniform1i(terrain->uniform("uTexture"), 0);
+    glUseProgram(0);
+
+    glGenBuffers(1, &cameraUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UBO_BINDING, cameraUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    const float quad[] = { -1.f,-1.f,0.f,  1.f,-1.f,0.f,  1.f,1.f,0.f,  -1.f,1.f,0.f };
+    glGenVertexArrays(1, &sunVao);
+    glGenBuffers(1, &sunVbo);
+    glBindVertexArray(sunVao);
+    glBindBuffer(GL_ARRAY_BUFFER, sunVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void RenderPipeline::setCamera(const Camera &cam){
+    if (&cam != uploadedCamera || cam.revision() != uploadedRevision){
+        camera.view = cam.view();
+        camera.proj = cam.projection();
+        camera.viewProj = cam.viewProjection();
+        const sf::Vector3f &eye = cam.eye();
+        camera.eye[0] = eye.x; camera.eye[1] = eye.y; camera.eye[2] = eye.z;
+        glBindBuffer(GL_UNIFORM_BUFFER, cameraUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &camera);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        uploadedCamera = &cam;
+        uploadedRevision = cam.revision();
+    }
+    // SFML may rebind indexed buffers between frames; make sure ours is on the binding point
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UBO_BINDING, cameraUbo);
+}
+
+void RenderPipeline::drawSun(const sf::Vector3f &direction, float distance, float size){
+    const sf::Vector3f d = normalize(direction);
+    // billboard facing the origin
+    const sf::Vector3f f{-d.x, -d.y, -d.z};
+    sf::Vector3f up{0.f, 1.f, 0.f};
+    if (std::abs(f.y) > 0.99f) up = {1.f, 0.f, 0.f};
+    const sf::Vector3f r = normalize(cross(up, f));
+    const sf::Vector3f u = cross(f, r);
+    Mat4 model;
+    model.m[0] = r.x * size; model.m[1] = r.y * size; model.m[2]  = r.z * size;
+    model.m[4] = u.x * size; model.m[5] = u.y * size; model.m[6]  = u.z * size;
+    model.m[8] = f.x;        model.m[9] = f.y;        model.m[10] = f.z;
+    model.m[12] = d.x * distance; model.m[13] = d.y * distance; model.m[14] = d.z * distance;
+
+    glDisable(GL_DEPTH_TEST);
+    sky->use();
+    glUniformMatrix4fv(skyModelLoc, 1, GL_FALSE, model.data());
+    glUniform4f(skyColorLoc, 1.f, 1.f, 0.f, 1.f);
+    glBindVertexArray(sunVao);
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void RenderPipeline::beginTerrain() const{
+    terrain->use();
+}
+
+void RenderPipeline::end() const{
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <SFML/System.hpp>
+#include "camera.h"
+#include "gl_functions.h"
+#include "math3d.h"
+#include "shader_manager.h"
+
+// std140 layout of the Camera uniform block shared by every program.
+struct CameraBlock {
+    Mat4 view;
+    Mat4 proj;
+    Mat4 viewProj;
+    float eye[4] = {0, 0, 0, 1};
+};
+
+const GLuint CAMERA_UBO_BINDING = 0;
+const GLuint TERRAIN_OFFSET_ATTRIB = 2;
+
+// GLSL 3.30 core programs for the 3D scene. The camera lives in a uniform
+// buffer written once per frame; terrain sections pass their world offset as
+// a per-instance attribute (TERRAIN_OFFSET_ATTRIB). Needs a GL 3.3 context (llvmpipe is fine); SFML's 2D
+// drawing still runs on the same context, so end() puts the default program
+// and vertex array back before the HUD is drawn.
+class RenderPipeline {
+public:
+    RenderPipeline() = default;
+    ~RenderPipeline();
+    RenderPipeline(const RenderPipeline&) = delete;
+    RenderPipeline& operator=(const RenderPipeline&) = delete;
+
+    // Loads GL entry points, builds the programs and buffers. Call with the context active.
+    bool init();
+    // Uploads the camera block only when the camera changed since the last call.
+    void setCamera(const Camera &cam);
+    // Billboard at a fixed direction that follows camera rotation but not position.
+    void drawSun(const sf::Vector3f &direction, float distance, float size);
+
+    void beginTerrain() const;
+    void end() const;
+
+    ShaderManager& programs() { return shaders; }
+
+private:
+    ShaderManager shaders;
+    ShaderProgram *terrain = nullptr;
+    ShaderProgram *sky = nullptr;
+    GLint skyModelLoc = -1;
+    GLint skyColorLoc = -1;
+    GLuint cameraUbo = 0;
+    GLuint sunVao = 0, sunVbo = 0;
+    CameraBlock camera;
+    const Camera *uploadedCamera = nullptr;
+    uint32_t uploadedRevision = 0;
+};
@@ -1,5 +1,4 @@
 #include "rendering.h"
-#include <GL/gl.h>
 
 const int FACE_TOP = 1;
 const int FACE_BOTTOM = 2;
@@ -8,35 +7,45 @@ const int FACE_BACK = 8;
 const int FACE_LEFT = 16;
 const int FACE_RIGHT = 32;
 
-static void drawFaceWithVerts(const std::array<float,4> &uv, std::array<sf::Vector3f,4> verts){
-    glTexCoord2f(uv[0], uv[1]); glVertex3f(verts[0].x, verts[0].y, verts[0].z);
-    glTexCoord2f(uv[2], uv[1]); glVertex3f(verts[1].x, verts[1].y, verts[1].z);
-    glTexCoord2f(uv[2], uv[3]); glVertex3f(verts[2].x, verts[2].y, verts[2].z);
-    glTexCoord2f(uv[0], uv[3]); glVertex3f(verts[3].x, verts[3].y, verts[3].z);
+size_t MeshBuffers::byteSize() const{
+    size_t n = 0;
+    for (const auto &g : groups) n += g.size() * sizeof(float);
+    return n + translucent.size() * sizeof(float);
 }
 
-void drawBlockAt(float gx, float gy, float gz, const Block &b, int faceMask, const TextureAtlas &atlas){
-    if (faceMask == 0) return;
-    const float s = 0.5f;
-    auto sideUV = atlas.getUV_fromAtlasTile(b.side);
-    auto topUV = atlas.getUV_fromAtlasTile(b.top);
-    auto botUV = atlas.getUV_fromAtlasTile(b.bottom);
+size_t MeshBuffers::quadCount() const{
+    size_t n = 0;
+    for (const auto &g : groups) n += g.size() / (4 * MESH_VERTEX_FLOATS);
+    return n;
+}
 
-    auto drawFace = [&](const std::array<float,4> &uv, std::array<sf::Vector3f,4> verts){
-        drawFaceWithVerts(uv, verts);
-    };
+BlockUVTable makeBlockUVs(const TextureAtlas &atlas){
+    auto uv = [&](AtlasTile t){ return atlas.getUV_fromAtlasTile(sf::Vector2i{t.col, t.row}); };
+    BlockUVTable table;
+    for (const BlockType &b : BLOCK_TYPES) table[b.id] = { uv(b.top), uv(b.side), uv(b.bottom) };
+    return table;
+}
 
-    glPushMatrix();
-    glTranslatef(gx, gy + s, gz);
+static void pushFaceWithVerts(std::vector<float> &out, float ox, float oy, float oz, const std::array<float,4> &uv, std::array<sf::Vector3f,4> verts){
+    const float us[4] = { uv[0], uv[2], uv[2], uv[0] };
+    const float vs[4] = { uv[1], uv[1], uv[3], uv[3] };
+    for (int i = 0; i < 4; ++i){
+        out.push_back(ox + verts[i].x); out.push_back(oy + verts[i].y); out.push_back(oz + verts[i].z);
+        out.push_back(us[i]); out.push_back(vs[i]);
+    }
+}
 
-    if (faceMask & FACE_FRONT){ atlas.bindSide(); glBegin(GL_QUADS); drawFace(sideUV, { sf::Vector3f{-s,-s, s}, sf::Vector3f{ s,-s, s}, sf::Vector3f{ s, s, s}, sf::Vector3f{-s, s, s} }); glEnd(); }
-    if (faceMask & FACE_BACK){ atlas.bindSide(); auto backUV = sideUV; std::swap(backUV[0], backUV[2]); glBegin(GL_QUADS); drawFace(backUV, { sf::Vector3f{-s,-s,-s}, sf::Vector3f{-s, s,-s}, sf::Vector3f{ s, s,-s}, sf::Vector3f{ s,-s,-s} }); glEnd(); }
-    if (faceMask & FACE_LEFT){ atlas.bindSide(); auto leftUV = sideUV; std::swap(leftUV[0], leftUV[2]); glBegin(GL_QUADS); drawFace(leftUV, { sf::Vector3f{-s,-s,-s}, sf::Vector3f{-s,-s, s}, sf::Vector3f{-s, s, s}, sf::Vector3f{-s, s,-s} }); glEnd(); }
-    if (faceMask & FACE_RIGHT){ atlas.bindSide(); glBegin(GL_QUADS); drawFace(sideUV, { sf::Vector3f{ s,-s,-s}, sf::Vector3f{ s, s,-s}, sf::Vector3f{ s, s, s}, sf::Vector3f{ s,-s, s} }); glEnd(); }
+void emitBlockFaces(MeshBuffers &out, float gx, float gy, float gz, const BlockUV &uv, int faceMask){
+    if (faceMask == 0) return;
+    const float s = 0.5f;
+    const float ox = gx, oy = gy + s, oz = gz;
+    auto &side = out.groups[GROUP_SIDE];
 
-    if (faceMask & FACE_TOP){ atlas.bindTop(); glBegin(GL_QUADS); drawFace(topUV, { sf::Vector3f{-s, s,-s}, sf::Vector3f{-s, s, s}, sf::Vector3f{ s, s, s}, sf::Vector3f{ s, s,-s} }); glEnd(); }
-    if (faceMask & FACE_BOTTOM){ atlas.bindDirt(); glBegin(GL_QUADS); drawFace(botUV, { sf::Vector3f{-s,-s,-s}, sf::Vector3f{ s,-s,-s}, sf::Vector3f{ s,-s, s}, sf::Vector3f{-s,-s, s} }); glEnd(); }
+    if (faceMask & FACE_FRONT){ pushFaceWithVerts(side, ox, oy, oz, uv.side, { sf::Vector3f{-s,-s, s}, sf::Vector3f{ s,-s, s}, sf::Vector3f{ s, s, s}, sf::Vector3f{-s, s, s} }); }
+    if (faceMask & FACE_BACK){ auto backUV = uv.side; std::swap(backUV[0], backUV[2]); pushFaceWithVerts(side, ox, oy, oz, backUV, { sf::Vector3f{-s,-s,-s}, sf::Vector3f{-s, s,-s}, sf::Vector3f{ s, s,-s}, sf::Vector3f{ s,-s,-s} }); }
+    if (faceMask & FACE_LEFT){ auto leftUV = uv.side; std::swap(leftUV[0], leftUV[2]); pushFaceWithVerts(side, ox, oy, oz, leftUV, { sf::Vector3f{-s,-s,-s}, sf::Vector3f{-s,-s, s}, sf::Vector3f{-s, s, s}, sf::Vector3f{-s, s,-s} }); }
+    if (faceMask & FACE_RIGHT){ pushFaceWithVerts(side, ox, oy, oz, uv.side, { sf::Vector3f{ s,-s,-s}, sf::Vector3f{ s, s,-s}, sf::Vector3f{ s, s, s}, sf::Vector3f{ s,-s, s} }); }
 
-    sf::Texture::bind(nullptr);
-    glPopMatrix();
+    if (faceMask & FACE_TOP){ pushFaceWithVerts(out.groups[GROUP_TOP], ox, oy, oz, uv.top, { sf::Vector3f{-s, s,-s}, sf::Vector3f{-s, s, s}, sf::Vector3f{ s, s, s}, sf::Vector3f{ s, s,-s} }); }
+    if (faceMask & FACE_BOTTOM){ pushFaceWithVerts(out.groups[GROUP_BOTTOM], ox, oy, oz, uv.bottom, { sf::Vector3f{-s,-s,-s}, sf::Vector3f{ s,-s,-s}, sf::Vector3f{ s,-s, s}, sf::Vector3f{-s,-s, s} }); }
 }
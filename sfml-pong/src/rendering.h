@@ -1,10 +1,10 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include <array>
+#include <vector>
+#include "block_registry.h"
 #include "texture_atlas.h"
 
-struct Block { std::string name; sf::Vector2i top, side, bottom; };
-
 extern const int FACE_TOP;
 extern const int FACE_BOTTOM;
 extern const int FACE_FRONT;
@@ -12,4 +12,27 @@ extern const int FACE_BACK;
 extern const int FACE_LEFT;
 extern const int FACE_RIGHT;
 
-void drawBlockAt(float gx, float gy, float gz, const Block &b, int faceMask, const TextureAtlas &atlas);
+// Faces are grouped by the texture they bind (only matters without an atlas,
+// where top/side/bottom each use their own fallback texture).
+enum FaceGroup { GROUP_TOP = 0, GROUP_SIDE = 1, GROUP_BOTTOM = 2, GROUP_COUNT = 3 };
+
+// Per-vertex layout of MeshBuffers: x, y, z, u, v
+const int MESH_VERTEX_FLOATS = 5;
+
+struct BlockUV { std::array<float,4> top, side, bottom; };
+// Atlas UVs for every block id, built once the atlas is loaded
+using BlockUVTable = std::array<BlockUV, BLOCK_TYPE_COUNT>;
+
+// CPU-side quad lists (4 vertices each), one per face group, plus translucent
+// faces of any group in their own list. Safe to build off the GL thread.
+struct MeshBuffers {
+    std::array<std::vector<float>, GROUP_COUNT> groups;
+    std::vector<float> translucent;
+    // every list, for upload budgets
+    size_t byteSize() const;
+    // the opaque groups only
+    size_t quadCount() const;
+};
+
+BlockUVTable makeBlockUVs(const TextureAtlas &atlas);
+void emitBlockFaces(MeshBuffers &out, float gx, float gy, float gz, const BlockUV &uv, int faceMask);
@@ -0,0 +1,364 @@
+#include "server.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+static const float SERVER_GRAVITY = 20.0f;
+static const float SERVER_WALK_SPEED = 4.0f;
+static const float SERVER_JUMP_SPEED = 6.5f;
+
+bool GameServer::start(const ServerConfig &config){
+    cfg = config;
+    world = std::make_unique<VoxelWorld>(cfg.seed);
+    world->setCacheBudget(cfg.chunkCacheBytes);
+    editor = std::make_unique<RegionEditor>(*world, cfg.editThreads);
+    if (!cfg.saveDir.empty() && !world->setStorage(cfg.saveDir)) return false;
+    if (listener.listen(cfg.port) != sf::Socket::Status::Done){
+        std::cerr << "Could not listen on port " << cfg.port << "\n";
+        return false;
+    }
+    listener.setBlocking(false);
+    std::cout << "Server listening on port " << cfg.port << " (seed=" << cfg.seed << ", " << cfg.tickRate << " ticks/s)\n";
+    return true;
+}
+
+void GameServer::tick(){
+    auto t0 = std::chrono::steady_clock::now();
+    const float dt = 1.f / cfg.tickRate;
+
+    acceptClients();
+    for (auto &c : clients) receive(*c);
+    for (auto &c : clients) if (c->joined) simulate(*c, dt);
+    resolvePlayerCollisions();
+    sendChunkUpdates();
+    for (auto &c : clients) if (c->joined) streamChunks(*c);
+    sendEntities();
+    for (auto &c : clients) flush(*c);
+    dropDeadClients();
+    trimChunkCache();
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    ++stats.ticks;
+    stats.tickMillisTotal += ms;
+    stats.tickMillisMax = std::max(stats.tickMillisMax, ms);
+}
+
+void GameServer::acceptClients(){
+    for (;;){
+        if (!pendingAccept) pendingAccept = std::make_unique<Client>();
+        if (listener.accept(pendingAccept->socket) != sf::Socket::Status::Done) return;
+        pendingAccept->socket.setBlocking(false);
+        pendingAccept->id = nextId++;
+        clients.push_back(std::move(pendingAccept));
+    }
+}
+
+void GameServer::receive(Client &c){
+    sf::Packet p;
+    for (;;){
+        sf::Socket::Status st = c.socket.receive(p);
+        if (st == sf::Socket::Status::Done){
+            stats.bytesIn += wireSize(p);
+            handle(c, p);
+        } else {
+            if (st == sf::Socket::Status::Disconnected || st == sf::Socket::Status::Error) c.dead = true;
+            return;
+        }
+    }
+}
+
+void GameServer::handle(Client &c, sf::Packet &p){
+    uint8_t type = 0;
+    if (!(p >> type)) return;
+    switch (static_cast<MsgType>(type)){
+    case MsgType::Hello: {
+        uint32_t version = 0;
+        std::string name;
+        if (!readHello(p, version, name) || version != PROTOCOL_VERSION){ c.dead = true; return; }
+        if (c.joined) return;
+        c.joined = true;
+        c.body.pos = sf::Vector3f{0.f, static_cast<float>(world->surfaceHeight(0, 0)) + PLAYER_EYE_HEIGHT + 0.5f, 0.f};
+        joinedById[c.id] = &c;
+        players.insert(c.id, c.body.pos);
+        queue(c, makeWelcome({c.id, cfg.seed, cfg.tickRate}));
+        break;
+    }
+    case MsgType::Input:
+        if (!readInput(p, c.input)) c.dead = true;
+        break;
+    case MsgType::Edit: {
+        EditMsg e;
+        if (!readEdit(p, e) || !c.joined) return;
+        if (e.block >= BLOCK_TYPE_COUNT || e.y < 0 || e.y >= CHUNK_HEIGHT) return;
+        ChunkPos cp = chunkOf(e.x, e.z);
+        uint32_t before = world->chunk(cp).version;
+        if (!world->setBlock(e.x, e.y, e.z, e.block)) return;
+        ++stats.edits;
+        auto it = pendingEdits.find(cp);
+        if (it == pendingEdits.end()) it = pendingEdits.emplace(cp, PendingEdits{before, {}}).first;
+        int index = Chunk::index(floorMod(e.x, CHUNK_SIZE), e.y, floorMod(e.z, CHUNK_SIZE));
+        it->second.deltas.push_back({static_cast<uint16_t>(index), e.block});
+        break;
+    }
+    case MsgType::RegionEdit: {
+        RegionEditMsg m;
+        if (!readRegionEdit(p, m) || !c.joined) return;
+        regionEdit(c, m);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Runs a builder's bulk edit and queues each chunk it changed to be resent
+// whole, once, with this tick's other edits.
+void GameServer::regionEdit(Client &c, const RegionEditMsg &m){
+    static const char *const NAMES[] = { "fill", "replace", "copy", "paste", "undo" };
+    const BlockRegion region = regionBetween(m.x0, m.y0, m.z0, m.x1, m.y1, m.z1);
+    const RegionOp op = static_cast<RegionOp>(m.op);
+    if ((op == RegionOp::Fill || op == RegionOp::Replace) && m.block >= BLOCK_TYPE_COUNT) return;
+    // spans are checked per axis first: a box from INT_MIN to INT_MAX would otherwise load 2^28 chunk columns
+    if (op != RegionOp::Paste && op != RegionOp::Undo && !region.fitsWithin(cfg.maxRegionBlocks)) return;
+
+    EditJournal journal;
+    RegionEditStats s;
+    switch (op){
+    case RegionOp::Fill:
+        s = editor->fill(region, m.block, &journal);
+        break;
+    case RegionOp::Replace: {
+        BlockMask from;
+        for (int id = 0; id < BLOCK_TYPE_COUNT; ++id) from[id] = ((m.mask >> id) & 1) != 0;
+        s = editor->replace(region, from, m.block, &journal);
+        break;
+    }
+    case RegionOp::Copy:
+        s = editor->copy(region, c.clipboard);
+        break;
+    case RegionOp::Paste:
+        s = editor->paste(c.clipboard, m.x0, m.y0, m.z0, m.turns, m.skipAir, &journal);
+        break;
+    case RegionOp::Undo:
+        if (c.undo.empty()) return;
+        s = editor->undo(c.undo.back());
+        c.undo.pop_back();
+        break;
+    default:
+        return;
+    }
+    if (!journal.empty()){
+        c.undo.push_back(std::move(journal));
+        if (c.undo.size() > MAX_UNDO) c.undo.pop_front();
+    }
+    for (ChunkPos cp : s.changedChunks){
+        auto it = pendingEdits.find(cp);
+        if (it == pendingEdits.end()) it = pendingEdits.emplace(cp, PendingEdits{}).first;
+        it->second.resend = true; // baseVersion only matters for deltas
+    }
+    stats.edits += s.changed;
+    ++stats.regionEdits;
+    std::printf("[edit] client %u %s: %zu blocks, %zu changed in %zu chunks, %.1f ms (%.1f M blocks/s)\n", c.id, NAMES[m.op],
+        s.blocks, s.changed, s.chunks, s.seconds * 1000.0, s.blocksPerSecond() / 1e6);
+}
+
+void GameServer::simulate(Client &c, float dt){
+    float mx = c.input.moveX, mz = c.input.moveZ;
+    float len = std::sqrt(mx*mx + mz*mz);
+    if (len > 1.f){ mx /= len; mz /= len; }
+    if (c.input.jump && c.body.canJump){ c.body.vy = SERVER_JUMP_SPEED; c.body.canJump = false; }
+    stepWalking(c.body, mx * SERVER_WALK_SPEED * dt, mz * SERVER_WALK_SPEED * dt, SERVER_GRAVITY, dt,
+                [this](int x, int z){ return world->surfaceHeight(x, z); });
+    players.move(c.id, c.body.pos);
+}
+
+// Pushes overlapping players apart horizontally, unless that would walk one
+// of them into a wall.
+void GameServer::resolvePlayerCollisions(){
+    std::vector<uint32_t> near;
+    const float minDist = 2.f * PLAYER_RADIUS;
+    for (auto &cp : clients){
+        Client &a = *cp;
+        if (!a.joined) continue;
+        near.clear();
+        players.queryRadius(a.body.pos, minDist, near);
+        for (uint32_t id : near){
+            if (id <= a.id) continue; // each pair once
+            Client &b = *joinedById[id];
+            float dx = b.body.pos.x - a.body.pos.x, dz = b.body.pos.z - a.body.pos.z;
+            float d = std::sqrt(dx*dx + dz*dz);
+            if (d >= minDist) continue;
+            if (d < 1e-4f){ dx = 1.f; dz = 0.f; d = 1.f; } // stacked exactly: pick an axis
+            float push = 0.5f * (minDist - d) / d;
+            auto shove = [&](Client &c, float sx, float sz){
+                float x = c.body.pos.x + sx, z = c.body.pos.z + sz;
+                float footY = c.body.pos.y - PLAYER_EYE_HEIGHT;
+                if (world->surfaceHeight(int(std::round(x)), int(std::round(z))) > footY + 0.2f) return;
+                c.body.pos.x = x;
+                c.body.pos.z = z;
+                players.move(c.id, c.body.pos);
+            };
+            shove(a, -dx * push, -dz * push);
+            shove(b, dx * push, dz * push);
+        }
+    }
+}
+
+// Sends this tick's edits to every client holding the chunk, as a delta batch
+// or as the whole chunk again, whichever encodes smaller.
+void GameServer::sendChunkUpdates(){
+    std::vector<uint8_t> delta, full;
+    for (auto &entry : pendingEdits){
+        const ChunkPos cp = entry.first;
+        PendingEdits &pe = entry.second;
+        const Chunk &chunk = world->chunk(cp);
+        encodeChunk(chunk, full);
+        if (!pe.resend) encodeDeltas(pe.deltas, delta);
+        const bool useDelta = !pe.resend && delta.size() < full.size();
+        for (auto &c : clients){
+            auto held = c->sentChunks.find(cp);
+            if (held == c->sentChunks.end()) continue; // streamChunks sends the current version later
+            if (useDelta && held->second == pe.baseVersion){
+                queue(*c, makeChunkDelta(cp, pe.baseVersion, chunk.version, delta));
+                ++stats.deltasSent;
+                stats.deltaBytes += delta.size();
+            } else {
+                queue(*c, makeChunkData(cp, chunk.version, full));
+                ++stats.resends;
+                stats.chunkBytes += full.size();
+            }
+            held->second = chunk.version;
+        }
+    }
+    pendingEdits.clear();
+}
+
+void GameServer::streamChunks(Client &c){
+    if (c.queuedBytes > cfg.maxQueuedBytes) return;
+    ChunkPos centre = chunkOf(int(std::floor(c.body.pos.x)), int(std::floor(c.body.pos.z)));
+    std::vector<ChunkPos> missing;
+    for (int dz = -cfg.viewRadius; dz <= cfg.viewRadius; ++dz)
+        for (int dx = -cfg.viewRadius; dx <= cfg.viewRadius; ++dx){
+            ChunkPos p{centre.x + dx, centre.z + dz};
+            if (!c.sentChunks.count(p)) missing.push_back(p);
+        }
+    auto dist2 = [&](const ChunkPos &p){ int dx = p.x - centre.x, dz = p.z - centre.z; return dx*dx + dz*dz; };
+    std::sort(missing.begin(), missing.end(), [&](const ChunkPos &a, const ChunkPos &b){ return dist2(a) < dist2(b); });
+    std::vector<uint8_t> encoded;
+    for (int i = 0; i < cfg.chunksPerTick && i < static_cast<int>(missing.size()); ++i){
+        const Chunk &chunk = world->chunk(missing[i]);
+        encodeChunk(chunk, encoded);
+        queue(c, makeChunkData(chunk.pos, chunk.version, encoded));
+        c.sentChunks[missing[i]] = chunk.version;
+        ++stats.chunksSent;
+        stats.chunkBytes += encoded.size();
+    }
+}
+
+// Each client only hears about players within relevancyRadius; anyone missing
+// from an update is out of range.
+void GameServer::sendEntities(){
+    std::vector<uint32_t> near;
+    std::vector<EntityState> visible;
+    for (auto &c : clients){
+        if (!c->joined) continue;
+        near.clear();
+        visible.clear();
+        players.queryRadius(c->body.pos, cfg.relevancyRadius, near);
+        for (uint32_t id : near){
+            if (id == c->id) continue;
+            const Client &o = *joinedById[id];
+            visible.push_back({o.id, o.body.pos.x, o.body.pos.y, o.body.pos.z, o.input.yawDeg});
+        }
+        queue(*c, makeEntityUpdate(visible));
+    }
+}
+
+void GameServer::queue(Client &c, sf::Packet p){
+    c.queuedBytes += wireSize(p);
+    c.outbox.push_back(std::move(p));
+}
+
+void GameServer::flush(Client &c){
+    while (!c.outbox.empty() && !c.dead){
+        sf::Packet &p = c.outbox.front();
+        sf::Socket::Status st = c.socket.send(p);
+        if (st == sf::Socket::Status::Done){
+            size_t n = wireSize(p);
+            stats.bytesOut += n;
+            c.queuedBytes -= n;
+            c.outbox.pop_front();
+        } else if (st == sf::Socket::Status::Partial || st == sf::Socket::Status::NotReady){
+            return; // SFML resumes a partial packet on the next send of the same packet
+        } else {
+            c.dead = true;
+        }
+    }
+}
+
+void GameServer::dropDeadClients(){
+    std::vector<uint32_t> gone;
+    clients.erase(std::remove_if(clients.begin(), clients.end(), [&](const std::unique_ptr<Client> &c){
+        if (c->dead){
+            if (c->joined){
+                gone.push_back(c->id);
+                joinedById.erase(c->id);
+                players.remove(c->id);
+            }
+            return true;
+        }
+        return false;
+    }), clients.end());
+    for (uint32_t id : gone)
+        for (auto &c : clients) if (c->joined) queue(*c, makeEntityRemove(id));
+}
+
+// Pins every chunk in a player's view radius, then unloads the least
+// recently used of the rest until the world fits its budget.
+void GameServer::trimChunkCache(){
+    if (cfg.chunkCacheBytes == 0) return;
+    world->clearPins();
+    for (auto &c : clients){
+        if (!c->joined) continue;
+        const ChunkPos centre = chunkOf(int(std::floor(c->body.pos.x)), int(std::floor(c->body.pos.z)));
+        for (int dz = -cfg.viewRadius; dz <= cfg.viewRadius; ++dz)
+            for (int dx = -cfg.viewRadius; dx <= cfg.viewRadius; ++dx) world->pin({centre.x + dx, centre.z + dz});
+    }
+    world->trimCache();
+}
+
+void GameServer::stop(){
+    if (!world) return;
+    const size_t saved = world->saveAll();
+    if (saved) std::cout << "Saved " << saved << " edited chunks to " << cfg.saveDir << "\n";
+}
+
+void GameServer::report(double seconds){
+    const double ticks = stats.ticks ? static_cast<double>(stats.ticks) : 1.0;
+    const double perClient = clients.empty() ? 0.0 : 1.0 / static_cast<double>(clients.size());
+    const uint64_t fullSends = stats.chunksSent + stats.resends;
+    const ChunkMemoryStats mem = world->memoryStats();
+    std::printf("[server] %zu clients | tick avg %.2f ms, max %.2f ms (budget %.1f ms) | chunks loaded %zu (%.1f KB each, %zu uniform), sent %llu (avg %.0f B) | edits %llu (%llu region), deltas %llu (avg %.1f B), resends %llu | per client out %.1f KB/s, in %.2f KB/s",
+        clients.size(), stats.tickMillisTotal / ticks, stats.tickMillisMax, 1000.0 / cfg.tickRate,
+        mem.chunks, mem.chunks ? static_cast<double>(mem.bytes) / static_cast<double>(mem.chunks) / 1024.0 : 0.0, mem.uniform,
+        static_cast<unsigned long long>(stats.chunksSent),
+        fullSends ? static_cast<double>(stats.chunkBytes) / static_cast<double>(fullSends) : 0.0,
+        static_cast<unsigned long long>(stats.edits), static_cast<unsigned long long>(stats.regionEdits), static_cast<unsigned long long>(stats.deltasSent),
+        stats.deltasSent ? static_cast<double>(stats.deltaBytes) / static_cast<double>(stats.deltasSent) : 0.0,
+        static_cast<unsigned long long>(stats.resends),
+        static_cast<double>(stats.bytesOut) * perClient / 1024.0 / seconds, static_cast<double>(stats.bytesIn) * perClient / 1024.0 / seconds);
+    const ChunkCacheStats cache = world->cacheStats();
+    const uint64_t lookups = cache.hits + cache.misses;
+    std::printf(" | chunk cache %.1f MB", static_cast<double>(cache.residentBytes) / (1024.0 * 1024.0));
+    if (cache.budgetBytes) std::printf(" of %.1f MB", static_cast<double>(cache.budgetBytes) / (1024.0 * 1024.0));
+    std::printf(", hits %.2f%%, misses %llu (%llu from disk), evicted %llu, saved %llu%s | decorator %zu chunks, %zu queued\n",
+        lookups ? 100.0 * static_cast<double>(cache.hits) / static_cast<double>(lookups) : 100.0,
+        static_cast<unsigned long long>(cache.misses), static_cast<unsigned long long>(cache.loadedFromDisk),
+        static_cast<unsigned long long>(cache.evictions), static_cast<unsigned long long>(cache.writes),
+        cache.writeFailures ? " (SAVE FAILURES)" : "", cache.decoratorChunks, cache.decoratorQueued);
+    std::fflush(stdout);
+    stats = ServerStats();
+    world->resetCacheCounters();
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "net_protocol.h"
+#include "player_physics.h"
+#include "region_edit.h"
+#include "spatial_hash.h"
+#include "voxel_world.h"
+
+struct ServerConfig {
+    unsigned short port = DEFAULT_SERVER_PORT;
+    unsigned seed = 123;
+    float tickRate = 20.f;
+    int viewRadius = 4;               // chunks streamed around each player
+    int chunksPerTick = 4;            // per client
+    size_t maxQueuedBytes = 512 * 1024; // stop streaming chunks to a client above this backlog
+    float relevancyRadius = 64.f;     // players further away are left out of EntityUpdate
+    size_t chunkCacheBytes = 0;       // unload chunks outside every view radius above this (0: never)
+    std::string saveDir;              // edited chunks are saved here; empty keeps them loaded
+    size_t maxRegionBlocks = 1u << 24; // largest box one RegionEdit may fill, replace or copy
+    unsigned editThreads = 0;         // region edit workers (0: every core)
+};
+
+// Counters since the last report
+struct ServerStats {
+    uint64_t ticks = 0;
+    double tickMillisTotal = 0.0;
+    double tickMillisMax = 0.0;
+    uint64_t bytesOut = 0;
+    uint64_t bytesIn = 0;
+    uint64_t chunksSent = 0;
+    uint64_t chunkBytes = 0;
+    uint64_t deltasSent = 0;    // edit batches sent as ChunkDelta
+    uint64_t deltaBytes = 0;
+    uint64_t resends = 0;       // edit batches where the full chunk was smaller
+    uint64_t edits = 0;         // blocks changed, one at a time or by region edits
+    uint64_t regionEdits = 0;
+};
+
+// Headless authoritative server: owns the voxel world and player bodies,
+// accepts TCP clients, streams chunks around them and broadcasts positions.
+// Single-threaded; call tick() at config.tickRate.
+class GameServer {
+public:
+    bool start(const ServerConfig &config);
+    void tick();
+    // Saves every edited chunk; call before exiting.
+    void stop();
+    // Prints per-tick cost and per-client bandwidth over `seconds`, then resets the counters.
+    void report(double seconds);
+    size_t clientCount() const { return clients.size(); }
+
+private:
+    struct Client {
+        uint32_t id = 0;
+        sf::TcpSocket socket;
+        bool joined = false;
+        bool dead = false;
+        PlayerBody body;
+        InputMsg input;
+        std::unordered_map<ChunkPos, uint32_t, ChunkPosHash> sentChunks; // chunk version the client holds
+        std::deque<sf::Packet> outbox;
+        size_t queuedBytes = 0;
+        BlockClipboard clipboard;
+        std::deque<EditJournal> undo;   // newest last, at most MAX_UNDO
+    };
+    static const size_t MAX_UNDO = 8;
+
+    void acceptClients();
+    void receive(Client &c);
+    void handle(Client &c, sf::Packet &p);
+    void regionEdit(Client &c, const RegionEditMsg &m);
+    void simulate(Client &c, float dt);
+    void resolvePlayerCollisions();
+    void sendChunkUpdates();
+    void streamChunks(Client &c);
+    void sendEntities();
+    void queue(Client &c, sf::Packet p);
+    void flush(Client &c);
+    void dropDeadClients();
+    void trimChunkCache();
+
+    ServerConfig cfg;
+    sf::TcpListener listener;
+    std::unique_ptr<VoxelWorld> world;
+    std::unique_ptr<RegionEditor> editor;
+    std::vector<std::unique_ptr<Client>> clients;
+    std::unordered_map<uint32_t, Client*> joinedById;
+    SpatialHash players{static_cast<float>(CHUNK_SIZE)};
+    std::unique_ptr<Client> pendingAccept;
+    // edits applied this tick, per chunk
+    struct PendingEdits {
+        uint32_t baseVersion = 0;
+        std::vector<BlockDelta> deltas;
+        bool resend = false;    // a region edit rewrote it: send the whole chunk
+    };
+    std::unordered_map<ChunkPos, PendingEdits, ChunkPosHash> pendingEdits;
+    uint32_t nextId = 1;
+    ServerStats stats;
+};
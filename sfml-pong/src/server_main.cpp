@@ -0,0 +1,102 @@
+#include "server.h"
+#include "bot_client.h"
+#include "codec_bench.h"
+#include "octree_bench.h"
+#include "region_edit_bench.h"
+#include "spatial_bench.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// cube_server: headless dedicated server (no SFML graphics).
+//   --port P      listen port (default 27015)
+//   --seed S      world seed (default 123)
+//   --bots N      spawn N simulated clients on localhost for load testing
+//   --seconds T   exit after T seconds (default: run forever)
+//   --report T    stats interval in seconds (default 5)
+//   --cache-mb M  unload chunks outside every player's view above M MB (default: never)
+//   --save-dir D  save edited chunks to D when they are unloaded and on exit, and load them back
+//   --codec-bench R  benchmark the chunk codec on chunks within R of the origin and exit
+//   --spatial-bench N  benchmark the spatial hash with N entities (0 = 10k and 100k) and exit
+//   --svo-bench R  compare the sparse voxel octree with the chunk grid within R of the origin and exit
+//   --edit-bench N  time bulk fill/replace/paste/undo over an N x N block region (0 = 256) and exit
+//   --edit-threads N  region edit workers (default: every core)
+// Ctrl-C or SIGTERM ends the run the way --seconds does, saving edited chunks.
+
+static std::atomic<bool> stopRequested{false};
+static void requestStop(int){ stopRequested.store(true); }
+
+int main(int argc, char **argv){
+    ServerConfig cfg;
+    int bots = 0;
+    double runSeconds = 0.0;
+    double reportEvery = 5.0;
+    int codecBenchRadius = -1;
+    int spatialBenchCount = -1;
+    int svoBenchRadius = -1;
+    int editBenchSize = -1;
+    for (int i = 1; i < argc; ++i){
+        std::string a = argv[i];
+        if (i + 1 >= argc){ std::cerr << "Missing value for " << a << "\n"; return 2; }
+        const char *v = argv[++i];
+        if (a == "--port") cfg.port = static_cast<unsigned short>(std::atoi(v));
+        else if (a == "--seed") cfg.seed = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+        else if (a == "--bots") bots = std::atoi(v);
+        else if (a == "--seconds") runSeconds = std::atof(v);
+        else if (a == "--report") reportEvery = std::max(0.5, std::atof(v));
+        else if (a == "--cache-mb") cfg.chunkCacheBytes = static_cast<size_t>(std::max(0.0, std::atof(v)) * 1024.0 * 1024.0);
+        else if (a == "--save-dir") cfg.saveDir = v;
+        else if (a == "--codec-bench") codecBenchRadius = std::max(0, std::atoi(v));
+        else if (a == "--spatial-bench") spatialBenchCount = std::max(0, std::atoi(v));
+        else if (a == "--svo-bench") svoBenchRadius = std::max(0, std::atoi(v));
+        else if (a == "--edit-bench") editBenchSize = std::max(0, std::atoi(v));
+        else if (a == "--edit-threads") cfg.editThreads = static_cast<unsigned>(std::max(0, std::atoi(v)));
+        else { std::cerr << "Unknown argument: " << a << "\nUsage: cube_server [--port P] [--seed S] [--bots N] [--seconds T] [--report T] [--cache-mb M] [--save-dir D] [--codec-bench R] [--spatial-bench N] [--svo-bench R] [--edit-bench N] [--edit-threads N]\n"; return 2; }
+    }
+    if (codecBenchRadius >= 0) return runCodecBench(cfg.seed, codecBenchRadius);
+    if (spatialBenchCount >= 0) return runSpatialBench(spatialBenchCount);
+    if (svoBenchRadius >= 0) return runOctreeBench(cfg.seed, svoBenchRadius);
+    if (editBenchSize >= 0) return runRegionEditBench(cfg.seed, editBenchSize, cfg.editThreads);
+
+    GameServer server;
+    if (!server.start(cfg)) return 1;
+
+    std::unique_ptr<BotSwarm> swarm;
+    if (bots > 0){
+        swarm = std::make_unique<BotSwarm>(bots, cfg.port);
+        swarm->start();
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    using clock = std::chrono::steady_clock;
+    const auto tickDuration = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / cfg.tickRate));
+    const auto started = clock::now();
+    auto next = started;
+    auto lastReport = started;
+    while (!stopRequested.load()){
+        server.tick();
+
+        auto now = clock::now();
+        double sinceReport = std::chrono::duration<double>(now - lastReport).count();
+        if (sinceReport >= reportEvery){
+            server.report(sinceReport);
+            lastReport = now;
+        }
+        if (runSeconds > 0.0 && std::chrono::duration<double>(now - started).count() >= runSeconds) break;
+
+        next += tickDuration;
+        if (now > next + tickDuration * 4) next = now; // overloaded: don't burst to catch up
+        std::this_thread::sleep_until(next);
+    }
+    if (swarm) swarm->stop();
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "shader_manager.h"
+#include <iostream>
+#include <vector>
+
+static GLuint compileStage(const std::string &name, GLenum type, const char *src){
+    GLuint s = glCreateShader(type);
+    glShaderSource(s, 1, &src, nullptr);
+    glCompileShader(s);
+    GLint ok = 0;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    if (!ok){
+        GLint len = 0;
+        glGetShaderiv(s, GL_INFO_LOG_LENGTH, &len);
+        std::vector<GLchar> log(static_cast<size_t>(len > 1 ? len : 1), '\0');
+        glGetShaderInfoLog(s, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::cerr << "Shader '" << name << "' (" << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << ") failed to compile:\n" << log.data() << "\n";
+        glDeleteShader(s);
+        return 0;
+    }
+    return s;
+}
+
+ShaderProgram::~ShaderProgram(){
+    if (id) glDeleteProgram(id);
+}
+
+bool ShaderProgram::build(const std::string &name, const char *vertexSrc, const char *fragmentSrc){
+    GLuint vs = compileStage(name, GL_VERTEX_SHADER, vertexSrc);
+    GLuint fs = compileStage(name, GL_FRAGMENT_SHADER, fragmentSrc);
+    if (!vs || !fs){
+        if (vs) glDeleteShader(vs);
+        if (fs) glDeleteShader(fs);
+        return false;
+    }
+    GLuint p = glCreateProgram();
+    glAttachShader(p, vs);
+    glAttachShader(p, fs);
+    glLinkProgram(p);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint ok = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    if (!ok){
+        GLint len = 0;
+        glGetProgramiv(p, GL_INFO_LOG_LENGTH, &len);
+        std::vector<GLchar> log(static_cast<size_t>(len > 1 ? len : 1), '\0');
+        glGetProgramInfoLog(p, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::cerr << "Shader '" << name << "' failed to link:\n" << log.data() << "\n";
+        glDeleteProgram(p);
+        return false;
+    }
+    if (id) glDeleteProgram(id);
+    id = p;
+    return true;
+}
+
+bool ShaderProgram::bindBlock(const char *blockName, GLuint binding) const{
+    GLuint index = glGetUniformBlockIndex(id, blockName);
+    if (index == GL_INVALID_INDEX) return false;
+    glUniformBlockBinding(id, index, binding);
+    return true;
+}
+
+ShaderProgram* ShaderManager::load(const std::string &name, const char *vertexSrc, const char *fragmentSrc){
+    auto program = std::make_unique<ShaderProgram>();
+    if (!program->build(name, vertexSrc, fragmentSrc)) return nullptr;
+    ShaderProgram *raw = program.get();
+    programs[name] = std::move(program);
+    return raw;
+}
+
+ShaderProgram* ShaderManager::get(const std::string &name) const{
+    auto it = programs.find(name);
+    return it == programs.end() ? nullptr : it->second.get();
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "gl_functions.h"
+
+// A linked GLSL program. Look uniform locations up once after loading and keep
+// them; uniform() goes to the driver every time.
+class ShaderProgram {
+public:
+    ShaderProgram() = default;
+    ~ShaderProgram();
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    // Compiles and links; on failure prints the info log and returns false.
+    bool build(const std::string &name, const char *vertexSrc, const char *fragmentSrc);
+    void use() const { glUseProgram(id); }
+    GLuint handle() const { return id; }
+    GLint uniform(const char *name) const { return glGetUniformLocation(id, name); }
+    // Points a named uniform block at a UBO binding point; false if the program doesn't use it.
+    bool bindBlock(const char *blockName, GLuint binding) const;
+
+private:
+    GLuint id = 0;
+};
+
+// Owns every program by name so they are built once and deleted together.
+class ShaderManager {
+public:
+    ShaderProgram* load(const std::string &name, const char *vertexSrc, const char *fragmentSrc);
+    ShaderProgram* get(const std::string &name) const;
+    void clear() { programs.clear(); }
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<ShaderProgram>> programs;
+};
@@ -0,0 +1,234 @@
+#include "simulation.h"
+#include "world.h"
+#include "input_log.h"
+#include "math3d.h"
+#include "player_physics.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+static const float eyeHeight = PLAYER_EYE_HEIGHT;
+static const float walkSpeed = 4.0f;
+static const float sprintMultiplier = 1.9f;
+
+static bool held(const SimInput &in, uint32_t key){ return (in.held & key) != 0; }
+
+// Collision against the global heightmap, clamped to its edges like before
+static int heightmapAt(int gx, int gz){
+    int half = CHUNK/2;
+    return getHeightAt(std::clamp(gx + half, 0, CHUNK-1), std::clamp(gz + half, 0, CHUNK-1));
+}
+
+static void clampPitch(SimState &s){
+    if (s.camPitchDeg > 89.f) s.camPitchDeg = 89.f;
+    if (s.camPitchDeg < -89.f) s.camPitchDeg = -89.f;
+}
+
+static void applyCommand(SimState &s, const SimCommand &c){
+    switch (c.action){
+    case SimAction::Jump:
+        // Jump when in FPS walking mode
+        if (s.fpsMode && !s.flyMode && s.canJump){ s.playerVy = s.jumpSpeed; s.canJump = false; }
+        break;
+    case SimAction::ToggleFly: s.flyMode = !s.flyMode; std::cout << "Fly mode " << (s.flyMode ? "ON" : "OFF") << "\n"; break;
+    case SimAction::ToggleFps: {
+        s.fpsMode = !s.fpsMode;
+        // set initial player position from camera center
+        s.playerPos.x = s.camCenter.x;
+        s.playerPos.z = s.camCenter.z;
+        // place player above terrain
+        int half = CHUNK/2;
+        int xi = std::clamp(int(round(s.playerPos.x + half)), 0, CHUNK-1);
+        int zi = std::clamp(int(round(s.playerPos.z + half)), 0, CHUNK-1);
+        float groundY = static_cast<float>(getHeightAt(xi, zi)) + eyeHeight;
+        // Ensure we spawn slightly above ground to avoid sticking
+        if (s.playerPos.y < groundY + 0.5f) s.playerPos.y = groundY + 0.5f;
+        s.playerVy = 0.f;
+        s.canJump = true;
+        std::cout << "FPS mode " << (s.fpsMode ? "ON" : "OFF") << "\n";
+        break;
+    }
+    case SimAction::ToggleInvert: s.invertMouse = !s.invertMouse; std::cout << "Invert mouse " << (s.invertMouse ? "ON" : "OFF") << "\n"; break;
+    case SimAction::RegenerateNext: generateTerrain(s.terrainSeed + 1); ++s.terrainVersion; break;
+    case SimAction::Regenerate: generateTerrain(c.seed); ++s.terrainVersion; break;
+    case SimAction::SensDown: s.mouseLookSpeed = std::max(0.01f, s.mouseLookSpeed - 0.01f); std::cout << "Mouse sens = " << s.mouseLookSpeed << "\n"; break;
+    case SimAction::SensUp: s.mouseLookSpeed = std::min(5.0f, s.mouseLookSpeed + 0.01f); std::cout << "Mouse sens = " << s.mouseLookSpeed << "\n"; break;
+    case SimAction::JumpUp: s.jumpSpeed += 0.5f; std::cout << "Jump = " << s.jumpSpeed << "\n"; break;
+    case SimAction::JumpDown: s.jumpSpeed = std::max(0.5f, s.jumpSpeed - 0.5f); std::cout << "Jump = " << s.jumpSpeed << "\n"; break;
+    case SimAction::GravityUp: s.gravity += 1.0f; std::cout << "Gravity = " << s.gravity << "\n"; break;
+    case SimAction::GravityDown: s.gravity = std::max(0.1f, s.gravity - 1.0f); std::cout << "Gravity = " << s.gravity << "\n"; break;
+    case SimAction::ResetTunables: s.mouseLookSpeed = 0.15f; s.jumpSpeed = 6.5f; s.gravity = 20.0f; std::cout << "Tunables reset\n"; break;
+    case SimAction::FlySpeedUp: s.flySpeed *= 1.1f; if (s.flySpeed > 100.f) s.flySpeed = 100.f; std::cout << "Fly speed = " << s.flySpeed << "\n"; break;
+    case SimAction::FlySpeedDown: s.flySpeed /= 1.1f; if (s.flySpeed < 0.01f) s.flySpeed = 0.01f; std::cout << "Fly speed = " << s.flySpeed << "\n"; break;
+    case SimAction::Look: {
+        float sign = s.invertMouse ? -1.f : 1.f;
+        s.camYawDeg += c.x * s.mouseLookSpeed * sign;
+        s.camPitchDeg += c.y * s.mouseLookSpeed * sign;
+        clampPitch(s);
+        break;
+    }
+    case SimAction::OrbitRotate: {
+        float sign = s.invertMouse ? -1.f : 1.f;
+        s.camYawDeg += c.x * s.mouseRotateSpeed * sign;
+        s.camPitchDeg += c.y * s.mouseRotateSpeed * sign;
+        clampPitch(s);
+        break;
+    }
+    case SimAction::OrbitPan: {
+        float panFactor = s.mousePanFactor * s.camDistance;
+        s.camCenter.x -= c.x * panFactor;
+        s.camCenter.y += c.y * panFactor;
+        break;
+    }
+    case SimAction::Zoom:
+        s.camDistance -= c.x * s.scrollZoomSpeed;
+        if (s.camDistance < 1.f) s.camDistance = 1.f;
+        break;
+    }
+}
+
+void stepSimulation(SimState &s, const SimInput &in, float dt){
+    for (const auto &c : in.commands) applyCommand(s, c);
+
+    // Handle continuous camera controls (keyboard held)
+    const float yawSpeed = 90.f; // deg/sec
+    const float pitchSpeed = 80.f; // deg/sec
+    const float zoomSpeed = 3.f; // units/sec
+    const float panSpeed = 2.f; // units/sec
+    if (held(in, KEY_LEFT)) s.camYawDeg -= yawSpeed * dt;
+    if (held(in, KEY_RIGHT)) s.camYawDeg += yawSpeed * dt;
+    if (held(in, KEY_UP)) s.camPitchDeg += pitchSpeed * dt;
+    if (held(in, KEY_DOWN)) s.camPitchDeg -= pitchSpeed * dt;
+    s.sprinting = false;
+    if (s.fpsMode){
+        // Movement on XZ plane for walking
+        sf::Vector3f forwardXZ = forwardFromYawPitch(s.camYawDeg, 0.f);
+        sf::Vector3f rightXZ{ forwardXZ.z, 0.f, -forwardXZ.x };
+        float fwd=0.f, rgt=0.f;
+        if (held(in, KEY_W)) fwd += 1.f;
+        if (held(in, KEY_S)) fwd -= 1.f;
+        if (held(in, KEY_D)) rgt += 1.f;
+        if (held(in, KEY_A)) rgt -= 1.f;
+        // invert strafing when invertMouse is set
+        rgt *= (s.invertMouse ? -1.f : 1.f);
+        float speed = walkSpeed;
+        if (held(in, KEY_LSHIFT)) { speed *= sprintMultiplier; s.sprinting = true; }
+
+        if (s.flyMode){
+            // Fly-style FPS (no gravity), include pitch for forward/back
+            sf::Vector3f forward = forwardFromYawPitch(s.camYawDeg, s.camPitchDeg);
+            sf::Vector3f right = cross(forward, sf::Vector3f{1.f, 0.f, 0.f});
+            float upf = 0.f;
+            if (held(in, KEY_SPACE)) upf += 1.f;
+            if (held(in, KEY_LCONTROL)) upf -= 1.f;
+            sf::Vector3f delta = sf::Vector3f{ forward.x * fwd + right.x * rgt, forward.y * fwd + upf, forward.z * fwd + right.z * rgt };
+            s.playerPos.x += delta.x * speed * dt;
+            s.playerPos.y += delta.y * speed * dt;
+            s.playerPos.z += delta.z * speed * dt;
+        } else {
+            // walking with gravity and simple block collision
+            sf::Vector3f delta = sf::Vector3f{ forwardXZ.x * fwd + rightXZ.x * rgt, 0.f, forwardXZ.z * fwd + rightXZ.z * rgt };
+            PlayerBody body{ s.playerPos, s.playerVy, s.canJump };
+            stepWalking(body, delta.x * speed * dt, delta.z * speed * dt, s.gravity, dt, heightmapAt);
+            s.playerPos = body.pos;
+            s.playerVy = body.vy;
+            s.canJump = body.canJump;
+        }
+    } else if (!s.flyMode){
+        if (held(in, KEY_W)) s.camDistance -= zoomSpeed * dt;
+        if (held(in, KEY_S)) s.camDistance += zoomSpeed * dt;
+        float hSign = s.invertMouse ? -1.f : 1.f;
+        if (held(in, KEY_A)) s.camCenter.x -= panSpeed * dt * hSign;
+        if (held(in, KEY_D)) s.camCenter.x += panSpeed * dt * hSign;
+        if (held(in, KEY_Q)) s.camCenter.y += panSpeed * dt;
+        if (held(in, KEY_E)) s.camCenter.y -= panSpeed * dt;
+    } else {
+        // Fly movement: W/S forward/back, A/D strafe, Space up, LShift down
+        sf::Vector3f forward = forwardFromYawPitch(s.camYawDeg, s.camPitchDeg);
+        sf::Vector3f right = normalize(cross(forward, sf::Vector3f{0.f, 1.f, 0.f}));
+        float fwd=0.f, rgt=0.f, upf=0.f;
+        if (held(in, KEY_W)) fwd += 1.f;
+        if (held(in, KEY_S)) fwd -= 1.f;
+        if (held(in, KEY_D)) rgt += 1.f;
+        if (held(in, KEY_A)) rgt -= 1.f;
+        // invert strafe when invertMouse is set
+        rgt *= (s.invertMouse ? -1.f : 1.f);
+        if (held(in, KEY_SPACE)) upf += 1.f;
+        if (held(in, KEY_LSHIFT)) upf -= 1.f;
+        float speed = s.flySpeed;
+        if (held(in, KEY_LCONTROL)) speed *= s.flySpeedBoost;
+        sf::Vector3f delta{ forward.x * fwd + right.x * rgt, forward.y * fwd + right.y * rgt + upf, forward.z * fwd + right.z * rgt };
+        s.camCenter.x += delta.x * speed * dt;
+        s.camCenter.y += delta.y * speed * dt;
+        s.camCenter.z += delta.z * speed * dt;
+    }
+    // clamp
+    if (s.camDistance < 1.0f) s.camDistance = 1.0f;
+    clampPitch(s);
+}
+
+SimulationThread::SimulationThread(const SimState &initial, InputRecorder *recorder, InputPlayer *player)
+    : state(initial), snapshots(SimSnapshot{initial, 0, 0.f}), recorder(recorder), player(player) {
+    thread = std::thread([this]{ run(); });
+}
+
+SimulationThread::~SimulationThread(){
+    running.store(false, std::memory_order_relaxed);
+    thread.join();
+}
+
+void SimulationThread::post(const SimCommand &cmd){
+    SimCommand c = cmd;
+    // the sim drains every tick; a full queue means it is badly behind, so drop
+    if (!commands.tryPush(c)){ std::cout << "Simulation input queue full, dropping command\n"; return; }
+    ++posted;
+}
+
+void SimulationThread::run(){
+    using clock = std::chrono::steady_clock;
+    const auto tickDuration = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / SIM_TICK_RATE));
+    const float dt = 1.f / SIM_TICK_RATE;
+    uint64_t tick = 0, consumed = 0;
+    auto next = clock::now();
+    traceSetThreadName("simulation");
+
+    while (running.load(std::memory_order_relaxed)){
+        TraceZone tickZone("sim tick");
+        input.commands.clear();
+        SimCommand c;
+        if (player){
+            while (commands.tryPop(c)) ++consumed;
+            if (!replayDone.load(std::memory_order_relaxed) && !player->next(input)){
+                std::cout << "Replay finished after " << player->ticks() << " ticks\n";
+                replayDone.store(true, std::memory_order_release);
+            }
+            if (replayDone.load(std::memory_order_relaxed)){
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                continue;
+            }
+        } else {
+            while (commands.tryPop(c)){ input.commands.push_back(c); ++consumed; }
+            input.held = heldKeys.load(std::memory_order_relaxed);
+        }
+        if (recorder) recorder->record(input);
+
+        auto t0 = clock::now();
+        stepSimulation(state, input, dt);
+        auto t1 = clock::now();
+
+        SimSnapshot &snap = snapshots.writeBuffer();
+        snap.state = state;
+        snap.tick = ++tick;
+        snap.stepMillis = std::chrono::duration<float, std::milli>(t1 - t0).count();
+        snap.commandsConsumed = consumed;
+        snapshots.publish();
+        tickZone.end();
+
+        next += tickDuration;
+        // after a long stall, resync instead of running a burst of catch-up ticks
+        if (t1 > next + tickDuration * 8) next = t1;
+        std::this_thread::sleep_until(next);
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <SFML/System.hpp>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "lockfree_queue.h"
+#include "triple_buffer.h"
+
+// Held-key bits sampled by the window thread once per frame
+enum SimKey : uint32_t {
+    KEY_W = 1u << 0, KEY_A = 1u << 1, KEY_S = 1u << 2, KEY_D = 1u << 3,
+    KEY_Q = 1u << 4, KEY_E = 1u << 5, KEY_SPACE = 1u << 6, KEY_LSHIFT = 1u << 7,
+    KEY_LCONTROL = 1u << 8, KEY_LEFT = 1u << 9, KEY_RIGHT = 1u << 10,
+    KEY_UP = 1u << 11, KEY_DOWN = 1u << 12
+};
+
+enum class SimAction : uint8_t {
+    Jump, ToggleFly, ToggleFps, ToggleInvert,
+    RegenerateNext, Regenerate,
+    SensDown, SensUp, JumpUp, JumpDown, GravityUp, GravityDown, ResetTunables,
+    FlySpeedUp, FlySpeedDown,
+    Look, OrbitRotate, OrbitPan, Zoom
+};
+
+// Discrete input from the window thread. x/y carry mouse deltas or scroll,
+// seed carries the terrain seed for Regenerate.
+struct SimCommand {
+    SimAction action = SimAction::Jump;
+    float x = 0.f, y = 0.f;
+    uint32_t seed = 0;
+};
+
+struct SimInput {
+    uint32_t held = 0;
+    std::vector<SimCommand> commands;
+};
+
+// Camera and player state; owned by the simulation thread.
+struct SimState {
+    // Camera (orbit) parameters
+    float camDistance = 5.0f;
+    float camYawDeg = 45.0f;
+    float camPitchDeg = -10.0f;
+    sf::Vector3f camCenter{0.f, 0.f, 0.f};
+    float mouseRotateSpeed = 0.25f; // degrees per pixel
+    float mousePanFactor = 0.01f;   // world units per pixel
+    float scrollZoomSpeed = 0.8f;   // units per scroll step
+
+    // Fly / creative mode
+    bool flyMode = false;
+    float flySpeed = 6.0f; // units/sec
+    float flySpeedBoost = 2.5f; // multiplier for LCtrl
+
+    // FPS (first-person) mode
+    bool fpsMode = false;
+    bool sprinting = false;
+    sf::Vector3f playerPos{0.f, 2.f, 0.f};
+    float playerVy = 0.f;
+    bool canJump = false;
+    float gravity = 20.0f;
+    float mouseLookSpeed = 0.15f; // degrees per pixel-ish
+    float jumpSpeed = 6.5f; // upward impulse
+    bool invertMouse = false; // invert Y axis for mouse look (toggle V)
+
+    unsigned terrainSeed = 123;
+    uint32_t terrainVersion = 0; // bumped whenever the sim regenerates terrain
+};
+
+// Immutable copy of the state published after every tick.
+struct SimSnapshot {
+    SimState state;
+    uint64_t tick = 0;
+    float stepMillis = 0.f;
+    uint64_t commandsConsumed = 0;  // posted commands this state includes
+};
+
+const float SIM_TICK_RATE = 120.f;
+
+class InputRecorder;
+class InputPlayer;
+
+void stepSimulation(SimState &s, const SimInput &in, float dt);
+
+// Runs stepSimulation at a fixed rate on its own thread. The window thread
+// feeds it through post()/setHeldKeys() and reads snapshots with latest().
+// With a recorder every consumed tick input is logged; with a player the
+// inputs come from the log instead and live input is discarded.
+class SimulationThread {
+public:
+    explicit SimulationThread(const SimState &initial, InputRecorder *recorder = nullptr, InputPlayer *player = nullptr);
+    ~SimulationThread();
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    void post(const SimCommand &cmd);
+    // Commands accepted by post() so far; compare with commandsConsumed
+    uint64_t commandsPosted() const { return posted; }
+    void setHeldKeys(uint32_t held) { heldKeys.store(held, std::memory_order_relaxed); }
+    const SimSnapshot& latest() { return snapshots.read(); }
+    bool replayFinished() const { return replayDone.load(std::memory_order_acquire); }
+
+private:
+    void run();
+
+    SimState state;
+    SimInput input;
+    TripleBuffer<SimSnapshot> snapshots;
+    LockFreeQueue<SimCommand> commands{1024};
+    std::atomic<uint32_t> heldKeys{0};
+    std::atomic<bool> running{true};
+    std::atomic<bool> replayDone{false};
+    uint64_t posted = 0;                // window thread only
+    InputRecorder *recorder;
+    InputPlayer *player;
+    std::thread thread;
+};
@@ -0,0 +1,90 @@
+#include "spatial_bench.h"
+#include "spatial_hash.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using BenchClock = std::chrono::steady_clock;
+
+static double millisSince(BenchClock::time_point t0){
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - t0).count();
+}
+
+static void benchOnce(int count){
+    // constant density: one entity per 16 square blocks
+    const float side = std::sqrt(static_cast<float>(count) * 16.f);
+    const float collideRadius = 1.f;
+    const float relevancyRadius = 64.f;  // server view radius of 4 chunks
+    const int sampled = std::min(count, 1000);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-side * 0.5f, side * 0.5f);
+    std::uniform_real_distribution<float> height(2.f, 40.f);
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+    std::vector<sf::Vector3f> pos(count);
+    for (auto &p : pos) p = {coord(rng), height(rng), coord(rng)};
+
+    SpatialHash hash(16.f);
+    auto t0 = BenchClock::now();
+    for (int i = 0; i < count; ++i) hash.insert(static_cast<uint32_t>(i), pos[i]);
+    const double insertMs = millisSince(t0);
+
+    for (auto &p : pos){ p.x += step(rng); p.z += step(rng); }
+    t0 = BenchClock::now();
+    for (int i = 0; i < count; ++i) hash.move(static_cast<uint32_t>(i), pos[i]);
+    const double moveMs = millisSince(t0);
+
+    std::vector<uint32_t> hits;
+    size_t collideHits = 0;
+    t0 = BenchClock::now();
+    for (int i = 0; i < count; ++i){
+        hits.clear();
+        hash.queryRadius(pos[i], collideRadius, hits);
+        collideHits += hits.size();
+    }
+    const double collideMs = millisSince(t0);
+
+    size_t relevantHits = 0;
+    t0 = BenchClock::now();
+    for (int i = 0; i < sampled; ++i){
+        hits.clear();
+        hash.queryRadius(pos[i], relevancyRadius, hits);
+        relevantHits += hits.size();
+    }
+    const double relevantMs = millisSince(t0);
+
+    // brute force on a sample, extrapolated to every entity
+    size_t bruteHits = 0;
+    const float r2 = collideRadius * collideRadius;
+    t0 = BenchClock::now();
+    for (int i = 0; i < sampled; ++i)
+        for (int j = 0; j < count; ++j){
+            sf::Vector3f d = pos[j] - pos[i];
+            if (d.x*d.x + d.y*d.y + d.z*d.z <= r2) ++bruteHits;
+        }
+    const double bruteMs = millisSince(t0) * count / sampled;
+
+    size_t sampleHits = 0;
+    for (int i = 0; i < sampled; ++i){
+        hits.clear();
+        hash.queryRadius(pos[i], collideRadius, hits);
+        sampleHits += hits.size();
+    }
+
+    std::printf("%d entities over %.0fx%.0f blocks, %zu cells\n", count, side, side, hash.cellCount());
+    std::printf("  insert all       %8.2f ms\n", insertMs);
+    std::printf("  move all         %8.2f ms\n", moveMs);
+    std::printf("  collide r=%.0f     %8.2f ms for all (%.2f hits avg)\n", collideRadius, collideMs, static_cast<double>(collideHits) / count);
+    std::printf("  relevancy r=%.0f  %8.4f ms per query (%.1f hits avg)\n", relevancyRadius, relevantMs / sampled, static_cast<double>(relevantHits) / sampled);
+    std::printf("  brute force      %8.2f ms for all (estimated from %d), %s\n", bruteMs, sampled,
+        bruteHits == sampleHits ? "results match" : "RESULTS DIFFER");
+}
+
+int runSpatialBench(int count){
+    if (count > 0) benchOnce(count);
+    else { benchOnce(10000); benchOnce(100000); }
+    return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// `cube_server --spatial-bench N`: times SpatialHash insert/move/query for N
+// entities (N = 0 runs 10k and 100k) against a brute-force scan.
+int runSpatialBench(int count);
@@ -0,0 +1,90 @@
+#include "spatial_hash.h"
+#include <cmath>
+
+SpatialHash::SpatialHash(float cellSize) : cellSize(cellSize), invCellSize(1.f / cellSize) {}
+
+int SpatialHash::cellCoord(float v) const {
+    return static_cast<int>(std::floor(v * invCellSize));
+}
+
+void SpatialHash::link(uint32_t id, Entry &e){
+    auto &list = cells[e.cell];
+    e.slot = static_cast<uint32_t>(list.size());
+    list.push_back({id, e.pos});
+}
+
+void SpatialHash::unlink(const Entry &e){
+    auto it = cells.find(e.cell);
+    auto &list = it->second;
+    if (e.slot + 1 != list.size()){
+        // swap the last item into the hole and fix its slot
+        list[e.slot] = list.back();
+        entries[list[e.slot].id].slot = e.slot;
+    }
+    list.pop_back();
+    if (list.empty()) cells.erase(it);
+}
+
+void SpatialHash::insert(uint32_t id, const sf::Vector3f &pos){
+    if (entries.count(id)){ move(id, pos); return; }
+    Entry &e = entries[id];
+    e.pos = pos;
+    e.cell = cellOf(pos);
+    link(id, e);
+}
+
+void SpatialHash::move(uint32_t id, const sf::Vector3f &pos){
+    auto it = entries.find(id);
+    if (it == entries.end()){ insert(id, pos); return; }
+    Entry &e = it->second;
+    uint64_t cell = cellOf(pos);
+    e.pos = pos;
+    if (cell == e.cell){
+        cells[cell][e.slot].pos = pos;
+        return;
+    }
+    unlink(e);
+    e.cell = cell;
+    link(id, e);
+}
+
+void SpatialHash::remove(uint32_t id){
+    auto it = entries.find(id);
+    if (it == entries.end()) return;
+    unlink(it->second);
+    entries.erase(it);
+}
+
+void SpatialHash::clear(){
+    cells.clear();
+    entries.clear();
+}
+
+void SpatialHash::queryRadius(const sf::Vector3f &centre, float radius, std::vector<uint32_t> &out) const {
+    const float r2 = radius * radius;
+    const int x0 = cellCoord(centre.x - radius), x1 = cellCoord(centre.x + radius);
+    const int z0 = cellCoord(centre.z - radius), z1 = cellCoord(centre.z + radius);
+    for (int cz = z0; cz <= z1; ++cz)
+        for (int cx = x0; cx <= x1; ++cx){
+            auto it = cells.find(cellKey(cx, cz));
+            if (it == cells.end()) continue;
+            for (const Item &item : it->second){
+                sf::Vector3f d = item.pos - centre;
+                if (d.x*d.x + d.y*d.y + d.z*d.z <= r2) out.push_back(item.id);
+            }
+        }
+}
+
+void SpatialHash::queryAABB(const sf::Vector3f &lo, const sf::Vector3f &hi, std::vector<uint32_t> &out) const {
+    const int x0 = cellCoord(lo.x), x1 = cellCoord(hi.x);
+    const int z0 = cellCoord(lo.z), z1 = cellCoord(hi.z);
+    for (int cz = z0; cz <= z1; ++cz)
+        for (int cx = x0; cx <= x1; ++cx){
+            auto it = cells.find(cellKey(cx, cz));
+            if (it == cells.end()) continue;
+            for (const Item &item : it->second){
+                const sf::Vector3f &p = item.pos;
+                if (p.x >= lo.x && p.x <= hi.x && p.y >= lo.y && p.y <= hi.y && p.z >= lo.z && p.z <= hi.z) out.push_back(item.id);
+            }
+        }
+}
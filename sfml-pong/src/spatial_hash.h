@@ -0,0 +1,50 @@
+#pragma once
+#include <SFML/System.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over the XZ plane for "who is near whom" queries. Entities are
+// points keyed by id; insert/move/remove are O(1) and a move that stays in the
+// same cell only updates the stored position. Queries visit the cells
+// overlapping the query box and test the exact positions, including Y.
+class SpatialHash {
+public:
+    explicit SpatialHash(float cellSize = 16.f);
+
+    void insert(uint32_t id, const sf::Vector3f &pos);
+    void move(uint32_t id, const sf::Vector3f &pos);    // inserts if missing
+    void remove(uint32_t id);
+    void clear();
+    bool contains(uint32_t id) const { return entries.count(id) != 0; }
+    size_t size() const { return entries.size(); }
+    size_t cellCount() const { return cells.size(); }
+
+    // Ids within `radius` of `centre` / inside [lo, hi], appended to out.
+    void queryRadius(const sf::Vector3f &centre, float radius, std::vector<uint32_t> &out) const;
+    void queryAABB(const sf::Vector3f &lo, const sf::Vector3f &hi, std::vector<uint32_t> &out) const;
+
+private:
+    struct Entry {
+        sf::Vector3f pos;
+        uint64_t cell = 0;
+        uint32_t slot = 0; // index in the cell's list
+    };
+    struct Item {
+        uint32_t id;
+        sf::Vector3f pos;  // copied so queries don't chase the entry map
+    };
+
+    uint64_t cellKey(int cx, int cz) const {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cz);
+    }
+    int cellCoord(float v) const;
+    uint64_t cellOf(const sf::Vector3f &p) const { return cellKey(cellCoord(p.x), cellCoord(p.z)); }
+    void unlink(const Entry &e);
+    void link(uint32_t id, Entry &e);
+
+    float cellSize;
+    float invCellSize;
+    std::unordered_map<uint64_t, std::vector<Item>> cells;
+    std::unordered_map<uint32_t, Entry> entries;
+};
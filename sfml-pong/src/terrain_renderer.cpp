@@ -0,0 +1,342 @@
+#include "terrain_renderer.h"
+#include <algorithm>
+#include <chrono>
+
+TerrainRenderer::TerrainRenderer(unsigned workerThreads) : workers(workerThreads) {}
+
+// Starting size of the vertex pool (80 bytes a quad); it doubles when full
+static const size_t INITIAL_POOL_QUADS = 16384;
+
+TerrainRenderer::~TerrainRenderer(){
+    for (auto &row : sections)
+        for (auto &s : row){
+            if (s.blendVao) glDeleteVertexArrays(1, &s.blendVao);
+            if (s.blendVbo) glDeleteBuffers(1, &s.blendVbo);
+            if (s.blendEbo) glDeleteBuffers(1, &s.blendEbo);
+        }
+    if (quadIndexBuffer) glDeleteBuffers(1, &quadIndexBuffer);
+    if (indirectBuffer) glDeleteBuffers(1, &indirectBuffer);
+}
+
+void TerrainRenderer::setAtlas(const TextureAtlas &atlas){
+    uvs = std::make_shared<const BlockUVTable>(makeBlockUVs(atlas));
+}
+
+MeshJob TerrainRenderer::makeJob(int cx, int cz) const{
+    MeshJob job;
+    job.cx = cx;
+    job.cz = cz;
+    job.version = sections[cx][cz].version;
+    job.uvs = uvs;
+
+    std::shared_lock<std::shared_mutex> lock(worldMutex);
+    const int P = MeshJob::PAD;
+    const int x0 = cx * SECTION - 1, z0 = cz * SECTION - 1;
+    job.height = WATER_LEVEL;
+    for (int pz = 0; pz < P; ++pz)
+        for (int px = 0; px < P; ++px)
+            job.height = std::max(job.height, getHeightAt(x0 + px, z0 + pz));
+
+    job.cells.assign(static_cast<size_t>(job.height) * P * P, BLOCK_AIR);
+    for (int pz = 0; pz < P; ++pz){
+        for (int px = 0; px < P; ++px){
+            int h = getHeightAt(x0 + px, z0 + pz);
+            // outside the map getHeightAt is 0; leave that open rather than flooded
+            const bool inside = x0 + px >= 0 && x0 + px < CHUNK && z0 + pz >= 0 && z0 + pz < CHUNK;
+            for (int yi = 0; yi < h; ++yi)
+                job.cells[(static_cast<size_t>(yi) * P + pz) * P + px] = terrainBlockAt(yi, h);
+            for (int yi = h; inside && yi < WATER_LEVEL; ++yi)
+                job.cells[(static_cast<size_t>(yi) * P + pz) * P + px] = BLOCK_WATER;
+        }
+    }
+    return job;
+}
+
+void TerrainRenderer::markSectionDirty(int cx, int cz){
+    if (cx < 0 || cx >= SECTIONS || cz < 0 || cz >= SECTIONS || !uvs) return;
+    ++sections[cx][cz].version;
+    workers.submit(makeJob(cx, cz));
+    ++stats_.inFlight;
+}
+
+void TerrainRenderer::markAllDirty(){
+    for (int cx = 0; cx < SECTIONS; ++cx)
+        for (int cz = 0; cz < SECTIONS; ++cz)
+            markSectionDirty(cx, cz);
+}
+
+void TerrainRenderer::update(const MeshUploadBudget &budget){
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+
+    std::unique_ptr<MeshResult> r;
+    while (workers.pollResult(r)){
+        --stats_.inFlight;
+        if (r->version != sections[r->cx][r->cz].version){ ++stats_.droppedStale; continue; }
+        pending.push_back(std::move(r));
+    }
+
+    stats_.uploadedThisFrame = 0;
+    stats_.uploadedBytesThisFrame = 0;
+    size_t i = 0;
+    for (; i < pending.size(); ++i){
+        if (stats_.uploadedThisFrame > 0){
+            double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+            if (ms >= budget.maxMillis) break;
+            if (stats_.uploadedBytesThisFrame + pending[i]->mesh.byteSize() > budget.maxBytes) break;
+        }
+        MeshResult &res = *pending[i];
+        Section &s = sections[res.cx][res.cz];
+        if (res.version != s.version){ ++stats_.droppedStale; continue; }
+
+        stats_.quads -= s.quads;
+        stats_.translucentQuads -= s.blendQuads;
+        upload(s, res.mesh);
+        uploadTranslucent(s, res.mesh, res.translucentCentres);
+        s.height = res.height;
+        stats_.quads += s.quads;
+        stats_.translucentQuads += s.blendQuads;
+        ++stats_.uploadedThisFrame;
+        stats_.uploadedBytesThisFrame += res.mesh.byteSize();
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(i));
+    stats_.pendingUploads = pending.size();
+    pool.setLiveQuads(stats_.quads);
+}
+
+// Quad q uses vertices 4q..4q+3; the groups are stored back to back, so a
+// group's first quad is also its offset into the index buffer.
+void TerrainRenderer::reserveQuadIndices(size_t quads){
+    if (quads <= quadIndexCapacity && quadIndexBuffer) return;
+    size_t cap = std::max<size_t>(4096, quadIndexCapacity);
+    while (cap < quads) cap *= 2;
+    std::vector<uint32_t> idx(cap * 6);
+    for (size_t q = 0; q < cap; ++q){
+        const uint32_t v = static_cast<uint32_t>(q * 4);
+        uint32_t *i = &idx[q * 6];
+        i[0] = v; i[1] = v + 1; i[2] = v + 2;
+        i[3] = v; i[4] = v + 2; i[5] = v + 3;
+    }
+    if (!quadIndexBuffer) glGenBuffers(1, &quadIndexBuffer);
+    // VAOs reference the buffer object, so respecifying its storage updates all of them
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(idx.size() * sizeof(uint32_t)), idx.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    quadIndexCapacity = cap;
+}
+
+void TerrainRenderer::upload(Section &s, const MeshBuffers &mesh){
+    const size_t quads = mesh.quadCount();
+    reserveQuadIndices(quads);
+    if (!pool.vertexArray()){
+        indirect = indirectAllowed && hasMultiDrawIndirect();
+        pool.init(INITIAL_POOL_QUADS, quadIndexBuffer, indirect);
+        if (indirect) glGenBuffers(1, &indirectBuffer);
+    }
+    // keep the section's block while the mesh fits and still fills half of it
+    if (quads > s.granted || quads == 0 || (quads * 2 < s.granted && s.granted > VertexPool::POOL_GRANULE)){
+        if (s.granted) pool.release(s.first, s.granted);
+        s.granted = 0;
+        if (quads) s.first = pool.allocate(quads, s.granted);
+    }
+    size_t at = s.first;
+    for (int g = 0; g < GROUP_COUNT; ++g){
+        const auto &v = mesh.groups[g];
+        pool.write(at, v.data(), v.size());
+        s.groupQuads[g] = v.size() / (4 * MESH_VERTEX_FLOATS);
+        at += s.groupQuads[g];
+    }
+    s.quads = quads;
+}
+
+void TerrainRenderer::draw(const RenderPipeline &pipeline, const TextureAtlas &atlas, const Frustum &frustum){
+    stats_.sectionsDrawn = 0;
+    stats_.sectionsCulled = 0;
+    stats_.drawCalls = 0;
+    stats_.drawCommands = 0;
+    stats_.trianglesDrawn = 0;
+    if (!pool.vertexArray()) return; // nothing uploaded yet
+
+    // Cull, then build the command list: one command per visible section, or
+    // with separate textures one per section and face group, grouped by
+    // texture. baseInstance indexes the section's offset.
+    const bool oneTexture = atlas.atlasLoaded;
+    const int passes = oneTexture ? 1 : GROUP_COUNT;
+    size_t passStart[GROUP_COUNT + 1] = {};
+    commands.clear();
+    drawOffsets.clear();
+    for (int g = 0; g < passes; ++g){
+        passStart[g] = commands.size();
+        for (int cx = 0; cx < SECTIONS; ++cx){
+            for (int cz = 0; cz < SECTIONS; ++cz){
+                const Section &s = sections[cx][cz];
+                if (s.quads == 0) continue;
+                const float ox = sectionOriginX(cx), oz = sectionOriginZ(cz);
+                // block centres sit on integer X/Z, so faces reach half a block either side
+                if (!frustum.intersectsAABB({ox - 0.5f, 0.f, oz - 0.5f},
+                                            {ox + SECTION - 0.5f, static_cast<float>(s.height), oz + SECTION - 0.5f})){
+                    if (g == 0) ++stats_.sectionsCulled;
+                    continue;
+                }
+                if (g == 0) ++stats_.sectionsDrawn;
+                size_t first = 0, count = s.quads;
+                if (!oneTexture){
+                    for (int k = 0; k < g; ++k) first += s.groupQuads[k];
+                    count = s.groupQuads[g];
+                }
+                if (count == 0) continue;
+                DrawElementsIndirectCommand c;
+                c.count = static_cast<uint32_t>(count * 6);
+                c.instanceCount = 1;
+                c.firstIndex = static_cast<uint32_t>(first * 6);
+                c.baseVertex = static_cast<int32_t>(s.first * 4);
+                c.baseInstance = static_cast<uint32_t>(commands.size());
+                commands.push_back(c);
+                stats_.trianglesDrawn += c.count / 3;
+                drawOffsets.insert(drawOffsets.end(), {ox, 0.f, oz});
+            }
+        }
+    }
+    passStart[passes] = commands.size();
+    stats_.drawCommands = commands.size();
+    if (commands.empty()) return;
+
+    pipeline.beginTerrain();
+    glBindVertexArray(pool.vertexArray());
+    if (indirect){
+        glBindBuffer(GL_ARRAY_BUFFER, pool.offsetBuffer());
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(drawOffsets.size() * sizeof(float)), drawOffsets.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(commands.size() * sizeof(DrawElementsIndirectCommand)), commands.data(), GL_STREAM_DRAW);
+    }
+    for (int g = 0; g < passes; ++g){
+        const size_t begin = passStart[g], end = passStart[g + 1];
+        if (begin == end) continue;
+        if (oneTexture || g == GROUP_TOP) atlas.bindTop();
+        else if (g == GROUP_SIDE) atlas.bindSide();
+        else atlas.bindDirt();
+        if (indirect){
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                reinterpret_cast<const void*>(begin * sizeof(DrawElementsIndirectCommand)), static_cast<GLsizei>(end - begin), 0);
+            ++stats_.drawCalls;
+            continue;
+        }
+        for (size_t i = begin; i < end; ++i){
+            const DrawElementsIndirectCommand &c = commands[i];
+            glVertexAttrib3f(TERRAIN_OFFSET_ATTRIB, drawOffsets[i * 3], drawOffsets[i * 3 + 1], drawOffsets[i * 3 + 2]);
+            glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(c.count), GL_UNSIGNED_INT,
+                reinterpret_cast<const void*>(c.firstIndex * sizeof(uint32_t)), c.baseVertex);
+            ++stats_.drawCalls;
+        }
+    }
+    if (indirect) glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+    sf::Texture::bind(nullptr);
+}
+
+// Vertices stay as meshed; only the element buffer is rewritten when a sort
+// comes back. Until the first sort arrives the quads draw in mesher order.
+void TerrainRenderer::uploadTranslucent(Section &s, const MeshBuffers &mesh, std::shared_ptr<const std::vector<float>> centres){
+    ++s.blendVersion;
+    s.blendQuads = mesh.translucent.size() / (4 * MESH_VERTEX_FLOATS);
+    s.blendCentres = std::move(centres);
+    s.sortedFor = SortKey();
+    s.requestedFor = SortKey();
+    if (s.blendQuads == 0) return;
+    if (!s.blendVao){
+        glGenVertexArrays(1, &s.blendVao);
+        glGenBuffers(1, &s.blendVbo);
+        glGenBuffers(1, &s.blendEbo);
+        glBindVertexArray(s.blendVao);
+        glBindBuffer(GL_ARRAY_BUFFER, s.blendVbo);
+        const GLsizei stride = MESH_VERTEX_FLOATS * sizeof(float);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(3 * sizeof(float)));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s.blendEbo);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, s.blendVbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.translucent.size() * sizeof(float)), mesh.translucent.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // mesher order to start with; the shared quad index buffer already holds it
+    reserveQuadIndices(s.blendQuads);
+    const GLsizeiptr bytes = static_cast<GLsizeiptr>(s.blendQuads * 6 * sizeof(uint32_t));
+    glBindBuffer(GL_COPY_READ_BUFFER, quadIndexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, s.blendEbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_DYNAMIC_DRAW);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, bytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void TerrainRenderer::drawTranslucent(const RenderPipeline &pipeline, const TextureAtlas &atlas, const Frustum &frustum, const sf::Vector3f &eye){
+    stats_.translucentSectionsDrawn = 0;
+    stats_.translucentTrianglesDrawn = 0;
+    stats_.sortsRequested = 0;
+
+    // sorted orders that still match the section's mesh replace the old one
+    std::unique_ptr<SortResult> r;
+    while (sorter.pollResult(r)){
+        Section &s = sections[r->cx][r->cz];
+        if (r->version != s.blendVersion || s.blendQuads == 0) continue;
+        glBindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s.blendEbo);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(r->indices.size() * sizeof(uint32_t)), r->indices.data());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        s.sortedFor = r->key;
+    }
+
+    blendOrder.clear();
+    for (int cx = 0; cx < SECTIONS; ++cx){
+        for (int cz = 0; cz < SECTIONS; ++cz){
+            Section &s = sections[cx][cz];
+            if (s.blendQuads == 0) continue;
+            const float ox = sectionOriginX(cx), oz = sectionOriginZ(cz);
+            if (!frustum.intersectsAABB({ox - 0.5f, 0.f, oz - 0.5f},
+                                        {ox + SECTION - 0.5f, static_cast<float>(s.height), oz + SECTION - 0.5f})) continue;
+            const SortKey key = translucentSortKey(eye.x - ox, eye.y, eye.z - oz);
+            if (key != s.sortedFor && key != s.requestedFor){
+                SortJob job;
+                job.cx = cx;
+                job.cz = cz;
+                job.version = s.blendVersion;
+                job.key = key;
+                job.eyeX = eye.x - ox;
+                job.eyeY = eye.y;
+                job.eyeZ = eye.z - oz;
+                job.centres = s.blendCentres;
+                sorter.submit(std::move(job));
+                s.requestedFor = key;
+                ++stats_.sortsRequested;
+            }
+            const float dx = ox + SECTION * 0.5f - eye.x, dz = oz + SECTION * 0.5f - eye.z;
+            blendOrder.push_back({dx * dx + dz * dz, cx, cz});
+        }
+    }
+    if (blendOrder.empty()) return;
+    // whole sections back to front too; within each the element order does the rest
+    std::sort(blendOrder.begin(), blendOrder.end(), [](const BlendDraw &a, const BlendDraw &b){ return a.distance > b.distance; });
+
+    pipeline.beginTerrain();
+    atlas.bindTop();
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE); // test against the opaque world, but let translucent faces overlap
+    for (const BlendDraw &d : blendOrder){
+        const Section &s = sections[d.cx][d.cz];
+        glBindVertexArray(s.blendVao);
+        glVertexAttrib3f(TERRAIN_OFFSET_ATTRIB, sectionOriginX(d.cx), 0.f, sectionOriginZ(d.cz));
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(s.blendQuads * 6), GL_UNSIGNED_INT, nullptr);
+        ++stats_.translucentSectionsDrawn;
+        stats_.translucentTrianglesDrawn += s.blendQuads * 2;
+    }
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    glBindVertexArray(0);
+    sf::Texture::bind(nullptr);
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "chunk_mesher.h"
+#include "gl_functions.h"
+#include "render_pipeline.h"
+#include "translucent_sort.h"
+#include "vertex_pool.h"
+
+// How much finished meshing work the GL thread may upload in one frame.
+// At least one section is always uploaded so progress never stalls.
+struct MeshUploadBudget {
+    double maxMillis = 2.0;
+    size_t maxBytes = 1u << 20;
+};
+
+struct TerrainStats {
+    size_t uploadedThisFrame = 0;
+    size_t uploadedBytesThisFrame = 0;
+    size_t droppedStale = 0;     // results superseded by a newer edit, total
+    size_t pendingUploads = 0;   // finished meshes waiting for budget
+    size_t inFlight = 0;         // jobs submitted but not yet returned
+    size_t quads = 0;            // quads currently resident in vertex buffers
+    size_t sectionsDrawn = 0;    // non-empty sections drawn last frame
+    size_t sectionsCulled = 0;   // non-empty sections outside the view frustum
+    size_t drawCalls = 0;        // GL draw calls issued for those sections
+    size_t drawCommands = 0;     // indirect commands (or base-vertex draws) in them
+    size_t trianglesDrawn = 0;   // triangles those commands drew
+    size_t translucentQuads = 0; // quads resident in the translucent buffers
+    size_t translucentSectionsDrawn = 0;    // one glDrawElements each
+    size_t translucentTrianglesDrawn = 0;
+    size_t sortsRequested = 0;   // sections sent for re-sorting last frame
+};
+
+// Layout glMultiDrawElementsIndirect reads from the indirect buffer
+struct DrawElementsIndirectCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+// Owns the shared terrain vertex pool and the mesh worker pool. Sections carry
+// an edit version; results meshed from an older version are discarded
+// unuploaded. Every section's quads live in one VertexPool and share one index
+// buffer of quads split into two triangles, so after culling the visible
+// sections are drawn by a single glMultiDrawElementsIndirect per texture (one
+// with an atlas) from a command list rebuilt each frame. Contexts older than
+// GL 4.3 get the same commands as one glDrawElementsBaseVertex each.
+class TerrainRenderer {
+public:
+    explicit TerrainRenderer(unsigned workerThreads = 0);
+    ~TerrainRenderer();
+    TerrainRenderer(const TerrainRenderer&) = delete;
+    TerrainRenderer& operator=(const TerrainRenderer&) = delete;
+
+    // Rebuilds the per-block UV table; call again if the atlas changes.
+    void setAtlas(const TextureAtlas &atlas);
+    void markSectionDirty(int cx, int cz);
+    void markAllDirty();
+    void update(const MeshUploadBudget &budget);
+    // With an atlas every face samples the same texture, so each section is one command.
+    // Sections whose bounds are outside the frustum are skipped.
+    void draw(const RenderPipeline &pipeline, const TextureAtlas &atlas, const Frustum &frustum);
+    // Translucent faces (water, glass) after the opaque pass: sections back to
+    // front, each one's quads in the order the sorter thread last produced for
+    // the camera's cell (see translucent_sort.h). Blended, no depth writes.
+    void drawTranslucent(const RenderPipeline &pipeline, const TextureAtlas &atlas, const Frustum &frustum, const sf::Vector3f &eye);
+    // false draws one section at a time even where multi-draw indirect is
+    // available; takes effect only before the first upload
+    void allowIndirect(bool allow) { indirectAllowed = allow; }
+    bool usesIndirect() const { return indirect; }
+
+    const TerrainStats& stats() const { return stats_; }
+    VertexPoolStats poolStats() const { return pool.stats(); }
+    unsigned workerCount() const { return workers.threadCount(); }
+    // true once every submitted section has been meshed and uploaded
+    bool idle() const { return stats_.inFlight == 0 && pending.empty(); }
+
+private:
+    struct Section {
+        uint32_t version = 0;
+        size_t first = 0, granted = 0;  // block in the vertex pool, in quads
+        size_t quads = 0;
+        int height = 0;
+        size_t groupQuads[GROUP_COUNT] = {};
+        // translucent quads: their own buffers, element order rewritten by sorts
+        GLuint blendVao = 0, blendVbo = 0, blendEbo = 0;
+        size_t blendQuads = 0;
+        uint32_t blendVersion = 0;
+        std::shared_ptr<const std::vector<float>> blendCentres;
+        SortKey sortedFor, requestedFor;
+    };
+    struct BlendDraw { float distance; int cx, cz; };
+    MeshJob makeJob(int cx, int cz) const;
+    void upload(Section &s, const MeshBuffers &mesh);
+    void uploadTranslucent(Section &s, const MeshBuffers &mesh, std::shared_ptr<const std::vector<float>> centres);
+    void reserveQuadIndices(size_t quads);
+
+    Section sections[SECTIONS][SECTIONS];
+    VertexPool pool;
+    bool indirectAllowed = true, indirect = false;
+    GLuint quadIndexBuffer = 0;
+    size_t quadIndexCapacity = 0;  // quads the shared index buffer covers
+    GLuint indirectBuffer = 0;
+    // rebuilt every frame, kept to reuse their storage
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<float> drawOffsets; // x, y, z per command
+    std::vector<BlendDraw> blendOrder;
+    std::shared_ptr<const BlockUVTable> uvs;
+    std::vector<std::unique_ptr<MeshResult>> pending;
+    TerrainStats stats_;
+    MeshWorkers workers;
+    QuadSorter sorter;
+};
@@ -1,4 +1,6 @@
 #include "texture_atlas.h"
+#include "asset_bundle.h"
+#include <algorithm>
 #include <iostream>
 
 bool TextureAtlas::loadAtlas(const std::string &path){
@@ -7,22 +9,92 @@ bool TextureAtlas::loadAtlas(const std::string &path){
         atlasLoaded = true;
         atlasTex.setSmooth(false);
         atlasTex.setRepeated(false);
-        // detect tile size
-        std::vector<int> candidates = {16,32,64,8};
-        for (int c : candidates){
-            if (atlasTex.getSize().x % c == 0 && atlasTex.getSize().y % c == 0){
-                atlasTileSize = c;
-                atlasCols = atlasTex.getSize().x / atlasTileSize;
-                atlasRows = atlasTex.getSize().y / atlasTileSize;
-                break;
-            }
-        }
-        if (atlasTileSize == 0){ atlasCols = 1; atlasRows = 6; atlasTileSize = atlasTex.getSize().x / atlasCols; }
+        setGrid(atlasTex.getSize());
         return true;
     }
     return false;
 }
 
+bool TextureAtlas::loadFromBundle(const AssetBundle &bundle){
+    atlasLoaded = false;
+    const BundleEntry *e = bundle.find("atlas");
+    if (!e || e->kind != BUNDLE_RGBA8 || e->tileSize <= 0) return false;
+    if (!atlasTex.resize(sf::Vector2u{e->width, e->height})) return false;
+    atlasTex.update(bundle.data(*e));
+    atlasTex.setSmooth(false);
+    atlasTex.setRepeated(false);
+    atlasTileSize = e->tileSize;
+    atlasCols = e->cols;
+    atlasRows = e->rows;
+    TOP_TILE = {e->tiles[0], e->tiles[1]};
+    SIDE_TILE = {e->tiles[2], e->tiles[3]};
+    DIRT_TILE = {e->tiles[4], e->tiles[5]};
+    atlasLoaded = true;
+    return true;
+}
+
+void TextureAtlas::setGrid(sf::Vector2u size){
+    atlasTileSize = 0;
+    // detect tile size
+    std::vector<int> candidates = {16,32,64,8};
+    for (int c : candidates){
+        if (size.x % c == 0 && size.y % c == 0){
+            atlasTileSize = c;
+            atlasCols = size.x / atlasTileSize;
+            atlasRows = size.y / atlasTileSize;
+            break;
+        }
+    }
+    if (atlasTileSize == 0){ atlasCols = 1; atlasRows = 6; atlasTileSize = size.x / atlasCols; }
+}
+
+void TextureAtlas::detectTiles(const sf::Image &img){
+    struct Scores { float green=0.f; float brown=0.f; float topGreenFrac=0.f; float bottomBrownFrac=0.f; };
+    std::vector<Scores> scores(atlasCols * atlasRows);
+    for(int ty=0; ty<atlasRows; ++ty){
+        for(int tx=0; tx<atlasCols; ++tx){
+            Scores s;
+            int baseX = tx * atlasTileSize;
+            int baseY = ty * atlasTileSize;
+            int total = atlasTileSize * atlasTileSize;
+            int topCount=0, topGreen=0;
+            int bottomCount=0, bottomBrown=0;
+            for(int y=0;y<atlasTileSize;++y){
+                for(int x=0;x<atlasTileSize;++x){
+                    auto c = img.getPixel(sf::Vector2u{static_cast<unsigned>(baseX + x), static_cast<unsigned>(baseY + y)});
+                    float r = static_cast<float>(c.r);
+                    float g = static_cast<float>(c.g);
+                    float b = static_cast<float>(c.b);
+                    s.green += std::max(0.f, g - (r + b) * 0.5f);
+                    s.brown += std::max(0.f, r - (g + b) * 0.5f);
+                    if (y < atlasTileSize/4){ ++topCount; if (g > r + 8 && g > b + 8) ++topGreen; }
+                    if (y >= atlasTileSize/2){ ++bottomCount; if (r > g + 6 && r > b) ++bottomBrown; }
+                }
+            }
+            s.topGreenFrac = topCount ? (float)topGreen / (float)topCount : 0.f;
+            s.bottomBrownFrac = bottomCount ? (float)bottomBrown / (float)bottomCount : 0.f;
+            s.green /= static_cast<float>(total);
+            s.brown /= static_cast<float>(total);
+            scores[ty * atlasCols + tx] = s;
+        }
+    }
+
+    float bestTopScore = -1.f;
+    float bestDirtScore = -1.f;
+    float bestSideScore = -1.f;
+    for(int ty=0; ty<atlasRows; ++ty){
+        for(int tx=0; tx<atlasCols; ++tx){
+            auto &s = scores[ty*atlasCols + tx];
+            float topScore = s.green * (0.7f + 0.6f * s.topGreenFrac);
+            float dirtScore = s.brown;
+            float sideScore = s.topGreenFrac * (0.5f + s.bottomBrownFrac);
+            if (topScore > bestTopScore){ bestTopScore = topScore; TOP_TILE = {tx,ty}; }
+            if (dirtScore > bestDirtScore){ bestDirtScore = dirtScore; DIRT_TILE = {tx,ty}; }
+            if (sideScore > bestSideScore){ bestSideScore = sideScore; SIDE_TILE = {tx,ty}; }
+        }
+    }
+}
+
 bool TextureAtlas::loadFallbacks(const std::string& assetsDir){
     std::string d = assetsDir;
     if (d.back() != '/' && d.back() != '\\') d += "/";
@@ -4,6 +4,8 @@
 #include <array>
 #include <string>
 
+class AssetBundle;
+
 struct TextureAtlas {
     bool atlasLoaded = false;
     sf::Texture atlasTex;
@@ -15,6 +17,13 @@ struct TextureAtlas {
     sf::Vector2i DIRT_TILE{2,0};
 
     bool loadAtlas(const std::string &path);
+    // Atlas texture and tile metadata from a bundle entry named "atlas",
+    // uploaded straight from the mapped file
+    bool loadFromBundle(const AssetBundle &bundle);
+    // Tile grid for an atlas image of this size
+    void setGrid(sf::Vector2u size);
+    // Picks the grass top, grass side and dirt tiles by colour
+    void detectTiles(const sf::Image &img);
     bool loadFallbacks(const std::string& assetsDir = "assets/");
     std::array<float,4> getUV_fromAtlasTile(const sf::Vector2i &tile) const;
     void bindTop() const;
@@ -0,0 +1,145 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> traceRecording{false};
+
+static const size_t TRACE_EVENTS_PER_THREAD = 1u << 15;
+
+struct TraceEvent {
+    const char *name;
+    int64_t begin, end;
+};
+
+// Written only by its thread; read by the capture once recording is off.
+// `count` is published with release after each event, so the reader sees
+// every event below the count it loads.
+struct ThreadTrace {
+    uint32_t tid = 0;
+    std::string name;                    // guarded by registryMutex
+    std::atomic<uint32_t> generation{0}; // capture the events belong to
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> dropped{0};
+    std::vector<TraceEvent> events;      // allocated by the first zone it records
+};
+
+// Buffers outlive their threads, so a worker that exits mid-capture still shows up
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<ThreadTrace>> registry;
+static std::atomic<uint32_t> traceGeneration{0};
+static thread_local ThreadTrace *threadTrace = nullptr;
+static const auto traceEpoch = std::chrono::steady_clock::now();
+
+int64_t traceNowNanos(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+static ThreadTrace& currentThread(){
+    if (!threadTrace){
+        auto t = std::make_unique<ThreadTrace>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        t->tid = static_cast<uint32_t>(registry.size() + 1);
+        t->name = "thread " + std::to_string(t->tid);
+        threadTrace = t.get();
+        registry.push_back(std::move(t));
+    }
+    return *threadTrace;
+}
+
+void traceSetThreadName(const char *name){
+    ThreadTrace &t = currentThread();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    t.name = name;
+}
+
+void traceRecordZone(const char *name, int64_t beginNanos, int64_t endNanos){
+    ThreadTrace &t = currentThread();
+    const uint32_t gen = traceGeneration.load(std::memory_order_acquire);
+    if (t.generation.load(std::memory_order_relaxed) != gen){
+        // first zone of a new capture on this thread: the owner clears its own buffer
+        if (t.events.empty()) t.events.resize(TRACE_EVENTS_PER_THREAD);
+        t.count.store(0, std::memory_order_relaxed);
+        t.dropped.store(0, std::memory_order_relaxed);
+        t.generation.store(gen, std::memory_order_release);
+    }
+    const size_t n = t.count.load(std::memory_order_relaxed);
+    if (n == t.events.size()){
+        t.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    t.events[n] = {name, beginNanos, endNanos};
+    t.count.store(n + 1, std::memory_order_release);
+}
+
+// JSON string body; zone and thread names are ours, but keep the file valid anyway
+static std::string jsonEscape(const std::string &s){
+    std::string out;
+    for (char c : s){
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) out += c;
+    }
+    return out;
+}
+
+void TraceCapture::start(const std::string &file, int frames){
+    path = file;
+    framesLeft = frames;
+    recording = true;
+    traceGeneration.fetch_add(1, std::memory_order_release);
+    traceRecording.store(true, std::memory_order_relaxed);
+    if (frames > 0) std::printf("[trace] capturing %d frames to %s\n", frames, path.c_str());
+    else std::printf("[trace] capturing to %s\n", path.c_str());
+}
+
+bool TraceCapture::frameEnd(){
+    if (!recording || framesLeft <= 0 || --framesLeft > 0) return false;
+    finish();
+    return true;
+}
+
+bool TraceCapture::finish(){
+    if (!recording) return true;
+    recording = false;
+    traceRecording.store(false, std::memory_order_relaxed);
+    const uint32_t gen = traceGeneration.load(std::memory_order_relaxed);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    char line[256];
+    bool first = true;
+    size_t zones = 0, dropped = 0, threads = 0;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto &t : registry){
+        // tracks sorted by registration, which puts the main thread first
+        std::snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+            first ? "" : ",\n", t->tid);
+        out << line << jsonEscape(t->name) << "\"}}";
+        std::snprintf(line, sizeof(line), ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}", t->tid, t->tid);
+        out << line;
+        first = false;
+        if (t->generation.load(std::memory_order_acquire) != gen) continue;
+        const size_t n = t->count.load(std::memory_order_acquire);
+        if (n) ++threads;
+        for (size_t i = 0; i < n; ++i){
+            const TraceEvent &e = t->events[i];
+            std::snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"cube\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                e.name, t->tid, static_cast<double>(e.begin) / 1000.0, static_cast<double>(e.end - e.begin) / 1000.0);
+            out << line;
+        }
+        zones += n;
+        dropped += t->dropped.load(std::memory_order_relaxed);
+    }
+    out << "\n]}\n";
+    if (!out){
+        std::fprintf(stderr, "[trace] could not write %s\n", path.c_str());
+        return false;
+    }
+    std::printf("[trace] %zu zones from %zu threads written to %s", zones, threads, path.c_str());
+    if (dropped) std::printf(" (%zu dropped: a thread's buffer filled up)", dropped);
+    std::printf("\n");
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Scoped trace zones, collected per thread and written out as Chrome
+// trace-event JSON (chrome://tracing, ui.perfetto.dev), one track per thread.
+//
+//   TRACE_ZONE("mesh section");   // times the rest of the enclosing scope
+//
+// While no capture runs a zone costs one relaxed atomic load. During a
+// capture each thread appends finished zones to its own fixed-size buffer
+// without locking; the buffer is registered (under a mutex) the first time
+// the thread records anything. Zone names must be string literals: only the
+// pointer is kept.
+
+extern std::atomic<bool> traceRecording;
+
+int64_t traceNowNanos();
+void traceRecordZone(const char *name, int64_t beginNanos, int64_t endNanos);
+// Names the calling thread's track; call once when the thread starts
+void traceSetThreadName(const char *name);
+
+class TraceZone {
+public:
+    explicit TraceZone(const char *name)
+        : name(name), begin(traceRecording.load(std::memory_order_relaxed) ? traceNowNanos() : -1) {}
+    ~TraceZone(){ end(); }
+    // Closes the zone before its scope does
+    void end(){
+        if (begin >= 0) traceRecordZone(name, begin, traceNowNanos());
+        begin = -1;
+    }
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char *name;
+    int64_t begin;
+};
+
+#define TRACE_ZONE_JOIN2(a, b) a##b
+#define TRACE_ZONE_JOIN(a, b) TRACE_ZONE_JOIN2(a, b)
+#define TRACE_ZONE(name) TraceZone TRACE_ZONE_JOIN(traceZone_, __LINE__)(name)
+
+// Runs one capture at a time from the thread that owns it (cube's main
+// thread). start() clears every thread's buffer and turns recording on;
+// frameEnd() counts frames and, after the requested number, turns recording
+// off and writes the file. frames = 0 records until finish().
+class TraceCapture {
+public:
+    void start(const std::string &path, int frames);
+    bool active() const { return recording; }
+    // true when this frame completed the capture (the file has been written)
+    bool frameEnd();
+    // Stops recording and writes the file; false if it could not be written
+    bool finish();
+
+private:
+    std::string path;
+    int framesLeft = 0;
+    bool recording = false;
+};
@@ -0,0 +1,96 @@
+#include "translucent_sort.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+SortKey translucentSortKey(float lx, float ly, float lz){
+    // blocks are centred on integer X/Z and start at integer Y
+    SortKey k;
+    k.x = static_cast<int>(std::floor(lx + 0.5f));
+    k.y = static_cast<int>(std::floor(ly));
+    k.z = static_cast<int>(std::floor(lz + 0.5f));
+    return k;
+}
+
+std::vector<float> quadCentres(const std::vector<float> &vertices, int vertexFloats){
+    const size_t quads = vertices.size() / (4 * static_cast<size_t>(vertexFloats));
+    std::vector<float> centres(quads * 3);
+    for (size_t q = 0; q < quads; ++q){
+        const float *v = &vertices[q * 4 * vertexFloats];
+        for (int a = 0; a < 3; ++a)
+            centres[q * 3 + a] = (v[a] + v[vertexFloats + a] + v[2 * vertexFloats + a] + v[3 * vertexFloats + a]) * 0.25f;
+    }
+    return centres;
+}
+
+void sortQuadsBackToFront(const std::vector<float> &centres, float ex, float ey, float ez, std::vector<uint32_t> &indices){
+    const size_t quads = centres.size() / 3;
+    std::vector<float> dist(quads);
+    std::vector<uint32_t> order(quads);
+    for (size_t q = 0; q < quads; ++q){
+        const float dx = centres[q * 3] - ex, dy = centres[q * 3 + 1] - ey, dz = centres[q * 3 + 2] - ez;
+        dist[q] = dx * dx + dy * dy + dz * dz;
+    }
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){ return dist[a] > dist[b]; });
+    indices.resize(quads * 6);
+    for (size_t i = 0; i < quads; ++i){
+        const uint32_t v = order[i] * 4;
+        uint32_t *o = &indices[i * 6];
+        o[0] = v; o[1] = v + 1; o[2] = v + 2;
+        o[3] = v; o[4] = v + 2; o[5] = v + 3;
+    }
+}
+
+QuadSorter::QuadSorter() : thread([this]{ run(); }) {}
+
+QuadSorter::~QuadSorter(){
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobCv.notify_all();
+    thread.join();
+}
+
+void QuadSorter::submit(SortJob job){
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        auto same = std::find_if(jobs.begin(), jobs.end(), [&](const SortJob &j){ return j.cx == job.cx && j.cz == job.cz; });
+        if (same != jobs.end()) *same = std::move(job);
+        else jobs.push_back(std::move(job));
+    }
+    jobCv.notify_one();
+}
+
+void QuadSorter::run(){
+    traceSetThreadName("translucent sort");
+    for (;;){
+        SortJob job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobCv.wait(lock, [this]{ return stopping || !jobs.empty(); });
+            if (stopping) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        auto result = std::make_unique<SortResult>();
+        result->cx = job.cx;
+        result->cz = job.cz;
+        result->version = job.version;
+        result->key = job.key;
+        {
+            TRACE_ZONE("sort quads");
+            sortQuadsBackToFront(*job.centres, job.eyeX, job.eyeY, job.eyeZ, result->indices);
+        }
+        // the GL thread drains every frame, so a full queue only means a short wait
+        while (!completed.tryPush(result)){
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                if (stopping) return;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
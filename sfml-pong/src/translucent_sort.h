@@ -0,0 +1,70 @@
+#pragma once
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "lockfree_queue.h"
+
+// Back-to-front ordering of a section's translucent quads, by the distance
+// from each quad's centre to the eye. The sort uses the eye position at the
+// time it was requested and is redone only when the camera moves into another
+// block cell, so the order can lag the camera by up to one cell.
+struct SortKey {
+    int x = INT_MIN, y = 0, z = 0;  // camera cell relative to the section
+    bool operator==(const SortKey &o) const { return x == o.x && y == o.y && z == o.z; }
+    bool operator!=(const SortKey &o) const { return !(*this == o); }
+};
+
+// Cell of a camera at (lx, ly, lz) relative to the section origin
+SortKey translucentSortKey(float lx, float ly, float lz);
+
+// Centre of every quad in a vertex list (4 vertices of `vertexFloats` floats
+// per quad, position first), 3 floats each
+std::vector<float> quadCentres(const std::vector<float> &vertices, int vertexFloats);
+
+// Element indices (two triangles per quad, vertex 4q..4q+3) with the quad
+// farthest from the eye at (ex, ey, ez), section-relative, first
+void sortQuadsBackToFront(const std::vector<float> &centres, float ex, float ey, float ez, std::vector<uint32_t> &indices);
+
+struct SortJob {
+    int cx = 0, cz = 0;
+    uint32_t version = 0;   // the section's translucent mesh the centres belong to
+    SortKey key;
+    float eyeX = 0.f, eyeY = 0.f, eyeZ = 0.f;  // relative to the section origin
+    std::shared_ptr<const std::vector<float>> centres;
+};
+
+struct SortResult {
+    int cx = 0, cz = 0;
+    uint32_t version = 0;
+    SortKey key;
+    std::vector<uint32_t> indices;
+};
+
+// One worker thread that sorts off the GL thread. A newer job for a section
+// replaces one still queued; results come back through a lock-free queue the
+// GL thread drains each frame.
+class QuadSorter {
+public:
+    QuadSorter();
+    ~QuadSorter();
+    QuadSorter(const QuadSorter&) = delete;
+    QuadSorter& operator=(const QuadSorter&) = delete;
+
+    void submit(SortJob job);
+    bool pollResult(std::unique_ptr<SortResult> &out) { return completed.tryPop(out); }
+
+private:
+    void run();
+
+    std::thread thread;
+    std::mutex jobMutex;
+    std::condition_variable jobCv;
+    std::deque<SortJob> jobs;
+    bool stopping = false;
+    LockFreeQueue<std::unique_ptr<SortResult>> completed{64};
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Single-writer / single-reader triple buffer. The writer fills writeBuffer()
+// and publish()es it; the reader always sees the newest complete value from
+// read(). Neither side ever blocks or waits on the other.
+template <typename T>
+class TripleBuffer {
+public:
+    explicit TripleBuffer(const T &initial = T()) : buffers{initial, initial, initial} {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    T& writeBuffer() { return buffers[back]; }
+
+    void publish(){
+        uint8_t prev = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel);
+        back = prev & INDEX;
+    }
+
+    const T& read(){
+        if (middle.load(std::memory_order_relaxed) & FRESH){
+            uint8_t prev = middle.exchange(front, std::memory_order_acq_rel);
+            front = prev & INDEX;
+        }
+        return buffers[front];
+    }
+
+private:
+    static const uint8_t INDEX = 3;
+    static const uint8_t FRESH = 4;
+
+    T buffers[3];
+    uint8_t back = 0;                    // writer-owned
+    uint8_t front = 2;                   // reader-owned
+    std::atomic<uint8_t> middle{1};      // shared: index plus FRESH bit
+};
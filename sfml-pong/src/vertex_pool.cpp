@@ -0,0 +1,146 @@
+#include "vertex_pool.h"
+#include "render_pipeline.h"
+#include "rendering.h"
+#include <algorithm>
+#include <iostream>
+
+static const size_t QUAD_BYTES = 4 * MESH_VERTEX_FLOATS * sizeof(float);
+
+void RangeAllocator::reset(size_t capacity){
+    ranges.clear();
+    cap = capacity;
+    inUse = 0;
+    if (capacity) ranges[0] = capacity;
+}
+
+void RangeAllocator::grow(size_t newCapacity){
+    if (newCapacity <= cap) return;
+    // the new space counts as allocated until released, which merges it
+    // with a free range at the old end
+    const size_t oldCap = cap;
+    inUse += newCapacity - cap;
+    cap = newCapacity;
+    release(oldCap, newCapacity - oldCap);
+}
+
+size_t RangeAllocator::allocate(size_t size){
+    for (auto it = ranges.begin(); it != ranges.end(); ++it){
+        if (it->second < size) continue;
+        const size_t start = it->first, left = it->second - size;
+        ranges.erase(it);
+        if (left) ranges[start + size] = left;
+        inUse += size;
+        return start;
+    }
+    return NONE;
+}
+
+void RangeAllocator::release(size_t start, size_t size){
+    if (size == 0) return;
+    inUse -= size;
+    auto next = ranges.lower_bound(start);
+    // merge with the range that ends where this one starts
+    if (next != ranges.begin()){
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == start){
+            start = prev->first;
+            size += prev->second;
+            ranges.erase(prev);
+        }
+    }
+    // and with the one that starts where it ends
+    if (next != ranges.end() && start + size == next->first){
+        size += next->second;
+        ranges.erase(next);
+    }
+    ranges[start] = size;
+}
+
+size_t RangeAllocator::largestFree() const{
+    size_t best = 0;
+    for (const auto &r : ranges) best = std::max(best, r.second);
+    return best;
+}
+
+VertexPool::~VertexPool(){
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (vbo) glDeleteBuffers(1, &vbo);
+    if (offsetVbo) glDeleteBuffers(1, &offsetVbo);
+}
+
+void VertexPool::init(size_t quads, GLuint indexBuffer, bool instancedOffsets){
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &offsetVbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, offsetVbo);
+    glVertexAttribPointer(TERRAIN_OFFSET_ATTRIB, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+    glVertexAttribDivisor(TERRAIN_OFFSET_ATTRIB, 1);
+    if (instancedOffsets) glEnableVertexAttribArray(TERRAIN_OFFSET_ATTRIB);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    ranges.reset(0);
+    resizeBuffer(quads);
+    ranges.grow(quads);
+}
+
+void VertexPool::resizeBuffer(size_t quads){
+    GLuint next = 0;
+    glGenBuffers(1, &next);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, next);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(quads * QUAD_BYTES), nullptr, GL_STATIC_DRAW);
+    if (vbo){
+        glBindBuffer(GL_COPY_READ_BUFFER, vbo);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(ranges.capacity() * QUAD_BYTES));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &vbo);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    vbo = next;
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    const GLsizei stride = MESH_VERTEX_FLOATS * sizeof(float);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(3 * sizeof(float)));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+size_t VertexPool::allocate(size_t quads, size_t &granted){
+    granted = (quads + POOL_GRANULE - 1) / POOL_GRANULE * POOL_GRANULE;
+    size_t first = ranges.allocate(granted);
+    if (first == RangeAllocator::NONE){
+        const size_t cap = std::max(ranges.capacity() * 2, ranges.capacity() + granted);
+        resizeBuffer(cap);
+        ranges.grow(cap);
+        ++grows;
+        std::cout << "[pool] vertex pool grown to " << cap << " quads (" << cap * QUAD_BYTES / 1024 << " KiB)\n";
+        first = ranges.allocate(granted);
+    }
+    return first;
+}
+
+void VertexPool::release(size_t first, size_t granted){
+    ranges.release(first, granted);
+}
+
+void VertexPool::write(size_t firstQuad, const float *data, size_t floats){
+    if (floats == 0) return;
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(firstQuad * QUAD_BYTES), static_cast<GLsizeiptr>(floats * sizeof(float)), data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+VertexPoolStats VertexPool::stats() const{
+    VertexPoolStats s;
+    s.capacityQuads = ranges.capacity();
+    s.allocatedQuads = ranges.used();
+    s.liveQuads = live;
+    s.freeRanges = ranges.freeRanges();
+    s.largestFreeQuads = ranges.largestFree();
+    s.grows = grows;
+    return s;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include "gl_functions.h"
+
+// First-fit allocator over [0, capacity) units. Free ranges are kept sorted by
+// start and merged with their neighbours when released.
+class RangeAllocator {
+public:
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    void reset(size_t capacity);
+    // Adds [capacity(), newCapacity) as free space
+    void grow(size_t newCapacity);
+    // Start of `size` units, or NONE if no free range is large enough
+    size_t allocate(size_t size);
+    void release(size_t start, size_t size);
+
+    size_t capacity() const { return cap; }
+    size_t used() const { return inUse; }
+    size_t freeRanges() const { return ranges.size(); }
+    size_t largestFree() const;
+
+private:
+    std::map<size_t, size_t> ranges; // start -> size
+    size_t cap = 0, inUse = 0;
+};
+
+// Sizes in quads (4 vertices each).
+struct VertexPoolStats {
+    size_t capacityQuads = 0;
+    size_t allocatedQuads = 0;  // handed out, including rounding slack
+    size_t liveQuads = 0;       // actually holding geometry
+    size_t freeRanges = 0;
+    size_t largestFreeQuads = 0;
+    size_t grows = 0;
+
+    double utilisation() const { return capacityQuads ? static_cast<double>(liveQuads) / static_cast<double>(capacityQuads) : 0.0; }
+    // Share of the free space outside the largest free range: 0 when it is
+    // all one block, near 1 when it is scattered in small holes
+    double fragmentation() const {
+        const size_t free = capacityQuads - allocatedQuads;
+        return free ? 1.0 - static_cast<double>(largestFreeQuads) / static_cast<double>(free) : 0.0;
+    }
+};
+
+// One GL vertex buffer that every terrain section's mesh lives in, carved up
+// by a RangeAllocator in whole quads. Allocations are rounded up to
+// POOL_GRANULE quads so a section that changes a little is re-meshed in place.
+// When nothing fits the buffer doubles: the old contents are copied on the GPU
+// and the vertex array is pointed at the new buffer. With instanced offsets
+// the vertex array also reads each draw's section offset from offsetBuffer()
+// (one per instance, picked by baseInstance); without them the attribute is
+// left disabled and set with glVertexAttrib3f before each draw.
+class VertexPool {
+public:
+    static const size_t POOL_GRANULE = 32;
+
+    VertexPool() = default;
+    ~VertexPool();
+    VertexPool(const VertexPool&) = delete;
+    VertexPool& operator=(const VertexPool&) = delete;
+
+    // Call with the context active; indexBuffer is bound into the vertex array
+    void init(size_t quads, GLuint indexBuffer, bool instancedOffsets);
+    // First quad of a block that holds at least `quads`; grows the buffer if needed
+    size_t allocate(size_t quads, size_t &granted);
+    void release(size_t first, size_t granted);
+    // Copies `floats` vertex floats to quad `firstQuad` onwards
+    void write(size_t firstQuad, const float *data, size_t floats);
+    void setLiveQuads(size_t quads) { live = quads; }
+
+    GLuint vertexArray() const { return vao; }
+    GLuint offsetBuffer() const { return offsetVbo; }
+    VertexPoolStats stats() const;
+
+private:
+    void resizeBuffer(size_t quads);
+
+    RangeAllocator ranges;
+    GLuint vao = 0, vbo = 0, offsetVbo = 0;
+    size_t live = 0, grows = 0;
+};
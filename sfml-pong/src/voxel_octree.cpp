@@ -0,0 +1,188 @@
+#include "voxel_octree.h"
+#include "voxel_world.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Child slot: bit 0 = upper x half, bit 1 = upper y half, bit 2 = upper z half.
+static int childSlot(int lx, int ly, int lz, int half){
+    return ((lx & half) ? 1 : 0) | ((ly & half) ? 2 : 0) | ((lz & half) ? 4 : 0);
+}
+
+VoxelOctree::VoxelOctree(sf::Vector3i origin, int size) : origin_(origin), nodes(1) {
+    while (size_ < size) size_ *= 2;
+}
+
+bool VoxelOctree::contains(int x, int y, int z) const{
+    return x >= origin_.x && y >= origin_.y && z >= origin_.z
+        && x - origin_.x < size_ && y - origin_.y < size_ && z - origin_.z < size_;
+}
+
+uint32_t VoxelOctree::allocGroup(){
+    if (!freeGroups.empty()){
+        uint32_t g = freeGroups.back();
+        freeGroups.pop_back();
+        return g;
+    }
+    const uint32_t g = static_cast<uint32_t>(nodes.size());
+    nodes.resize(nodes.size() + 8);
+    return g;
+}
+
+void VoxelOctree::freeGroup(uint32_t first){
+    freeGroups.push_back(first);
+}
+
+VoxelOctree::Node VoxelOctree::buildNode(VoxelWorld &world, int x, int y, int z, int size){
+    if (y >= CHUNK_HEIGHT || y + size <= 0) return Node{};
+    if (size <= CHUNK_SIZE && chunkOf(x, z) == chunkOf(x + size - 1, z + size - 1)){
+        // inside one chunk: uniform chunks are a single leaf at any size
+        const Chunk &c = world.chunk(chunkOf(x, z));
+        if (c.blocks.uniform() && y >= 0 && y + size <= CHUNK_HEIGHT) return Node::leaf(c.blocks.get(0));
+        if (size == 1) return Node::leaf(c.get(floorMod(x, CHUNK_SIZE), y, floorMod(z, CHUNK_SIZE)));
+    }
+    const int h = size / 2;
+    Node child[8];
+    for (int i = 0; i < 8; ++i)
+        child[i] = buildNode(world, x + ((i & 1) ? h : 0), y + ((i & 2) ? h : 0), z + ((i & 4) ? h : 0), h);
+    bool same = true;
+    for (int i = 0; i < 8 && same; ++i) same = child[i].isLeaf() && child[i].bits == child[0].bits;
+    if (same) return child[0];
+    const uint32_t g = allocGroup();
+    std::copy(child, child + 8, nodes.begin() + g);
+    return Node::branch(g);
+}
+
+void VoxelOctree::build(VoxelWorld &world){
+    nodes.assign(1, Node{});
+    freeGroups.clear();
+    const Node root = buildNode(world, origin_.x, origin_.y, origin_.z, size_);
+    nodes[0] = root;
+}
+
+BlockId VoxelOctree::get(int x, int y, int z) const{
+    if (!contains(x, y, z)) return BLOCK_AIR;
+    const int lx = x - origin_.x, ly = y - origin_.y, lz = z - origin_.z;
+    uint32_t n = 0;
+    for (int half = size_ / 2; !nodes[n].isLeaf(); half /= 2)
+        n = nodes[n].children() + childSlot(lx, ly, lz, half);
+    return nodes[n].id();
+}
+
+void VoxelOctree::set(int x, int y, int z, BlockId id){
+    if (!contains(x, y, z)) return;
+    const int lx = x - origin_.x, ly = y - origin_.y, lz = z - origin_.z;
+    uint32_t path[32];
+    int depth = 0;
+    uint32_t n = 0;
+    for (int half = size_ / 2; half > 0; half /= 2){
+        if (nodes[n].isLeaf()){
+            const Node leaf = nodes[n];
+            if (leaf.id() == id) return;
+            const uint32_t g = allocGroup(); // may reallocate nodes
+            for (int i = 0; i < 8; ++i) nodes[g + i] = leaf;
+            nodes[n] = Node::branch(g);
+        }
+        path[depth++] = n;
+        n = nodes[n].children() + childSlot(lx, ly, lz, half);
+    }
+    if (nodes[n].id() == id) return;
+    const Node leaf = Node::leaf(id);
+    nodes[n] = leaf;
+    // collapse parents whose children all became the same leaf
+    while (depth > 0){
+        const uint32_t p = path[--depth];
+        const uint32_t g = nodes[p].children();
+        for (int i = 0; i < 8; ++i)
+            if (nodes[g + i].bits != leaf.bits) return;
+        freeGroup(g);
+        nodes[p] = leaf;
+    }
+}
+
+bool VoxelOctree::raycast(const sf::Vector3f &from, const sf::Vector3f &dir, float maxDistance, RayHit &hit) const{
+    const float len = std::sqrt(dir.x*dir.x + dir.y*dir.y + dir.z*dir.z);
+    if (len == 0.f) return false;
+    const float o[3] = { from.x - origin_.x, from.y - origin_.y, from.z - origin_.z };
+    const float d[3] = { dir.x / len, dir.y / len, dir.z / len };
+    const float inf = std::numeric_limits<float>::infinity();
+
+    // clip to the root cube
+    float t = 0.f, tEnd = maxDistance;
+    int axis = -1;
+    for (int a = 0; a < 3; ++a){
+        if (d[a] == 0.f){
+            if (o[a] < 0.f || o[a] >= size_) return false;
+            continue;
+        }
+        float t0 = (0.f - o[a]) / d[a], t1 = (size_ - o[a]) / d[a];
+        if (t0 > t1) std::swap(t0, t1);
+        if (t0 > t){ t = t0; axis = a; }
+        tEnd = std::min(tEnd, t1);
+    }
+    if (t > tEnd) return false;
+
+    int cell[3];
+    for (int a = 0; a < 3; ++a)
+        cell[a] = std::clamp(static_cast<int>(std::floor(o[a] + d[a] * t)), 0, size_ - 1);
+    if (axis >= 0) cell[axis] = d[axis] > 0.f ? 0 : size_ - 1;
+
+    // path from the root to the current leaf; each step resumes from the
+    // deepest ancestor still containing the new cell instead of the root
+    struct Level { uint32_t node; int base[3]; int extent; };
+    Level path[32];
+    int depth = 0;
+    path[0] = Level{0, {0, 0, 0}, size_};
+    for (;;){
+        while (depth > 0){
+            const Level &l = path[depth];
+            bool inside = true;
+            for (int a = 0; a < 3; ++a) inside &= cell[a] >= l.base[a] && cell[a] < l.base[a] + l.extent;
+            if (inside) break;
+            --depth;
+        }
+        uint32_t n = path[depth].node;
+        while (!nodes[n].isLeaf()){
+            const Level &l = path[depth];
+            const int extent = l.extent / 2;
+            const int slot = childSlot(cell[0], cell[1], cell[2], extent);
+            n = nodes[n].children() + slot;
+            Level &c = path[++depth];
+            c.node = n;
+            c.extent = extent;
+            for (int a = 0; a < 3; ++a) c.base[a] = l.base[a] + ((slot & (1 << a)) ? extent : 0);
+        }
+        const int *base = path[depth].base;
+        const int extent = path[depth].extent;
+        if (nodes[n].id() != BLOCK_AIR){
+            hit.x = cell[0] + origin_.x;
+            hit.y = cell[1] + origin_.y;
+            hit.z = cell[2] + origin_.z;
+            hit.id = nodes[n].id();
+            hit.distance = t;
+            hit.normalAxis = axis;
+            return true;
+        }
+        // leave the whole leaf at once
+        float tExit = inf;
+        float tAxis[3];
+        for (int a = 0; a < 3; ++a){
+            tAxis[a] = inf;
+            if (d[a] > 0.f) tAxis[a] = (base[a] + extent - o[a]) / d[a];
+            else if (d[a] < 0.f) tAxis[a] = (base[a] - o[a]) / d[a];
+            tExit = std::min(tExit, tAxis[a]);
+        }
+        if (tExit > tEnd) return false;
+        for (int a = 0; a < 3; ++a){
+            if (tAxis[a] == tExit){
+                cell[a] = d[a] > 0.f ? base[a] + extent : base[a] - 1;
+                if (cell[a] < 0 || cell[a] >= size_) return false;
+                axis = a;
+            } else {
+                // stay within this leaf's slab so the walk never steps backwards
+                cell[a] = std::clamp(static_cast<int>(std::floor(o[a] + d[a] * tExit)), base[a], base[a] + extent - 1);
+            }
+        }
+        t = std::max(t, tExit);
+    }
+}
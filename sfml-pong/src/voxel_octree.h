@@ -0,0 +1,62 @@
+#pragma once
+#include <SFML/System.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "block_registry.h"
+
+class VoxelWorld;
+
+struct RayHit {
+    int x = 0, y = 0, z = 0;       // block that was hit
+    BlockId id = BLOCK_AIR;
+    float distance = 0.f;          // along the (normalised) ray to the entry point
+    int normalAxis = -1;           // axis of the face entered through (0 x, 1 y, 2 z), -1 if the ray started inside
+};
+
+// Sparse voxel octree over a cube of 2^k blocks whose low corner is `origin`.
+// A node is either a leaf holding one block id for its whole cube or points
+// at 8 children stored together; any subtree of one id collapses to a leaf,
+// so the empty sky and solid rock below the surface cost a handful of nodes.
+// set() splits and re-collapses along one root-to-leaf path. raycast() jumps
+// across whole leaves, so empty space is skipped a subtree at a time.
+class VoxelOctree {
+public:
+    // Covers [origin, origin + size) on every axis; size is rounded up to a power of two.
+    VoxelOctree(sf::Vector3i origin, int size);
+
+    // Rebuilds from the world (generating chunks as needed); blocks outside
+    // the world's height range are air.
+    void build(VoxelWorld &world);
+    BlockId get(int x, int y, int z) const;  // air outside the cube
+    void set(int x, int y, int z, BlockId id); // ignored outside the cube
+    bool contains(int x, int y, int z) const;
+
+    // First non-air block within maxDistance along dir (need not be normalised).
+    bool raycast(const sf::Vector3f &from, const sf::Vector3f &dir, float maxDistance, RayHit &hit) const;
+
+    sf::Vector3i origin() const { return origin_; }
+    int size() const { return size_; }
+    size_t nodeCount() const { return nodes.size() - 8 * freeGroups.size(); }
+    size_t memoryBytes() const { return nodes.capacity() * sizeof(Node) + freeGroups.capacity() * sizeof(uint32_t); }
+
+private:
+    // Four bytes: a leaf holds LEAF | id, a branch the index of its first child.
+    struct Node {
+        static const uint32_t LEAF = 0x80000000u;
+        uint32_t bits = LEAF | BLOCK_AIR;
+        static Node leaf(BlockId id) { return Node{LEAF | id}; }
+        static Node branch(uint32_t first) { return Node{first}; }
+        bool isLeaf() const { return (bits & LEAF) != 0; }
+        BlockId id() const { return static_cast<BlockId>(bits); }
+        uint32_t children() const { return bits; }
+    };
+    Node buildNode(VoxelWorld &world, int x, int y, int z, int size);
+    uint32_t allocGroup();
+    void freeGroup(uint32_t first);
+
+    sf::Vector3i origin_;
+    int size_ = 1;
+    std::vector<Node> nodes;             // nodes[0] is the root
+    std::vector<uint32_t> freeGroups;    // first index of released 8-node groups
+};
@@ -0,0 +1,176 @@
+#include "voxel_world.h"
+#include "chunk_store.h"
+#include "decoration.h"
+#include "voxel_octree.h"
+#include "world.h"
+#include <algorithm>
+
+void generateChunk(Chunk &c, unsigned seed){
+    c.blocks.fill(BLOCK_AIR);
+    for (int lz = 0; lz < CHUNK_SIZE; ++lz){
+        for (int lx = 0; lx < CHUNK_SIZE; ++lx){
+            int h = std::min(CHUNK_HEIGHT, terrainHeight(seed, c.pos.x * CHUNK_SIZE + lx, c.pos.z * CHUNK_SIZE + lz));
+            for (int y = 0; y < h; ++y) c.set(lx, y, lz, terrainBlockAt(y, h));
+        }
+    }
+}
+
+static size_t chunkBytes(const Chunk &c){ return sizeof(Chunk) + c.blocks.memoryBytes(); }
+
+VoxelWorld::VoxelWorld(unsigned seed) : seed_(seed), decorator(std::make_unique<ChunkDecorator>(seed)) {}
+VoxelWorld::~VoxelWorld() = default;
+
+VoxelWorld::Entry& VoxelWorld::entry(ChunkPos p){
+    auto it = chunks.find(p);
+    if (it != chunks.end()){
+        ++cache.hits;
+        lru.splice(lru.begin(), lru, it->second.use);
+        return it->second;
+    }
+    ++cache.misses;
+    auto c = std::make_unique<Chunk>();
+    c->pos = p;
+    if (store && store->load(p, *c)){
+        ++cache.loadedFromDisk;
+        decorator->markDecorated(p);
+    } else {
+        c->version = 0;
+        generateChunk(*c, seed_);
+        decorator->decorate(*c);
+    }
+    Entry &e = chunks[p];
+    e.savedVersion = c->version;
+    e.bytes = chunkBytes(*c);
+    e.chunk = std::move(c);
+    e.use = lru.insert(lru.begin(), p);
+    cache.residentBytes += e.bytes;
+    return e;
+}
+
+Chunk& VoxelWorld::chunk(ChunkPos p){
+    return *entry(p).chunk;
+}
+
+const Chunk* VoxelWorld::findChunk(ChunkPos p) const{
+    auto it = chunks.find(p);
+    return it == chunks.end() ? nullptr : it->second.chunk.get();
+}
+
+uint16_t VoxelWorld::getBlock(int x, int y, int z){
+    if (y < 0 || y >= CHUNK_HEIGHT) return BLOCK_AIR;
+    return chunk(chunkOf(x, z)).get(floorMod(x, CHUNK_SIZE), y, floorMod(z, CHUNK_SIZE));
+}
+
+bool VoxelWorld::setBlock(int x, int y, int z, uint16_t id){
+    if (y < 0 || y >= CHUNK_HEIGHT) return false;
+    Entry &e = entry(chunkOf(x, z));
+    Chunk &c = *e.chunk;
+    c.set(floorMod(x, CHUNK_SIZE), y, floorMod(z, CHUNK_SIZE), id);
+    ++c.version;
+    const size_t bytes = chunkBytes(c);
+    cache.residentBytes += bytes - e.bytes;
+    e.bytes = bytes;
+    if (octree) octree->set(x, y, z, id);
+    return true;
+}
+
+void VoxelWorld::chunkRewritten(ChunkPos p){
+    Entry &e = entry(p);
+    Chunk &c = *e.chunk;
+    ++c.version;
+    const size_t bytes = chunkBytes(c);
+    cache.residentBytes += bytes - e.bytes;
+    e.bytes = bytes;
+    if (!octree) return;
+    for (int y = 0; y < CHUNK_HEIGHT; ++y)
+        for (int lz = 0; lz < CHUNK_SIZE; ++lz)
+            for (int lx = 0; lx < CHUNK_SIZE; ++lx)
+                octree->set(p.x * CHUNK_SIZE + lx, y, p.z * CHUNK_SIZE + lz, c.get(lx, y, lz));
+}
+
+int VoxelWorld::surfaceHeight(int x, int z){
+    Chunk &c = chunk(chunkOf(x, z));
+    int lx = floorMod(x, CHUNK_SIZE), lz = floorMod(z, CHUNK_SIZE);
+    for (int y = CHUNK_HEIGHT - 1; y >= 0; --y)
+        if (c.get(lx, y, lz) != BLOCK_AIR) return y + 1;
+    return 0;
+}
+
+ChunkMemoryStats VoxelWorld::memoryStats() const{
+    ChunkMemoryStats m;
+    for (const auto &entry : chunks){
+        const BlockStorage &b = entry.second.chunk->blocks;
+        ++m.chunks;
+        m.uniform += b.uniform() ? 1 : 0;
+        m.bytes += chunkBytes(*entry.second.chunk);
+        ++m.byWidth[b.bitsPerBlock()];
+    }
+    return m;
+}
+
+bool VoxelWorld::setStorage(const std::string &dir){
+    auto s = std::make_unique<ChunkStore>();
+    if (!s->open(dir)) return false;
+    store = std::move(s);
+    return true;
+}
+
+// true if the chunk's edits are on disk (or it has none)
+bool VoxelWorld::save(Entry &e){
+    if (e.chunk->version == e.savedVersion) return true;
+    if (!store) return false;
+    if (!store->save(*e.chunk)){
+        ++cache.writeFailures;
+        return false;
+    }
+    ++cache.writes;
+    e.savedVersion = e.chunk->version;
+    return true;
+}
+
+size_t VoxelWorld::trimCache(){
+    if (cache.budgetBytes == 0) return 0;
+    size_t unloaded = 0;
+    // walk from the least recently used end; erase() returns the entry after
+    // the erased one, so the next --it lands on the next newer chunk
+    auto it = lru.end();
+    while (cache.residentBytes > cache.budgetBytes && it != lru.begin()){
+        --it;
+        if (pinned.count(*it)) continue;
+        auto found = chunks.find(*it);
+        Entry &e = found->second;
+        if (!save(e)) continue;
+        cache.residentBytes -= e.bytes;
+        chunks.erase(found);
+        decorator->forget(*it);
+        it = lru.erase(it);
+        ++cache.evictions;
+        ++unloaded;
+    }
+    return unloaded;
+}
+
+size_t VoxelWorld::saveAll(){
+    size_t saved = 0;
+    for (auto &entry : chunks){
+        Entry &e = entry.second;
+        if (e.chunk->version != e.savedVersion && save(e)) ++saved;
+    }
+    return saved;
+}
+
+ChunkCacheStats VoxelWorld::cacheStats() const{
+    ChunkCacheStats s = cache;
+    s.residentChunks = chunks.size();
+    s.pinned = pinned.size();
+    s.decoratorChunks = decorator->trackedChunks();
+    s.decoratorQueued = decorator->queuedBlocks();
+    return s;
+}
+
+void VoxelWorld::resetCacheCounters(){
+    ChunkCacheStats fresh;
+    fresh.residentBytes = cache.residentBytes;
+    fresh.budgetBytes = cache.budgetBytes;
+    cache = fresh;
+}
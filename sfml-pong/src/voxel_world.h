@@ -0,0 +1,132 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "block_registry.h"
+#include "block_storage.h"
+
+// Chunked block world used by the dedicated server. Coordinates are the same
+// world-centred block coordinates the client renders with.
+const int CHUNK_SIZE = 16;      // blocks along X and Z
+const int CHUNK_HEIGHT = 64;
+const int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_HEIGHT;
+
+struct ChunkPos {
+    int x = 0, z = 0;
+    bool operator==(const ChunkPos &o) const { return x == o.x && z == o.z; }
+    bool operator!=(const ChunkPos &o) const { return !(*this == o); }
+};
+
+struct ChunkPosHash {
+    size_t operator()(const ChunkPos &p) const {
+        return std::hash<uint64_t>()((static_cast<uint64_t>(static_cast<uint32_t>(p.x)) << 32) | static_cast<uint32_t>(p.z));
+    }
+};
+
+inline int floorDiv(int a, int b){ return a >= 0 ? a / b : -((-a + b - 1) / b); }
+inline int floorMod(int a, int b){ return a - floorDiv(a, b) * b; }
+inline ChunkPos chunkOf(int x, int z){ return { floorDiv(x, CHUNK_SIZE), floorDiv(z, CHUNK_SIZE) }; }
+
+struct Chunk {
+    ChunkPos pos;
+    uint32_t version = 0;           // bumped on every edit
+    BlockStorage blocks{CHUNK_VOLUME}; // index(): y-major, then z, then x
+
+    static int index(int lx, int y, int lz) { return (y * CHUNK_SIZE + lz) * CHUNK_SIZE + lx; }
+    uint16_t get(int lx, int y, int lz) const { return blocks.get(index(lx, y, lz)); }
+    void set(int lx, int y, int lz, uint16_t id) { blocks.set(index(lx, y, lz), id); }
+};
+
+// Block storage totals over loaded chunks
+struct ChunkMemoryStats {
+    size_t chunks = 0;
+    size_t uniform = 0;             // single-id chunks, no block storage at all
+    size_t bytes = 0;               // Chunk objects plus their block storage
+    size_t byWidth[17] = {};        // chunks per bits-per-block (0, 1, 2, 4, 8, 16)
+};
+
+// Chunk cache counters; the hit/miss/eviction counts accumulate until
+// resetCacheCounters(), the resident figures are current.
+struct ChunkCacheStats {
+    uint64_t hits = 0;              // chunk() found the chunk loaded
+    uint64_t misses = 0;            // chunk() had to load or generate it
+    uint64_t loadedFromDisk = 0;    // misses served by the chunk store
+    uint64_t evictions = 0;
+    uint64_t writes = 0;            // edited chunks saved to the store
+    uint64_t writeFailures = 0;     // those stay loaded
+    size_t residentChunks = 0;
+    size_t residentBytes = 0;       // as in ChunkMemoryStats::bytes
+    size_t budgetBytes = 0;         // 0: unlimited
+    size_t pinned = 0;
+    size_t decoratorChunks = 0;     // ChunkDecorator::trackedChunks()
+    size_t decoratorQueued = 0;     // feature blocks waiting for their chunk
+};
+
+// Fills a chunk with the standard terrain columns (terrainBlockAt). The world
+// then adds trees and boulders (ChunkDecorator).
+void generateChunk(Chunk &c, unsigned seed);
+
+class ChunkDecorator;
+class ChunkStore;
+class VoxelOctree;
+
+// Loaded chunks form a cache. With a memory budget, trimCache() unloads the
+// least recently used chunks that are not pinned until the rest fit: edited
+// chunks are saved to the chunk store first (and stay loaded without one),
+// unedited ones are dropped and generated again when next needed. Chunk
+// references stay valid until the next trimCache().
+class VoxelWorld {
+public:
+    explicit VoxelWorld(unsigned seed);
+    ~VoxelWorld();
+
+    unsigned seed() const { return seed_; }
+    Chunk& chunk(ChunkPos p);                 // loaded or generated on first access
+    const Chunk* findChunk(ChunkPos p) const; // nullptr if not loaded; does not count as a use
+    uint16_t getBlock(int x, int y, int z);
+    bool setBlock(int x, int y, int z, uint16_t id); // false if y is out of range
+    // For bulk edits that write a chunk's blocks directly: bumps its version
+    // once, updates the cache size and mirrors the chunk into the octree.
+    void chunkRewritten(ChunkPos p);
+    int surfaceHeight(int x, int z);          // one above the highest solid block
+    size_t loadedChunks() const { return chunks.size(); }
+    ChunkMemoryStats memoryStats() const;
+    // Edits through setBlock() are mirrored into the octree (nullptr to detach).
+    void attachOctree(VoxelOctree *tree) { octree = tree; }
+
+    void setCacheBudget(size_t bytes) { cache.budgetBytes = bytes; } // 0: never unload
+    // Edited chunks are saved here and loaded back from here; false if the
+    // directory cannot be created.
+    bool setStorage(const std::string &dir);
+    void pin(ChunkPos p) { pinned.insert(p); }
+    void clearPins() { pinned.clear(); }
+    size_t trimCache();                       // chunks unloaded
+    size_t saveAll();                         // edited chunks saved
+    ChunkCacheStats cacheStats() const;
+    void resetCacheCounters();
+
+private:
+    struct Entry {
+        std::unique_ptr<Chunk> chunk;
+        std::list<ChunkPos>::iterator use; // position in lru
+        uint32_t savedVersion = 0;         // version matching generated or stored data
+        size_t bytes = 0;
+    };
+    Entry& entry(ChunkPos p);
+    bool save(Entry &e);
+
+    unsigned seed_;
+    std::unordered_map<ChunkPos, Entry, ChunkPosHash> chunks;
+    std::list<ChunkPos> lru;                  // most recently used first
+    std::unordered_set<ChunkPos, ChunkPosHash> pinned;
+    std::unique_ptr<ChunkDecorator> decorator;
+    std::unique_ptr<ChunkStore> store;
+    ChunkCacheStats cache;
+    VoxelOctree *octree = nullptr;
+};
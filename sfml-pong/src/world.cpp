@@ -1,18 +1,26 @@
 #include "world.h"
+#include "trace.h"
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 
 int heights[CHUNK][CHUNK];
+std::shared_mutex worldMutex;
+
+int terrainHeight(unsigned seed, int gx, int gz){
+    float nx = gx * 0.12f;
+    float nz = gz * 0.12f;
+    float h = sinf(nx*1.0f + seed*0.1f) + sinf(nz*1.3f + seed*0.07f)*0.6f + sinf((nx+nz)*0.5f)*0.4f;
+    return std::max(1, int(3 + h * 3.0f));
+}
 
 void generateTerrain(unsigned seed){
+    TRACE_ZONE("generate terrain");
+    std::unique_lock<std::shared_mutex> lock(worldMutex);
     for(int x=0;x<CHUNK;++x){
         for(int z=0;z<CHUNK;++z){
-            float nx = (x - CHUNK/2) * 0.12f;
-            float nz = (z - CHUNK/2) * 0.12f;
-            float h = sinf(nx*1.0f + seed*0.1f) + sinf(nz*1.3f + seed*0.07f)*0.6f + sinf((nx+nz)*0.5f)*0.4f;
-            int hh = std::max(1, int(3 + h * 3.0f));
-            heights[x][z] = hh;
+            heights[x][z] = terrainHeight(seed, x - CHUNK/2, z - CHUNK/2);
         }
     }
     std::cout << "Terrain generated (seed=" << seed << ")\n";
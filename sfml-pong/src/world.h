@@ -1,8 +1,16 @@
 #pragma once
 #include <array>
+#include <shared_mutex>
 
 const int CHUNK = 32;
 extern int heights[CHUNK][CHUNK];
+// generateTerrain holds this exclusively; readers on other threads take it shared
+extern std::shared_mutex worldMutex;
+// Column height at world-centred block coordinates (x - CHUNK/2), shared by the
+// heightmap and the chunked voxel world so both generate the same terrain.
+int terrainHeight(unsigned seed, int gx, int gz);
+// cube's heightmap world floods columns lower than this with water up to it
+const int WATER_LEVEL = 2;
 void generateTerrain(unsigned seed);
 bool isAirAt(int x, int z, int y);
 int getHeightAt(int x, int z);
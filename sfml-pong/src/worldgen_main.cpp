@@ -0,0 +1,223 @@
+#include "chunk_mesher.h"
+#include "chunk_store.h"
+#include "decoration.h"
+#include "trace.h"
+#include "voxel_world.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// worldgen: pre-generates the square of chunks within R of the origin into a
+// chunk directory that `cube_server --save-dir` loads from.
+//   --seed S      world seed (default 123)
+//   --radius R    chunks each side of the origin (default 32)
+//   --out D       output directory (default world)
+//   --mesh        also write each chunk's mesh as <x>_<z>.mesh
+//   --threads N   worker threads (default: every core)
+//   --trace F     record the whole run as a Chrome trace (trace.h) in F
+// Chunks already in D are skipped, so an interrupted run picks up where it
+// stopped; D remembers its seed and a different one is refused.
+//
+// Mesh file layout (little endian): "CBMS", u8 version (2), then four u32 quad
+// counts, one per face group (top, side, bottom, translucent water and glass),
+// then the vertices of all four groups in that order (x, y, z, u, v floats, 4
+// per quad). Positions are chunk-local and block-centred on X/Z: block
+// (lx, y, lz) spans lx - 0.5..lx + 0.5, y..y + 1 and lz - 0.5..lz + 0.5. u, v
+// are in atlas tiles (column, row from the top), for the loader to scale.
+
+using GenClock = std::chrono::steady_clock;
+
+static bool checkSeed(const std::string &dir, unsigned seed){
+    const std::string path = dir + "/worldgen.txt";
+    std::ifstream in(path);
+    std::string key;
+    unsigned saved = 0;
+    if (in >> key >> saved){
+        if (key == "seed" && saved == seed) return true;
+        std::cerr << dir << " was generated with seed " << saved << ", not " << seed << "\n";
+        return false;
+    }
+    std::ofstream out(path);
+    out << "seed " << seed << "\n";
+    return static_cast<bool>(out);
+}
+
+// Runs job(i, worker) for every i < count on `threads` workers, printing
+// progress and throughput from the calling thread. job returns false for
+// items it skipped.
+static void runParallel(const char *stage, size_t count, unsigned threads, const std::function<bool(size_t, unsigned)> &job){
+    std::atomic<size_t> next{0}, done{0}, skipped{0};
+    std::vector<std::thread> workers;
+    const auto t0 = GenClock::now();
+    auto elapsed = [&]{ return std::chrono::duration<double>(GenClock::now() - t0).count(); };
+    std::atomic<double> finished{0.0}; // seconds when the last item completed
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]{
+            traceSetThreadName("worldgen worker");
+            for (size_t i; (i = next.fetch_add(1)) < count;){
+                if (!job(i, t)) ++skipped;
+                if (++done == count) finished = elapsed();
+            }
+        });
+    auto report = [&](const char *end){
+        const size_t d = done.load(), k = skipped.load();
+        const double s = d == count ? finished.load() : elapsed();
+        const double rate = s > 0.0 ? (d - k) / s : 0.0;
+        std::printf("\r  %-9s %zu/%zu (%.0f%%), %zu already done, %.0f chunks/s%s", stage, d, count,
+            count ? 100.0 * d / count : 100.0, k, rate, end);
+        std::fflush(stdout);
+    };
+    while (done.load() < count){
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        report("   ");
+    }
+    for (auto &w : workers) w.join();
+    report("\n");
+}
+
+// The mesher's padded grid is a section wide; a chunk has to fit it exactly.
+static_assert(CHUNK_SIZE == SECTION, "meshChunk fills a MeshJob::PAD grid from CHUNK_SIZE loops");
+
+// Loads a chunk and the one-block border of its four neighbours (air where a
+// neighbour is outside the generated area) and meshes it.
+static bool meshChunk(ChunkStore &store, ChunkPos p, const std::shared_ptr<const BlockUVTable> &uvs, MeshBuffers &out){
+    Chunk self, side;
+    if (!store.load(p, self)) return false;
+    MeshJob job;
+    job.height = CHUNK_HEIGHT;
+    job.uvs = uvs;
+    job.cells.assign(static_cast<size_t>(MeshJob::PAD) * MeshJob::PAD * CHUNK_HEIGHT, BLOCK_AIR);
+    auto cell = [&](int px, int pz, int y) -> BlockId& { return job.cells[(static_cast<size_t>(y) * MeshJob::PAD + pz) * MeshJob::PAD + px]; };
+    for (int y = 0; y < CHUNK_HEIGHT; ++y)
+        for (int lz = 0; lz < CHUNK_SIZE; ++lz)
+            for (int lx = 0; lx < CHUNK_SIZE; ++lx) cell(lx + 1, lz + 1, y) = self.get(lx, y, lz);
+    const int dirs[4][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+    for (const auto &d : dirs){
+        if (!store.load({p.x + d[0], p.z + d[1]}, side)) continue;
+        for (int y = 0; y < CHUNK_HEIGHT; ++y)
+            for (int i = 0; i < CHUNK_SIZE; ++i){
+                if (d[0] != 0){
+                    const int lx = d[0] < 0 ? CHUNK_SIZE - 1 : 0;
+                    cell(d[0] < 0 ? 0 : CHUNK_SIZE + 1, i + 1, y) = side.get(lx, y, i);
+                } else {
+                    const int lz = d[1] < 0 ? CHUNK_SIZE - 1 : 0;
+                    cell(i + 1, d[1] < 0 ? 0 : CHUNK_SIZE + 1, y) = side.get(i, y, lz);
+                }
+            }
+    }
+    TRACE_ZONE("mesh chunk");
+    out = buildSectionMesh(job);
+    return true;
+}
+
+static bool writeMesh(const std::string &path, const MeshBuffers &mesh){
+    TRACE_ZONE("write mesh");
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        const uint8_t version = 2;
+        f.write("CBMS", 4);
+        f.write(reinterpret_cast<const char*>(&version), 1);
+        const std::vector<float> *groups[] = { &mesh.groups[GROUP_TOP], &mesh.groups[GROUP_SIDE], &mesh.groups[GROUP_BOTTOM], &mesh.translucent };
+        for (const auto *g : groups){
+            const uint32_t quads = static_cast<uint32_t>(g->size() / (4 * MESH_VERTEX_FLOATS));
+            f.write(reinterpret_cast<const char*>(&quads), sizeof(quads));
+        }
+        for (const auto *g : groups)
+            f.write(reinterpret_cast<const char*>(g->data()), static_cast<std::streamsize>(g->size() * sizeof(float)));
+        if (!f){ std::cerr << "\nCould not write " << tmp << "\n"; return false; }
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+int main(int argc, char **argv){
+    unsigned seed = 123;
+    int radius = 32;
+    std::string out = "world", traceFile;
+    bool mesh = false;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i){
+        std::string a = argv[i];
+        if (a == "--mesh"){ mesh = true; continue; }
+        if (i + 1 >= argc){ std::cerr << "Missing value for " << a << "\n"; return 2; }
+        const char *v = argv[++i];
+        if (a == "--seed") seed = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+        else if (a == "--radius") radius = std::max(0, std::atoi(v));
+        else if (a == "--out") out = v;
+        else if (a == "--threads") threads = static_cast<unsigned>(std::max(1, std::atoi(v)));
+        else if (a == "--trace") traceFile = v;
+        else { std::cerr << "Unknown argument: " << a << "\nUsage: worldgen [--seed S] [--radius R] [--out D] [--mesh] [--threads N] [--trace F]\n"; return 2; }
+    }
+    traceSetThreadName("main");
+    TraceCapture trace;
+    if (!traceFile.empty()) trace.start(traceFile, 0);
+
+    ChunkStore probe;
+    if (!probe.open(out) || !checkSeed(out, seed)) return 1;
+    std::vector<ChunkPos> chunks;
+    for (int z = -radius; z <= radius; ++z)
+        for (int x = -radius; x <= radius; ++x) chunks.push_back({x, z});
+    std::printf("Generating %zu chunks (seed=%u, radius %d) into %s on %u threads\n", chunks.size(), seed, radius, out.c_str(), threads);
+
+    // chunks saved by an earlier run already hold their features
+    ChunkDecorator decorator(seed);
+    std::vector<char> saved(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i)
+        if ((saved[i] = probe.contains(chunks[i]))) decorator.markDecorated(chunks[i]);
+
+    std::atomic<bool> failed{false};
+    std::vector<ChunkStore> stores(threads); // one per worker, for their buffers
+    for (auto &s : stores) s.open(out);
+
+    const auto t0 = GenClock::now();
+    runParallel("generate", chunks.size(), threads, [&](size_t i, unsigned worker){
+        if (saved[i]) return false;
+        Chunk c;
+        c.pos = chunks[i];
+        {
+            TRACE_ZONE("generate chunk");
+            generateChunk(c, seed);
+        }
+        {
+            TRACE_ZONE("decorate chunk");
+            decorator.decorate(c);
+        }
+        if (!stores[worker].save(c)) failed = true;
+        return true;
+    });
+
+    if (mesh && !failed){
+        // UVs in atlas tile units; see the layout above
+        auto tile = [](AtlasTile t){ return std::array<float,4>{ float(t.col), float(t.row + 1), float(t.col + 1), float(t.row) }; };
+        auto uvs = std::make_shared<BlockUVTable>();
+        for (const BlockType &b : BLOCK_TYPES) (*uvs)[b.id] = { tile(b.top), tile(b.side), tile(b.bottom) };
+        std::shared_ptr<const BlockUVTable> shared = uvs;
+        std::atomic<size_t> quads{0};
+        runParallel("mesh", chunks.size(), threads, [&](size_t i, unsigned worker){
+            ChunkStore &s = stores[worker];
+            const std::string path = out + "/" + std::to_string(chunks[i].x) + "_" + std::to_string(chunks[i].z) + ".mesh";
+            std::error_code ec;
+            if (std::filesystem::is_regular_file(path, ec)) return false;
+            MeshBuffers m;
+            if (!meshChunk(s, chunks[i], shared, m) || !writeMesh(path, m)){ failed = true; return true; }
+            quads += m.quadCount() + m.translucent.size() / (4 * MESH_VERTEX_FLOATS);
+            return true;
+        });
+        std::printf("  %zu quads meshed\n", quads.load());
+    }
+
+    const double seconds = std::chrono::duration<double>(GenClock::now() - t0).count();
+    std::printf("Done in %.1f s%s\n", seconds, failed ? " with errors" : "");
+    if (!trace.finish()) failed = true;
+    return failed ? 1 : 0;
+}